@@ -0,0 +1,583 @@
+// batch.cpp
+
+#include "batch.h"
+#include "csv_writer.h"
+#include "trace.h"
+#include <charconv>
+#include <string_view>
+#include <algorithm>
+#include <sstream>
+#include <filesystem>
+
+namespace {
+    // Выделение очередного слова строки
+    std::string_view nextToken(std::string_view& rest) {
+        std::size_t start = rest.find_first_not_of(" \t\r");
+        if(start == std::string_view::npos) {
+            rest = std::string_view();
+            return rest;
+        }
+        std::size_t end = rest.find_first_of(" \t\r", start);
+        if(end == std::string_view::npos)
+            end = rest.size();
+        std::string_view token = rest.substr(start, end - start);
+        rest.remove_prefix(end);
+        return token;
+    }
+
+    // Остаток строки без пробелов по краям
+    std::string_view trim(std::string_view text) {
+        std::size_t start = text.find_first_not_of(" \t\r");
+        if(start == std::string_view::npos)
+            return std::string_view();
+        std::size_t end = text.find_last_not_of(" \t\r");
+        return text.substr(start, end - start + 1);
+    }
+
+    // Разбор неотрицательного целого числа
+    template<typename T>
+    bool parseNumber(std::string_view text, T& value) {
+        if(text.empty())
+            return false;
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    // Разделение полей "имя,телефон,город"
+    bool splitFields(std::string_view text, std::string& name, std::string& phone, std::string& city) {
+        std::size_t first = text.find(',');
+        if(first == std::string_view::npos)
+            return false;
+        std::size_t second = text.find(',', first + 1);
+        if(second == std::string_view::npos)
+            return false;
+        name = trim(text.substr(0, first));
+        phone = trim(text.substr(first + 1, second - first - 1));
+        city = trim(text.substr(second + 1));
+        return true;
+    }
+
+    // Вывод найденных контактов и строки с их количеством
+    void printResult(std::ostream& out, const ContactStore& contacts, const std::vector<int>& ids,
+                     const ReportOptions& options) {
+        std::size_t count;
+        {
+            ReportWriter report(out, options);
+            report.write(contacts, ids);
+            count = report.count();
+        }
+        out << "ok " << count << "\n";
+    }
+}
+
+// Конструктор
+BatchSession::BatchSession(ContactStore& contacts, IndexArray& indices, const std::string& filename,
+                           std::size_t rejectedRows)
+    : contacts(contacts), indices(indices), filename(filename), rejectedRows(rejectedRows), indicesBuilt(false),
+      treeBuilt(false) {}
+
+// Добавление контакта в индексы изменений
+void BatchSession::rememberChange(std::size_t row) {
+    int id = contacts.id(row);
+    changed.insert(id);
+    changedNames.emplace(std::string(contacts.name(row)), id);
+    changedPhones.emplace(contacts.phoneNumber(row), id);
+    changedCities.emplace(contacts.cityCode(row), id);
+}
+
+// Удаление контакта из индексов изменений
+void BatchSession::forgetChange(std::size_t row) {
+    int id = contacts.id(row);
+    if(changed.erase(id) == 0)
+        return;
+    // Записи ищутся по прежним полям, которые ещё хранятся в строке
+    auto eraseEntry = [id](auto& index, auto range) {
+        for(auto it = range.first; it != range.second; ++it) {
+            if(it->second == id) {
+                index.erase(it);
+                return;
+            }
+        }
+    };
+    eraseEntry(changedNames, changedNames.equal_range(std::string(contacts.name(row))));
+    eraseEntry(changedPhones, changedPhones.equal_range(contacts.phoneNumber(row)));
+    eraseEntry(changedCities, changedCities.equal_range(contacts.cityCode(row)));
+}
+
+// Выполнение накопленных удалений
+void BatchSession::applyDeletes() {
+    if(pendingDeletes.empty())
+        return;
+    TRACE_SPAN("BatchSession::applyDeletes");
+    for(int id : pendingDeletes) {
+        if(changed.count(id) > 0)
+            forgetChange(contacts.rowOf(id));
+    }
+    contacts.removeIf([&](const ContactView& c) { return pendingDeletes.count(c.id) > 0; });
+    // Построенные индексы очищаются без пересортировки
+    if(indicesBuilt)
+        indices.removeRecords(pendingDeletes);
+    if(treeBuilt)
+        tree.removeRecords(pendingDeletes);
+    pendingDeletes.clear();
+}
+
+// Перестроение устаревших индексов
+void BatchSession::ensureIndices(bool exact) {
+    if(indicesBuilt && changed.size() <= rebuildThreshold() && (!exact || changed.empty()))
+        return;
+    TRACE_SPAN("BatchSession::ensureIndices");
+    indicesBuilt = false;
+    treeBuilt = false;
+    applyDeletes();
+    indices.buildIndices(contacts);
+    indices.sortIndices();
+    indicesBuilt = true;
+    changed.clear();
+    changedNames.clear();
+    changedPhones.clear();
+    changedCities.clear();
+}
+
+// Проверка, является ли команда запросом
+bool BatchSession::isQuery(const std::string& line) {
+    std::string_view rest(line);
+    std::string_view command = nextToken(rest);
+    return command == "find" || command == "tree" || command == "list";
+}
+
+// Подготовка, нужная запросу
+BatchSession::Preparation BatchSession::preparationOf(const std::string& line) {
+    std::string_view rest(line);
+    std::string_view command = nextToken(rest);
+    if(command == "find")
+        return Preparation::INDICES;
+    if(command == "tree")
+        return Preparation::TREE;
+    if(command != "list")
+        return Preparation::NONE;
+    // Вывод в порядке имени или города требует точных индексов
+    for(std::string_view token = nextToken(rest); !token.empty(); token = nextToken(rest)) {
+        if(token == "name" || token == "city")
+            return Preparation::EXACT;
+    }
+    return Preparation::COMPACT;
+}
+
+// Проверка готовности индексов
+bool BatchSession::isPrepared(const std::string& line) const {
+    switch(preparationOf(line)) {
+        case Preparation::NONE:
+            return true;
+        case Preparation::COMPACT:
+            return pendingDeletes.empty();
+        case Preparation::INDICES:
+            return indicesBuilt && changed.size() <= rebuildThreshold();
+        case Preparation::TREE:
+            return indicesBuilt && changed.size() <= rebuildThreshold() && treeBuilt;
+        case Preparation::EXACT:
+            return indicesBuilt && changed.empty() && pendingDeletes.empty();
+    }
+    return false;
+}
+
+// Подготовка индексов для запроса
+void BatchSession::prepare(const std::string& line) {
+    switch(preparationOf(line)) {
+        case Preparation::NONE:
+            break;
+        case Preparation::COMPACT:
+            applyDeletes();
+            break;
+        case Preparation::INDICES:
+            ensureIndices(false);
+            break;
+        case Preparation::TREE:
+            ensureIndices(false);
+            if(!treeBuilt) {
+                tree.buildFromIndex(indices.nameIndexAsc);
+                treeBuilt = true;
+            }
+            break;
+        case Preparation::EXACT:
+            applyDeletes();
+            ensureIndices(true);
+            break;
+    }
+}
+
+// Выполнение подготовленного запроса
+void BatchSession::query(const std::string& line, const ReportOptions& options, std::ostream& out) const {
+    std::string_view rest(line);
+    std::string_view command = nextToken(rest);
+
+    if(command == "find") {
+        std::string_view kind = nextToken(rest);
+        std::string key(trim(rest));
+        if(key.empty()) {
+            out << "error: не задано значение для поиска\n";
+            return;
+        }
+        // Устаревшие записи основного индекса отбрасываются, изменённые контакты
+        // берутся из индекса изменений
+        std::vector<int> ids;
+        auto addChanged = [&](auto range) {
+            for(auto it = range.first; it != range.second; ++it) {
+                if(pendingDeletes.count(it->second) == 0)
+                    ids.push_back(it->second);
+            }
+        };
+        auto keepCurrent = [&]() {
+            ids.erase(std::remove_if(ids.begin(), ids.end(), [&](int id) { return !isCurrent(id); }), ids.end());
+        };
+        if(kind == "name") {
+            ids = binarySearchIterative(indices.nameIndexAsc, key);
+            keepCurrent();
+            addChanged(changedNames.equal_range(key));
+        }
+        else if(kind == "city") {
+            std::uint32_t code = contacts.findCity(key);
+            ids = searchCity(indices.cityIndexAsc, code);
+            keepCurrent();
+            if(code != ContactStore::noCity)
+                addChanged(changedCities.equal_range(code));
+        }
+        else if(kind == "phone" || kind == "prefix") {
+            PackedPhone low, high;
+            bool valid = kind == "phone" ? PackedPhone::parse(key, low) : PackedPhone::prefixRange(key, low, high);
+            if(!valid) {
+                out << "error: некорректный номер телефона\n";
+                return;
+            }
+            if(kind == "phone")
+                high = low;
+            ids = kind == "phone" ? searchPhone(indices.phoneIndex, low) : searchPhonePrefix(indices.phoneIndex, key);
+            keepCurrent();
+            addChanged(std::make_pair(changedPhones.lower_bound(low), changedPhones.upper_bound(high)));
+        }
+        else {
+            out << "error: неизвестный вид поиска \"" << kind << "\"\n";
+            return;
+        }
+        std::sort(ids.begin(), ids.end());
+        printResult(out, contacts, ids, options);
+        return;
+    }
+
+    if(command == "tree") {
+        std::string key(trim(rest));
+        std::vector<int> ids = tree.search(key);
+        ids.erase(std::remove_if(ids.begin(), ids.end(), [&](int id) { return !isCurrent(id); }), ids.end());
+        auto range = changedNames.equal_range(key);
+        for(auto it = range.first; it != range.second; ++it) {
+            if(pendingDeletes.count(it->second) == 0)
+                ids.push_back(it->second);
+        }
+        std::sort(ids.begin(), ids.end());
+        printResult(out, contacts, ids, options);
+        return;
+    }
+
+    if(command == "list") {
+        // Параметры страницы действуют только на эту команду
+        ReportOptions listOptions = options;
+        std::string_view order = "id";
+        bool descending = false;
+        for(std::string_view token = nextToken(rest); !token.empty(); token = nextToken(rest)) {
+            if(token == "id" || token == "name" || token == "city")
+                order = token;
+            else if(token == "desc")
+                descending = true;
+            else if(token == "asc")
+                descending = false;
+            else if(token == "offset" && parseNumber(nextToken(rest), listOptions.offset))
+                continue;
+            else if(token == "limit" && parseNumber(nextToken(rest), listOptions.limit))
+                continue;
+            else {
+                out << "error: некорректный параметр \"" << token << "\"\n";
+                return;
+            }
+        }
+        if(order == "id" && descending) {
+            out << "error: обратный порядок поддерживается только для name и city\n";
+            return;
+        }
+        std::size_t count;
+        {
+            ReportWriter report(out, listOptions);
+            if(order == "name") {
+                printSortedByName(contacts, descending ? indices.nameIndexDesc : indices.nameIndexAsc, report);
+            }
+            else if(order == "city") {
+                printSortedByCity(contacts, descending ? indices.cityIndexDesc : indices.cityIndexAsc, report);
+            }
+            else {
+                for(const auto& contact : contacts) {
+                    if(!report.write(contact))
+                        break;
+                }
+            }
+            count = report.count();
+        }
+        out << "ok " << count << "\n";
+        return;
+    }
+
+    out << "error: неизвестный запрос \"" << command << "\"\n";
+}
+
+// Выполнение одной команды с форматом сессии
+bool BatchSession::execute(const std::string& line, std::ostream& out) {
+    return execute(line, options, out);
+}
+
+// Выполнение одной команды
+bool BatchSession::execute(const std::string& line, ReportOptions& options, std::ostream& out) {
+    std::string_view rest(line);
+    std::string_view command = nextToken(rest);
+    if(command.empty() || command.front() == '#')
+        return true;
+
+    if(command == "delete") {
+        STATS_TIMED(StatOperation::REMOVE);
+        int id;
+        if(!parseNumber(trim(rest), id)) {
+            out << "error: ожидается ID контакта\n";
+            return true;
+        }
+        if(contacts.rowOf(id) == ContactStore::npos || pendingDeletes.count(id) > 0) {
+            out << "error: контакт с ID " << id << " не найден\n";
+            return true;
+        }
+        // Удаления копятся и выполняются одним проходом; до этого поиск их отбрасывает
+        pendingDeletes.insert(id);
+        if(pendingDeletes.size() > rebuildThreshold())
+            applyDeletes();
+        out << "ok " << id << "\n";
+        return true;
+    }
+
+    if(command == "quit")
+        return false;
+
+    if(isQuery(line)) {
+        prepare(line);
+        query(line, options, out);
+        return true;
+    }
+
+    if(command == "insert") {
+        STATS_TIMED(StatOperation::INSERT);
+        std::string name, phoneNumber, city;
+        if(!splitFields(rest, name, phoneNumber, city)) {
+            out << "error: ожидается имя,телефон,город\n";
+            return true;
+        }
+        PackedPhone phone;
+        if(!validateName(name) || !validateCity(city) || !validatePhoneNumber(phoneNumber) ||
+           !PackedPhone::parse(phoneNumber, phone)) {
+            out << "error: некорректные поля контакта\n";
+            return true;
+        }
+        int id = global_id_counter++;
+        contacts.push_back(id, name, phone, city);
+        rememberChange(contacts.rowOf(id));
+        out << "ok " << id << "\n";
+        return true;
+    }
+
+    if(command == "edit") {
+        STATS_TIMED(StatOperation::EDIT);
+        int id;
+        std::size_t row;
+        std::string name, phoneNumber, city;
+        if(!parseNumber(nextToken(rest), id) || !splitFields(rest, name, phoneNumber, city)) {
+            out << "error: ожидается ID имя,телефон,город\n";
+            return true;
+        }
+        if((row = contacts.rowOf(id)) == ContactStore::npos || pendingDeletes.count(id) > 0) {
+            out << "error: контакт с ID " << id << " не найден\n";
+            return true;
+        }
+        // Пустое поле оставляет прежнее значение; номер проверяется до любых изменений
+        PackedPhone phone;
+        if(!phoneNumber.empty() && !PackedPhone::parse(phoneNumber, phone)) {
+            out << "error: некорректный номер телефона\n";
+            return true;
+        }
+        forgetChange(row);
+        if(!name.empty())
+            contacts.setName(row, name);
+        if(!phoneNumber.empty())
+            contacts.setPhoneNumber(row, phone);
+        if(!city.empty())
+            contacts.setCity(row, city);
+        rememberChange(row);
+        out << "ok " << id << "\n";
+        return true;
+    }
+
+    if(command == "format") {
+        std::string_view format = trim(rest);
+        if(format == "text")
+            options.format = ReportFormat::TEXT;
+        else if(format == "tsv")
+            options.format = ReportFormat::TSV;
+        else if(format == "jsonl")
+            options.format = ReportFormat::JSONL;
+        else {
+            out << "error: неизвестный формат \"" << format << "\"\n";
+            return true;
+        }
+        out << "ok\n";
+        return true;
+    }
+
+    if(command == "save") {
+        std::string target(trim(rest));
+        if(target.empty())
+            target = filename;
+        std::error_code error;
+        if(rejectedRows > 0 && (target == filename || std::filesystem::equivalent(target, filename, error))) {
+            out << "error: файл " << target << " не перезаписан: при загрузке пропущено строк: " << rejectedRows << "\n";
+            return true;
+        }
+        applyDeletes();
+        STATS_TIMED(StatOperation::FILE_WRITE);
+        CsvWriter writer;
+        if(!writer.open(target)) {
+            out << "error: не удалось открыть файл " << target << "\n";
+            return true;
+        }
+        for(const auto& contact : contacts)
+            writer.writeContact(contact);
+        if(!writer.commit()) {
+            out << "error: не удалось записать файл " << target << "\n";
+            return true;
+        }
+        STATS_COUNT(StatCounter::ROWS_WRITTEN, contacts.size());
+        out << "ok " << contacts.size() << "\n";
+        return true;
+    }
+
+    if(command == "trace") {
+        std::string target(trim(rest));
+        if(target.empty()) {
+            out << "error: ожидается имя файла трассировки\n";
+            return true;
+        }
+        if(!tracingEnabled()) {
+            out << "error: трассировка не включена (--trace)\n";
+            return true;
+        }
+        long long events = writeChromeTrace(target);
+        if(events < 0) {
+            out << "error: не удалось записать файл " << target << "\n";
+            return true;
+        }
+        out << "ok " << events << "\n";
+        return true;
+    }
+
+    if(command == "memory") {
+        printMemoryReport({ { "контакты", contacts.memoryUsage() }, { "индексы", indices.memoryUsage() },
+                            { "дерево", tree.memoryUsage() } }, out);
+        out << "ok\n";
+        return true;
+    }
+
+    if(command == "stats") {
+        std::string_view action = trim(rest);
+        if(action == "reset") {
+            operationStats().reset();
+        }
+        else if(!action.empty()) {
+            out << "error: ожидается stats [reset]\n";
+            return true;
+        }
+        else {
+            operationStats().print(out);
+        }
+        out << "ok\n";
+        return true;
+    }
+
+    out << "error: неизвестная команда \"" << command << "\"\n";
+    return true;
+}
+
+// Выполнение команд из потока
+std::size_t BatchSession::run(std::istream& in, std::ostream& out) {
+    std::size_t executed = 0;
+    std::string line;
+    while(std::getline(in, line)) {
+        ++executed;
+        if(!execute(line, out))
+            break;
+        // Поток сбрасывается, только когда все уже прочитанные команды выполнены
+        if(in.rdbuf()->in_avail() <= 0)
+            out.flush();
+    }
+    applyDeletes();
+    out.flush();
+    return executed;
+}
+
+// Параллельное выполнение запросов
+void BatchSession::runQueries(const std::vector<std::string>& lines, ThreadPool& pool, std::ostream& out) {
+    if(lines.empty())
+        return;
+    // Подготовка одного запроса может перестроить то, что подготовлено для другого
+    // (перестроение индексов сбрасывает дерево), поэтому повторяется до готовности всех
+    bool ready = false;
+    while(!ready) {
+        ready = true;
+        for(const std::string& line : lines) {
+            if(!isPrepared(line)) {
+                prepare(line);
+                ready = false;
+            }
+        }
+    }
+    if(lines.size() == 1) {
+        query(lines[0], options, out);
+        return;
+    }
+    TRACE_SPAN("batch queries");
+    std::vector<std::ostringstream> results(lines.size());
+    pool.parallelFor(lines.size(), [&](std::size_t i) { query(lines[i], options, results[i]); });
+    for(const std::ostringstream& result : results)
+        out << result.str();
+}
+
+// Выполнение команд с параллельными запросами
+std::size_t BatchSession::run(std::istream& in, std::ostream& out, ThreadPool& pool) {
+    const std::size_t maxQueries = 4096; // Наибольшее число запросов, выполняемых вместе
+    std::size_t executed = 0;
+    std::vector<std::string> queries;
+    std::string line;
+    while(std::getline(in, line)) {
+        ++executed;
+        if(isQuery(line)) {
+            queries.push_back(std::move(line));
+            // Запросы копятся, пока за ними уже прочитаны следующие команды
+            if(queries.size() < maxQueries && in.rdbuf()->in_avail() > 0)
+                continue;
+            runQueries(queries, pool, out);
+            queries.clear();
+        }
+        else {
+            runQueries(queries, pool, out);
+            queries.clear();
+            if(!execute(line, out))
+                break;
+        }
+        if(in.rdbuf()->in_avail() <= 0)
+            out.flush();
+    }
+    runQueries(queries, pool, out);
+    applyDeletes();
+    out.flush();
+    return executed;
+}
@@ -0,0 +1,209 @@
+// batch.h
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "contact.h"
+#include "binary_tree.h"
+#include <string>
+#include <istream>
+#include <ostream>
+#include <unordered_set>
+#include <unordered_map>
+#include <map>
+#include <vector>
+
+/**
+ * @class BatchSession
+ * @brief Неинтерактивное выполнение команд над хранилищем контактов.
+ *
+ * Команды читаются по одной на строку:
+ *   find name|city|phone|prefix <значение>
+ *   tree <имя>                           (поиск в бинарном дереве по имени)
+ *   insert <имя>,<телефон>,<город>
+ *   edit <ID> <имя>,<телефон>,<город>   (пустое поле - без изменений)
+ *   delete <ID>
+ *   list [id|name|city] [desc] [offset N] [limit N]
+ *   format text|tsv|jsonl
+ *   save [файл]                          (файл загрузки с пропущенными строками не перезаписывается)
+ *   stats [reset]                        (статистика операций или её сброс)
+ *   memory                               (память хранилища, индексов и дерева)
+ *   trace <файл>                         (запись трассировки Chrome, если она включена)
+ *   quit
+ * Пустые строки и строки, начинающиеся с '#', пропускаются. Изменения
+ * отвечают строкой "ok <ID>", ошибки - строкой "error: <описание>".
+ *
+ * Индекс-массивы не перестраиваются после каждого изменения. Добавленные и
+ * изменённые контакты заносятся в небольшие упорядоченные индексы изменений,
+ * поиск объединяет их с основными индексами и отбрасывает устаревшие записи
+ * основных; основные перестраиваются, когда изменений накапливается больше
+ * порога, или перед выводом в порядке индекса. Удаления так же копятся и
+ * выполняются одним проходом по хранилищу.
+ *
+ * Запросы (find, tree, list) разделены на подготовку, изменяющую индексы,
+ * и константное выполнение, поэтому сервер может выполнять подготовленные
+ * запросы параллельно под общей блокировкой, а пакет - подряд идущие
+ * запросы на пуле потоков.
+ */
+class BatchSession {
+private:
+    ContactStore& contacts;             ///< Хранилище контактов
+    IndexArray& indices;                ///< Индекс-массивы
+    std::string filename;               ///< Файл, из которого загружены контакты
+    std::size_t rejectedRows;           ///< Строк файла, пропущенных при загрузке
+    ReportOptions options;              ///< Формат вывода результатов
+    bool indicesBuilt;                  ///< Индексы построены по хранилищу
+    std::unordered_set<int> changed;    ///< Контакты, добавленные или изменённые после построения индексов
+    std::multimap<std::string, int> changedNames;       ///< Индекс изменений по имени
+    std::multimap<PackedPhone, int> changedPhones;      ///< Индекс изменений по номеру телефона
+    std::unordered_multimap<std::uint32_t, int> changedCities; ///< Индекс изменений по коду города
+    std::unordered_set<int> pendingDeletes; ///< Удаления, ещё не выполненные в хранилище
+    BinaryTree tree;                    ///< Бинарное дерево по имени, построенное из индекса
+    bool treeBuilt;                     ///< Дерево соответствует основному индексу по имени
+
+    /**
+     * @enum Preparation
+     * @brief Что должно быть готово для выполнения запроса.
+     */
+    enum class Preparation {
+        NONE,       ///< Ничего (команда не является запросом или содержит ошибку)
+        INDICES,    ///< Основные индексы с изменениями не больше порога
+        TREE,       ///< То же и бинарное дерево
+        EXACT,      ///< Индексы точно соответствуют хранилищу, удаления выполнены
+        COMPACT     ///< Удаления выполнены
+    };
+
+    /**
+     * @brief Определяет подготовку, нужную запросу.
+     * @param line Строка команды.
+     * @return Требуемая подготовка.
+     */
+    static Preparation preparationOf(const std::string& line);
+
+    /**
+     * @brief Заносит текущие поля контакта в индексы изменений.
+     * @param row Номер строки контакта.
+     */
+    void rememberChange(std::size_t row);
+
+    /**
+     * @brief Убирает контакт из индексов изменений (поля берутся из хранилища).
+     * @param row Номер строки контакта.
+     */
+    void forgetChange(std::size_t row);
+
+    /**
+     * @brief Выполняет накопленные удаления одним проходом.
+     */
+    void applyDeletes();
+
+    /**
+     * @brief Перестраивает индекс-массивы, если они не построены или устарели.
+     * @param exact true, если индексы должны точно соответствовать хранилищу
+     * (вывод в порядке индекса), иначе допускаются изменения не больше порога.
+     */
+    void ensureIndices(bool exact);
+
+    /**
+     * @brief Проверяет, что запись основного индекса не удалена и не изменена.
+     * @param id ID контакта.
+     * @return true, если запись индекса действительна.
+     */
+    bool isCurrent(int id) const { return changed.count(id) == 0 && pendingDeletes.count(id) == 0; }
+
+    /**
+     * @brief Число накопленных изменений или удалений, после которого они
+     * переносятся в основные индексы и хранилище.
+     * @return Порог изменений.
+     */
+    std::size_t rebuildThreshold() const { return contacts.size() / 16 + 1024; }
+
+    /**
+     * @brief Готовит запросы и выполняет их параллельно, выводя результаты в порядке запросов.
+     * @param lines Строки запросов.
+     * @param pool Пул потоков.
+     * @param out Поток результатов.
+     */
+    void runQueries(const std::vector<std::string>& lines, ThreadPool& pool, std::ostream& out);
+
+public:
+    /**
+     * @brief Конструктор.
+     * @param contacts Хранилище контактов.
+     * @param indices Индекс-массивы (строятся при первом поиске).
+     * @param filename Файл для команды save без аргумента.
+     * @param rejectedRows Строк файла, пропущенных при загрузке; если они есть,
+     * save не перезаписывает файл, чтобы они не были потеряны.
+     */
+    BatchSession(ContactStore& contacts, IndexArray& indices, const std::string& filename,
+                 std::size_t rejectedRows = 0);
+
+    /**
+     * @brief Проверяет, является ли команда запросом (find, tree, list).
+     * @param line Строка команды.
+     * @return true для запросов, не изменяющих контакты.
+     */
+    static bool isQuery(const std::string& line);
+
+    /**
+     * @brief Проверяет, подготовлены ли индексы для запроса.
+     * @param line Строка запроса.
+     * @return true, если query можно выполнять без prepare.
+     */
+    bool isPrepared(const std::string& line) const;
+
+    /**
+     * @brief Перестраивает индексы и выполняет удаления, нужные запросу.
+     * @param line Строка запроса.
+     */
+    void prepare(const std::string& line);
+
+    /**
+     * @brief Выполняет подготовленный запрос, не изменяя сессию.
+     * Вызовы для подготовленных запросов можно выполнять параллельно.
+     * @param line Строка запроса.
+     * @param options Формат и страница вывода.
+     * @param out Поток результатов.
+     */
+    void query(const std::string& line, const ReportOptions& options, std::ostream& out) const;
+
+    /**
+     * @brief Выполняет одну команду с заданным форматом вывода.
+     * @param line Строка команды.
+     * @param options Формат вывода; изменяется командой format.
+     * @param out Поток результатов.
+     * @return false, если получена команда quit.
+     */
+    bool execute(const std::string& line, ReportOptions& options, std::ostream& out);
+
+    /**
+     * @brief Выполняет одну команду.
+     * @param line Строка команды.
+     * @param out Поток результатов.
+     * @return false, если получена команда quit.
+     */
+    bool execute(const std::string& line, std::ostream& out);
+
+    /**
+     * @brief Выполняет команды из потока до конца ввода или quit.
+     * Результаты сбрасываются в поток один раз на пакет: когда во входном
+     * буфере не осталось прочитанных команд и в конце ввода.
+     * @param in Поток команд.
+     * @param out Поток результатов.
+     * @return Количество выполненных команд.
+     */
+    std::size_t run(std::istream& in, std::ostream& out);
+
+    /**
+     * @brief Выполняет команды из потока, как run(in, out), но подряд идущие
+     * запросы, уже прочитанные во входной буфер, выполняет параллельно.
+     * Вывод совпадает с последовательным выполнением.
+     * @param in Поток команд.
+     * @param out Поток результатов.
+     * @param pool Пул потоков для запросов.
+     * @return Количество выполненных команд.
+     */
+    std::size_t run(std::istream& in, std::ostream& out, ThreadPool& pool);
+};
+
+#endif // BATCH_H
@@ -0,0 +1,552 @@
+// bench.cpp
+
+#include "contact.h"
+#include "binary_tree.h"
+#include "linked_list.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<std::uint64_t> allocationCount(0);  // Вызовы operator new с начала работы
+    std::atomic<std::uint64_t> allocationBytes(0);  // Запрошено байт через operator new
+}
+
+// Замещение глобального operator new для подсчёта выделений памяти;
+// operator new[] по умолчанию вызывает его же
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+    if(void* pointer = std::malloc(size ? size : 1))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+using BenchClock = std::chrono::steady_clock;
+
+/**
+ * @enum BenchFormat
+ * @brief Формат вывода результатов замеров.
+ */
+enum class BenchFormat {
+    TEXT,   ///< Выровненная таблица
+    TSV,    ///< Строка заголовка и строки полей через табуляцию
+    JSONL   ///< Один JSON-объект на строку
+};
+
+/**
+ * @struct BenchOptions
+ * @brief Параметры запуска набора замеров.
+ */
+struct BenchOptions {
+    std::vector<std::size_t> sizes{ 1000, 10000, 100000, 1000000 }; ///< Размеры данных
+    std::string filter;             ///< Подстрока имени замера (пусто - все замеры)
+    BenchFormat format = BenchFormat::TEXT; ///< Формат вывода
+    double budget = 0.5;            ///< Время одного замера, с
+    std::size_t maxOps = 10000;     ///< Наибольшее число отдельно замеряемых операций
+    std::size_t maxRuns = 5;        ///< Наибольшее число повторов пакетной операции
+    unsigned seed = 42;             ///< Начальное значение генератора случайных ключей
+};
+
+/**
+ * @struct Measurement
+ * @brief Результат одного замера.
+ */
+struct Measurement {
+    std::string name;               ///< Имя замера
+    std::size_t size = 0;           ///< Размер данных
+    std::uint64_t ops = 0;          ///< Выполнено операций
+    double totalNs = 0;             ///< Общее время операций, нс
+    std::vector<double> samples;    ///< Время одной операции в каждой выборке, нс
+    std::uint64_t allocations = 0;  ///< Выделений памяти за время замера
+    std::uint64_t bytes = 0;        ///< Выделено байт за время замера
+};
+
+/**
+ * @brief Возвращает процентиль выборки (по ближайшему рангу).
+ * @param sorted Отсортированная выборка.
+ * @param percent Процент от 0 до 100.
+ * @return Значение процентиля.
+ */
+double percentile(const std::vector<double>& sorted, double percent) {
+    if(sorted.empty())
+        return 0;
+    std::size_t rank = static_cast<std::size_t>(percent / 100.0 * sorted.size() + 0.999999);
+    return sorted[std::min(sorted.size(), std::max<std::size_t>(rank, 1)) - 1];
+}
+
+/**
+ * @class BenchRunner
+ * @brief Выполняет замеры и выводит результаты по мере готовности.
+ *
+ * Операции, которые выполняются быстро и по одной (поиск, вставка),
+ * замеряются каждая отдельно: процентили относятся к одной операции.
+ * Пакетные операции (построение индексов, загрузка файла) повторяются
+ * целиком, и время повтора делится на число обработанных элементов.
+ * Выделения памяти считаются только внутри замеряемых участков.
+ */
+class BenchRunner {
+private:
+    BenchOptions options;   ///< Параметры запуска
+    std::ostream& out;      ///< Поток результатов
+
+    /**
+     * @brief Выводит результат замера.
+     * @param measurement Результат.
+     */
+    void report(Measurement& measurement) {
+        std::sort(measurement.samples.begin(), measurement.samples.end());
+        double ops = static_cast<double>(std::max<std::uint64_t>(measurement.ops, 1));
+        double nsPerOp = measurement.totalNs / ops;
+        double p50 = percentile(measurement.samples, 50);
+        double p90 = percentile(measurement.samples, 90);
+        double p99 = percentile(measurement.samples, 99);
+        double allocationsPerOp = measurement.allocations / ops;
+        double bytesPerOp = measurement.bytes / ops;
+        char line[256];
+        switch(options.format) {
+            case BenchFormat::TEXT:
+                std::snprintf(line, sizeof(line), "%-24s %10zu %10llu %12.1f %12.1f %12.1f %12.1f %10.2f %12.1f\n",
+                              measurement.name.c_str(), measurement.size,
+                              static_cast<unsigned long long>(measurement.ops), nsPerOp, p50, p90, p99,
+                              allocationsPerOp, bytesPerOp);
+                break;
+            case BenchFormat::TSV:
+                std::snprintf(line, sizeof(line), "%s\t%zu\t%llu\t%.1f\t%.1f\t%.1f\t%.1f\t%.3f\t%.1f\n",
+                              measurement.name.c_str(), measurement.size,
+                              static_cast<unsigned long long>(measurement.ops), nsPerOp, p50, p90, p99,
+                              allocationsPerOp, bytesPerOp);
+                break;
+            case BenchFormat::JSONL:
+                std::snprintf(line, sizeof(line),
+                              "{\"name\":\"%s\",\"size\":%zu,\"ops\":%llu,\"ns_per_op\":%.1f,\"p50\":%.1f,"
+                              "\"p90\":%.1f,\"p99\":%.1f,\"allocs_per_op\":%.3f,\"bytes_per_op\":%.1f}\n",
+                              measurement.name.c_str(), measurement.size,
+                              static_cast<unsigned long long>(measurement.ops), nsPerOp, p50, p90, p99,
+                              allocationsPerOp, bytesPerOp);
+                break;
+        }
+        out << line << std::flush;
+    }
+
+public:
+    /**
+     * @brief Конструктор. Выводит заголовок таблицы.
+     * @param options Параметры запуска.
+     * @param out Поток результатов.
+     */
+    BenchRunner(const BenchOptions& options, std::ostream& out) : options(options), out(out) {
+        if(options.format == BenchFormat::TEXT)
+            out << "замер                      размер   операций     нс/опер          p50          p90"
+                   "          p99  выдел/опер   байт/опер\n";
+        else if(options.format == BenchFormat::TSV)
+            out << "name\tsize\tops\tns_per_op\tp50\tp90\tp99\tallocs_per_op\tbytes_per_op\n";
+    }
+
+    /**
+     * @brief Проверяет, выбран ли замер фильтром.
+     * @param name Имя замера.
+     * @return true, если замер нужно выполнить.
+     */
+    bool enabled(const std::string& name) const {
+        return options.filter.empty() || name.find(options.filter) != std::string::npos;
+    }
+
+    /**
+     * @brief Возвращает параметры запуска.
+     * @return Параметры.
+     */
+    const BenchOptions& settings() const { return options; }
+
+    /**
+     * @brief Замеряет отдельные операции: op(i) для i = 0, 1, ... пока не
+     * исчерпано время замера или count операций (не меньше 10).
+     * @param name Имя замера.
+     * @param size Размер данных.
+     * @param count Наибольшее число операций.
+     * @param op Операция.
+     */
+    template<typename Op>
+    void each(const std::string& name, std::size_t size, std::size_t count, Op op) {
+        if(!enabled(name))
+            return;
+        Measurement measurement;
+        measurement.name = name;
+        measurement.size = size;
+        measurement.samples.reserve(count);
+        auto deadline = BenchClock::now() + std::chrono::duration<double>(options.budget);
+        std::uint64_t allocations = allocationCount.load(), bytes = allocationBytes.load();
+        for(std::size_t i = 0; i < count; ++i) {
+            auto start = BenchClock::now();
+            op(i);
+            auto finish = BenchClock::now();
+            double ns = std::chrono::duration<double, std::nano>(finish - start).count();
+            measurement.samples.push_back(ns);
+            measurement.totalNs += ns;
+            ++measurement.ops;
+            if(finish > deadline && i >= 9)
+                break;
+        }
+        measurement.allocations = allocationCount.load() - allocations;
+        measurement.bytes = allocationBytes.load() - bytes;
+        report(measurement);
+    }
+
+    /**
+     * @brief Замеряет повторы пакетной операции. Перед каждым повтором
+     * вызывается setup (не замеряется); повторы идут, пока не исчерпано время
+     * замера, но не больше maxRuns.
+     * @param name Имя замера.
+     * @param size Размер данных.
+     * @param opsPerRun Число элементов, обработанных за повтор.
+     * @param setup Подготовка повтора.
+     * @param run Пакетная операция.
+     */
+    template<typename Setup, typename Run>
+    void runs(const std::string& name, std::size_t size, std::size_t opsPerRun, Setup setup, Run run) {
+        if(!enabled(name))
+            return;
+        Measurement measurement;
+        measurement.name = name;
+        measurement.size = size;
+        measurement.samples.reserve(options.maxRuns);
+        auto deadline = BenchClock::now() + std::chrono::duration<double>(options.budget);
+        for(std::size_t i = 0; i < options.maxRuns; ++i) {
+            setup();
+            std::uint64_t allocations = allocationCount.load(), bytes = allocationBytes.load();
+            auto start = BenchClock::now();
+            run();
+            auto finish = BenchClock::now();
+            measurement.allocations += allocationCount.load() - allocations;
+            measurement.bytes += allocationBytes.load() - bytes;
+            double ns = std::chrono::duration<double, std::nano>(finish - start).count();
+            measurement.samples.push_back(ns / std::max<std::size_t>(opsPerRun, 1));
+            measurement.totalNs += ns;
+            measurement.ops += opsPerRun;
+            if(finish > deadline)
+                break;
+        }
+        report(measurement);
+    }
+};
+
+/**
+ * @brief Возвращает поля контакта для замеров по его номеру.
+ * Около 10 000 различных имён и 6 городов; номера телефонов различны.
+ * @param i Номер контакта (начиная с 1).
+ * @return Контакт.
+ */
+Contact benchmarkContact(int i) {
+    static const char* cities[] = { "Москва", "Санкт-Петербург", "Казань", "Омск", "Тверь", "Новосибирск" };
+    return Contact{i, "Имя" + std::to_string(i % 9973), std::to_string(1000000 + static_cast<long long>(i) * 7919),
+                   cities[i % 6]};
+}
+
+/**
+ * @brief Создаёт CSV-файл контактов для замеров.
+ * @param filename Имя файла.
+ * @param rows Количество строк.
+ */
+void writeBenchmarkFile(const std::string& filename, int rows) {
+    std::ofstream out(filename, std::ios::binary);
+    for(int i = 1; i <= rows; ++i) {
+        Contact contact = benchmarkContact(i);
+        out << contact.id << "," << contact.name << "," << contact.phoneNumber << "," << contact.city << "\n";
+    }
+}
+
+/**
+ * @brief Выполняет функцию, подавляя сообщения в std::cout.
+ * @param body Функция.
+ */
+template<typename Body>
+void quietly(Body body) {
+    std::cout.setstate(std::ios::failbit);
+    body();
+    std::cout.clear();
+}
+
+/**
+ * @brief Измеряет время загрузки файла.
+ * @param load Функция загрузки.
+ * @return Время в секундах.
+ */
+template<typename Load>
+double measureLoad(Load load) {
+    // Сообщения загрузчика не смешиваются с таблицей результатов
+    auto start = BenchClock::now();
+    quietly(load);
+    auto finish = BenchClock::now();
+    return std::chrono::duration<double>(finish - start).count();
+}
+
+/**
+ * @brief Выполняет все замеры для одного размера данных.
+ * @param runner Исполнитель замеров.
+ * @param n Количество контактов.
+ */
+void benchmarkSize(BenchRunner& runner, std::size_t n) {
+    const BenchOptions& options = runner.settings();
+    std::mt19937 random(options.seed + static_cast<unsigned>(n));
+    ContactStore contacts;
+    for(std::size_t i = 1; i <= n; ++i)
+        contacts.push_back(benchmarkContact(static_cast<int>(i)));
+
+    // Случайные существующие контакты для поиска и удаления
+    std::vector<std::size_t> rows(n);
+    std::iota(rows.begin(), rows.end(), 0);
+    std::shuffle(rows.begin(), rows.end(), random);
+    std::size_t opCount = std::min(options.maxOps, n);
+    std::vector<std::string> keys;
+    for(std::size_t i = 0; i < opCount; ++i)
+        keys.emplace_back(contacts.name(rows[i]));
+
+    // Индекс-массивы
+    IndexArray indices;
+    runner.runs("index.build", n, n, [&]() { indices = IndexArray(); }, [&]() { indices.buildIndices(contacts); });
+    runner.runs("index.sort", n, n, [&]() { indices.buildIndices(contacts); }, [&]() { indices.sortIndices(); });
+    indices.buildIndices(contacts);
+    indices.sortIndices();
+    runner.each("search.iterative", n, opCount, [&](std::size_t i) {
+        binarySearchIterative(indices.nameIndexAsc, keys[i]);
+    });
+    runner.each("search.recursive", n, opCount, [&](std::size_t i) {
+        binarySearchRecursive(indices.nameIndexAsc, keys[i], 0, static_cast<int>(indices.nameIndexAsc.size()) - 1);
+    });
+
+    // Бинарное дерево: операции над деревом из n записей
+    BinaryTree tree;
+    runner.runs("tree.build", n, n, [&]() { tree = BinaryTree(); }, [&]() { tree.buildFromIndex(indices.nameIndexAsc); });
+    if(!runner.enabled("tree.build"))
+        tree.buildFromIndex(indices.nameIndexAsc);
+    runner.each("tree.search", n, opCount, [&](std::size_t i) { tree.search(keys[i]); });
+    runner.each("tree.insert", n, opCount, [&](std::size_t i) {
+        tree.insert("Новое" + std::to_string(i), static_cast<int>(n + 1 + i));
+    });
+    runner.each("tree.remove", n, opCount, [&](std::size_t i) {
+        tree.remove(keys[i], contacts.id(rows[i]));
+    });
+    {
+        std::ostream discard(nullptr);
+        runner.runs("tree.traversal", n, n, []() {}, [&]() {
+            ReportWriter report(discard);
+            tree.inOrder(contacts, report);
+        });
+    }
+
+    // Сохранение и загрузка CSV
+    const std::string filename = "bench_contacts.csv";
+    runner.runs("csv.save", n, n, []() {}, [&]() { quietly([&]() { saveContactsToFile(contacts, filename); }); });
+    if(!runner.enabled("csv.save"))
+        quietly([&]() { saveContactsToFile(contacts, filename); });
+    {
+        ContactStore loaded;
+        runner.runs("csv.load", n, n, []() {}, [&]() { quietly([&]() { loadContactsFromFile(loaded, filename); }); });
+        ThreadPool pool;
+        runner.runs("csv.load_parallel", n, n, []() {}, [&]() {
+            quietly([&]() { loadContactsFromFileParallel(loaded, filename, pool); });
+        });
+    }
+    std::remove(filename.c_str());
+
+    // Линейный список: новые контакты добавляются в хранилище после n исходных
+    for(std::size_t i = 1; i <= opCount; ++i)
+        contacts.push_back(benchmarkContact(static_cast<int>(n + i)));
+    std::vector<int> ids(n);
+    std::iota(ids.begin(), ids.end(), 1);
+    LinkedList list(contacts, PrimarySortAttribute::NAME, SecondarySortAttribute::CITY,
+                    SortOrder::ASCENDING, SortOrder::ASCENDING);
+    list.insertAll(ids);
+    runner.each("list.search", n, opCount, [&](std::size_t i) { list.searchIds(keys[i]); });
+    runner.each("list.insert", n, opCount, [&](std::size_t i) { list.insert(static_cast<int>(n + 1 + i)); });
+    bool byCity = false;
+    runner.runs("list.change_sort", n, n, []() {}, [&]() {
+        byCity = !byCity;
+        list.changeSortAttributes(byCity ? PrimarySortAttribute::CITY : PrimarySortAttribute::NAME,
+                                  byCity ? SecondarySortAttribute::NAME : SecondarySortAttribute::CITY,
+                                  SortOrder::ASCENDING, SortOrder::ASCENDING);
+    });
+}
+
+/**
+ * @brief Выводит строку таблицы масштабирования.
+ * @param threads Количество потоков.
+ * @param seconds Время, с.
+ * @param items Обработано строк или запросов.
+ * @param single Время на одном потоке, с.
+ */
+void printScalingRow(std::size_t threads, double seconds, std::size_t items, double single) {
+    std::cout << threads << "\t" << seconds << "\t" << static_cast<long long>(items / seconds)
+              << "\t" << single / seconds << "\n";
+}
+
+/**
+ * @brief Замер масштабирования от 1 до N потоков: загрузка CSV, построение
+ * индексов и пакетный поиск по индекс-массиву и бинарному дереву.
+ * @param argc Количество аргументов после --scaling.
+ * @param argv Аргументы: [файл.csv|-] [количество строк] [потоков].
+ * @return Код завершения программы.
+ */
+int benchmarkScaling(int argc, char* argv[]) {
+    bool generated = argc <= 0 || std::string(argv[0]) == "-";
+    std::string filename = generated ? "bench_contacts.csv" : argv[0];
+    if(generated) {
+        int rows = argc > 1 ? std::stoi(argv[1]) : 1000000;
+        writeBenchmarkFile(filename, rows);
+    }
+
+    ContactStore contacts;
+    double serial = measureLoad([&] { loadContactsFromFile(contacts, filename); });
+    std::size_t rows = contacts.size();
+    std::cout << "Строк: " << rows << "\n"
+              << "Последовательная загрузка: " << serial << " с, "
+              << static_cast<long long>(rows / serial) << " строк/с\n\n"
+              << "потоки\tвремя, с\tстрок/с\tускорение\n";
+
+    // 1, 2, 4, ... и число аппаратных потоков
+    std::size_t maxThreads = argc > 2 ? std::stoul(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::size_t> threadCounts;
+    for(std::size_t threads = 1; threads < maxThreads; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(maxThreads);
+
+    double single = 0;
+    for(std::size_t threads : threadCounts) {
+        ThreadPool pool(threads);
+        double seconds = measureLoad([&] { loadContactsFromFileParallel(contacts, filename, pool); });
+        if(threads == 1)
+            single = seconds;
+        printScalingRow(threads, seconds, rows, single);
+    }
+
+    // Построение и сортировка индексов
+    std::cout << "\nПостроение индексов\nпотоки\tвремя, с\tстрок/с\tускорение\n";
+    IndexArray indices;
+    for(std::size_t threads : threadCounts) {
+        ThreadPool pool(threads);
+        indices = IndexArray();
+        double seconds = measureLoad([&] {
+            indices.buildIndices(contacts, pool);
+            indices.sortIndices(pool);
+        });
+        if(threads == 1)
+            single = seconds;
+        printScalingRow(threads, seconds, rows, single);
+    }
+
+    // Пакетный поиск только читает индекс и дерево, поэтому задачи не разделяют изменяемых данных
+    BinaryTree tree;
+    tree.buildFromIndex(indices.nameIndexAsc);
+    const std::size_t queryCount = 1000000;
+    std::mt19937 random(42);
+    std::vector<std::string> keys;
+    keys.reserve(queryCount);
+    for(std::size_t i = 0; i < queryCount && rows > 0; ++i)
+        keys.emplace_back(contacts.name(random() % rows));
+    std::cout << "\nПакетный поиск (индекс и дерево)\nпотоки\tвремя, с\tзапросов/с\tускорение\n";
+    for(std::size_t threads : threadCounts) {
+        ThreadPool pool(threads);
+        std::atomic<std::size_t> found(0);
+        std::size_t parts = threads * 8;
+        double seconds = measureLoad([&] {
+            pool.parallelFor(parts, [&](std::size_t part) {
+                std::size_t count = 0;
+                for(std::size_t i = keys.size() * part / parts; i < keys.size() * (part + 1) / parts; ++i)
+                    count += binarySearchIterative(indices.nameIndexAsc, keys[i]).size() + tree.search(keys[i]).size();
+                found.fetch_add(count, std::memory_order_relaxed);
+            });
+        });
+        if(threads == 1)
+            single = seconds;
+        printScalingRow(threads, seconds, keys.size(), single);
+    }
+
+    if(generated)
+        std::remove(filename.c_str());
+    return 0;
+}
+
+/**
+ * @brief Набор замеров всех структур данных (contact_bench).
+ *
+ * Использование:
+ *   bench [--sizes 1000,10000,...] [--filter подстрока] [--format text|tsv|jsonl]
+ *         [--budget секунд] [--ops N] [--runs N] [--seed N]
+ *   bench --scaling [файл.csv|-] [количество строк] [потоков]
+ * Режим --scaling замеряет загрузку, построение индексов и пакетный поиск
+ * на 1, 2, 4, ... потоках.
+ * По умолчанию размеры 10^3-10^6; 10^7 задаётся явно (--sizes 10000000).
+ * Данные и ключи поиска детерминированы (--seed), поэтому результаты
+ * запусков сравнимы; форматы tsv и jsonl предназначены для отслеживания
+ * регрессий.
+ */
+int main(int argc, char* argv[]) {
+    if(argc > 1 && std::string(argv[1]) == "--scaling")
+        return benchmarkScaling(argc - 2, argv + 2);
+
+    BenchOptions options;
+    for(int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        std::string value = i + 1 < argc ? argv[i + 1] : "";
+        if(argument == "--sizes" && !value.empty()) {
+            options.sizes.clear();
+            std::istringstream list(value);
+            std::string size;
+            while(std::getline(list, size, ','))
+                options.sizes.push_back(std::stoull(size));
+        }
+        else if(argument == "--filter") {
+            options.filter = value;
+        }
+        else if(argument == "--format" && (value == "text" || value == "tsv" || value == "jsonl")) {
+            options.format = value == "text" ? BenchFormat::TEXT : value == "tsv" ? BenchFormat::TSV : BenchFormat::JSONL;
+        }
+        else if(argument == "--budget" && !value.empty()) {
+            options.budget = std::stod(value);
+        }
+        else if(argument == "--ops" && !value.empty()) {
+            options.maxOps = std::stoull(value);
+        }
+        else if(argument == "--runs" && !value.empty()) {
+            options.maxRuns = std::stoull(value);
+        }
+        else if(argument == "--seed" && !value.empty()) {
+            options.seed = static_cast<unsigned>(std::stoul(value));
+        }
+        else {
+            std::cerr << "Неизвестный параметр: " << argument << "\n";
+            return 1;
+        }
+        ++i;
+    }
+    if(options.maxOps == 0 || options.maxRuns == 0) {
+        std::cerr << "Число операций и повторов должно быть положительным\n";
+        return 1;
+    }
+
+    BenchRunner runner(options, std::cout);
+    for(std::size_t size : options.sizes) {
+        if(size > 0)
+            benchmarkSize(runner, size);
+    }
+    return 0;
+}
@@ -1,6 +1,7 @@
 // binary_tree.cpp
 
 #include "binary_tree.h"
+#include "trace.h"
 #include <algorithm>
 #include <iostream>
 
@@ -78,7 +79,7 @@ TreeNode* BinaryTree::findMin(TreeNode* node) const {
 }
 
 // Вставка узла с балансировкой
-TreeNode* BinaryTree::insert(TreeNode* node, const std::string& key, int recordNumber) {
+TreeNode* BinaryTree::insert(TreeNode* node, std::string_view key, int recordNumber) {
     // Стандартная вставка в BST
     if(!node)
         return new TreeNode(key, recordNumber);
@@ -124,7 +125,7 @@ TreeNode* BinaryTree::insert(TreeNode* node, const std::string& key, int recordN
 }
 
 // Вставка внешним интерфейсом
-void BinaryTree::insert(const std::string& key, int recordNumber) {
+void BinaryTree::insert(std::string_view key, int recordNumber) {
     root.reset(insert(root.release(), key, recordNumber));
 }
 
@@ -215,6 +216,89 @@ void BinaryTree::remove(const std::string& key, int recordNumber) {
     root.reset(deleteNode(root.release(), key, recordNumber));
 }
 
+// Извлечение узлов с фильтрацией записей
+size_t BinaryTree::drainNodes(std::unique_ptr<TreeNode> node, const std::unordered_set<int>& recordNumbers,
+                              std::vector<std::unique_ptr<TreeNode>>& kept) {
+    if(!node)
+        return 0;
+    size_t removed = drainNodes(std::move(node->left), recordNumbers, kept);
+    std::unique_ptr<TreeNode> right = std::move(node->right);
+
+    // Удаление записей узла
+    size_t before = node->recordNumbers.size();
+    node->recordNumbers.erase(
+        std::remove_if(node->recordNumbers.begin(), node->recordNumbers.end(),
+                       [&](int id) { return recordNumbers.count(id) > 0; }),
+        node->recordNumbers.end()
+    );
+    removed += before - node->recordNumbers.size();
+    if(!node->recordNumbers.empty())
+        kept.push_back(std::move(node));
+
+    removed += drainNodes(std::move(right), recordNumbers, kept);
+    return removed;
+}
+
+// Построение сбалансированного поддерева
+std::unique_ptr<TreeNode> BinaryTree::buildBalanced(std::vector<std::unique_ptr<TreeNode>>& nodes, size_t begin, size_t end) {
+    if(begin >= end)
+        return nullptr;
+    size_t mid = begin + (end - begin) / 2;
+    std::unique_ptr<TreeNode> node = std::move(nodes[mid]);
+    node->left = buildBalanced(nodes, begin, mid);
+    node->right = buildBalanced(nodes, mid + 1, end);
+    node->height = 1 + std::max(getHeight(node->left.get()), getHeight(node->right.get()));
+    return node;
+}
+
+// Построение дерева из отсортированного индекса
+void BinaryTree::buildFromIndex(const std::vector<Index>& nameIndexAsc) {
+    STATS_TIMED(StatOperation::TREE_BUILD);
+    TRACE_SPAN("BinaryTree::buildFromIndex");
+    std::vector<std::unique_ptr<TreeNode>> sorted;
+    for(size_t i = 0; i < nameIndexAsc.size(); ) {
+        auto node = std::make_unique<TreeNode>(nameIndexAsc[i].key, nameIndexAsc[i].recordNumber);
+        for(++i; i < nameIndexAsc.size() && nameIndexAsc[i].key == node->key; ++i)
+            node->recordNumbers.push_back(nameIndexAsc[i].recordNumber);
+        std::sort(node->recordNumbers.begin(), node->recordNumbers.end());
+        sorted.push_back(std::move(node));
+    }
+    root = buildBalanced(sorted, 0, sorted.size());
+}
+
+// Пакетное удаление записей
+size_t BinaryTree::removeRecords(const std::unordered_set<int>& recordNumbers) {
+    if(recordNumbers.empty() || !root)
+        return 0;
+    TRACE_SPAN("BinaryTree::removeRecords");
+    std::vector<std::unique_ptr<TreeNode>> kept;
+    size_t removed = drainNodes(std::move(root), recordNumbers, kept);
+    root = buildBalanced(kept, 0, kept.size());
+    return removed;
+}
+
+// Объём памяти дерева
+MemoryUsage BinaryTree::memoryUsage() const {
+    MemoryUsage usage;
+    // Обход без рекурсии: стек не глубже высоты дерева
+    std::vector<const TreeNode*> pending;
+    if(root)
+        pending.push_back(root.get());
+    while(!pending.empty()) {
+        const TreeNode* node = pending.back();
+        pending.pop_back();
+        ++usage.elements;
+        usage.addBlock(sizeof(TreeNode), sizeof(TreeNode));
+        usage.addString(node->key);
+        usage.addVector(node->recordNumbers);
+        if(node->left)
+            pending.push_back(node->left.get());
+        if(node->right)
+            pending.push_back(node->right.get());
+    }
+    return usage;
+}
+
 // Поиск узла в поддереве
 TreeNode* BinaryTree::search(TreeNode* node, const std::string& key) const {
     if(node == nullptr || node->key == key)
@@ -227,8 +311,10 @@ TreeNode* BinaryTree::search(TreeNode* node, const std::string& key) const {
 
 // Поиск внешним интерфейсом
 std::vector<int> BinaryTree::search(const std::string& key) const {
+    STATS_TIMED(StatOperation::SEARCH);
     TreeNode* foundNode = search(root.get(), key);
     if(foundNode != nullptr) {
+        STATS_COUNT(StatCounter::FOUND, foundNode->recordNumbers.size());
         return foundNode->recordNumbers;
     }
     else {
@@ -237,36 +323,28 @@ std::vector<int> BinaryTree::search(const std::string& key) const {
 }
 
 // Обход дерева (in-order)
-void BinaryTree::inOrderTraversal(TreeNode* node, const std::vector<Contact>& contacts, bool ascending) const {
-    if (node == nullptr) return;
-    if (ascending) {
-        inOrderTraversal(node->left.get(), contacts, ascending);
-    }
-    else {
-        inOrderTraversal(node->right.get(), contacts, ascending);
-    }
+bool BinaryTree::inOrderTraversal(TreeNode* node, const ContactStore& contacts, bool ascending, ReportWriter& report) const {
+    if (node == nullptr) return true;
+    if (!inOrderTraversal(ascending ? node->left.get() : node->right.get(), contacts, ascending, report))
+        return false;
 
     // Вывод всех записей в узле
     for(auto id : node->recordNumbers) {
-        if(id - 1 >= 0 && id - 1 < contacts.size()) {
-            const auto& contact = contacts[id - 1];
-            std::cout << "ID: " << contact.id << "\n"
-                      << "Имя: " << contact.name << "\n"
-                      << "Номер телефона: " << contact.phoneNumber << "\n"
-                      << "Город: " << contact.city << "\n"
-                      << "-----------------------------\n";
-        }
+        std::size_t row = contacts.rowOf(id);
+        if(row != ContactStore::npos && !report.write(contacts[row]))
+            return false;
     }
 
-    if (ascending) {
-        inOrderTraversal(node->right.get(), contacts, ascending);
-    }
-    else {
-        inOrderTraversal(node->left.get(), contacts, ascending);
-    }
+    return inOrderTraversal(ascending ? node->right.get() : node->left.get(), contacts, ascending, report);
 }
 
 // Обход дерева внешним интерфейсом
-void BinaryTree::inOrder(const std::vector<Contact>& contacts, bool ascending) const {
-    inOrderTraversal(root.get(), contacts, ascending);
+void BinaryTree::inOrder(const ContactStore& contacts, bool ascending) const {
+    ReportWriter report(std::cout);
+    inOrderTraversal(root.get(), contacts, ascending, report);
+}
+
+// Обход дерева с общим выводом
+void BinaryTree::inOrder(const ContactStore& contacts, ReportWriter& report, bool ascending) const {
+    inOrderTraversal(root.get(), contacts, ascending, report);
 }
@@ -3,10 +3,12 @@
 #ifndef BINARY_TREE_H
 #define BINARY_TREE_H
 
-#include "contact.h" // Для доступа к структуре Contact
+#include "contact.h" // Для доступа к хранилищу контактов
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
+#include <unordered_set>
 
 /**
  * @struct TreeNode
@@ -24,7 +26,7 @@ struct TreeNode {
      * @param key Ключ узла.
      * @param recordNumber Номер записи.
      */
-    TreeNode(const std::string& key, int recordNumber)
+    TreeNode(std::string_view key, int recordNumber)
         : key(key), recordNumbers{ recordNumber }, height(1) {}
 };
 
@@ -45,7 +47,7 @@ private:
      * @param recordNumber Номер записи.
      * @return Указатель на узел после вставки и балансировки.
      */
-    TreeNode* insert(TreeNode* node, const std::string& key, int recordNumber);
+    TreeNode* insert(TreeNode* node, std::string_view key, int recordNumber);
 
     /**
      * @brief Удаляет номер записи из поддерева.
@@ -67,10 +69,12 @@ private:
     /**
      * @brief Выполняет обход дерева в порядке in-order и выводит контакты.
      * @param node Текущий узел поддерева.
-     * @param contacts Вектор контактов.
+     * @param contacts Хранилище контактов.
      * @param ascending Порядок обхода: true - по возрастанию, false - по убыванию.
+     * @param report Вывод с форматом и страницей.
+     * @return false, если страница заполнена и обход прерван.
      */
-    void inOrderTraversal(TreeNode* node, const std::vector<Contact>& contacts, bool ascending) const;
+    bool inOrderTraversal(TreeNode* node, const ContactStore& contacts, bool ascending, ReportWriter& report) const;
 
     // Функции для балансировки
 
@@ -109,6 +113,26 @@ private:
      */
     TreeNode* findMin(TreeNode* node) const;
 
+    /**
+     * @brief Извлекает узлы поддерева в порядке in-order, удаляя из них заданные записи.
+     * Узлы, у которых не осталось записей, освобождаются.
+     * @param node Корень поддерева.
+     * @param recordNumbers Номера удаляемых записей.
+     * @param kept Вектор для оставшихся узлов.
+     * @return Количество удалённых записей.
+     */
+    size_t drainNodes(std::unique_ptr<TreeNode> node, const std::unordered_set<int>& recordNumbers,
+                      std::vector<std::unique_ptr<TreeNode>>& kept);
+
+    /**
+     * @brief Строит сбалансированное поддерево из отсортированных узлов.
+     * @param nodes Узлы в порядке возрастания ключей.
+     * @param begin Начало диапазона.
+     * @param end Конец диапазона (не включительно).
+     * @return Корень построенного поддерева.
+     */
+    std::unique_ptr<TreeNode> buildBalanced(std::vector<std::unique_ptr<TreeNode>>& nodes, size_t begin, size_t end);
+
 public:
     /**
      * @brief Конструктор класса BinaryTree.
@@ -142,7 +166,15 @@ public:
      * @param key Ключ для вставки.
      * @param recordNumber Номер записи.
      */
-    void insert(const std::string& key, int recordNumber);
+    void insert(std::string_view key, int recordNumber);
+
+    /**
+     * @brief Строит дерево заново из отсортированного по возрастанию индекса имён.
+     * Узлы создаются по одному на ключ и собираются сбалансированными за O(n)
+     * без поворотов. Записи в узле упорядочены по возрастанию.
+     * @param nameIndexAsc Индекс по имени по возрастанию.
+     */
+    void buildFromIndex(const std::vector<Index>& nameIndexAsc);
 
     /**
      * @brief Удаляет номер записи из дерева.
@@ -151,12 +183,30 @@ public:
      */
     void remove(const std::string& key, int recordNumber);
 
+    /**
+     * @brief Удаляет из дерева все записи с заданными номерами.
+     * Выполняет один обход дерева и перестраивает его сбалансированным за O(n),
+     * вместо отдельного удаления с балансировкой для каждой записи.
+     * @param recordNumbers Номера удаляемых записей.
+     * @return Количество удалённых записей.
+     */
+    size_t removeRecords(const std::unordered_set<int>& recordNumbers);
+
     /**
      * @brief Выполняет обход дерева и выводит контакты.
-     * @param contacts Вектор контактов.
+     * @param contacts Хранилище контактов.
+     * @param ascending Порядок обхода: true - по возрастанию, false - по убыванию.
+     */
+    void inOrder(const ContactStore& contacts, bool ascending = true) const;
+
+    /**
+     * @brief Выполняет обход дерева и выводит контакты через общий вывод.
+     * Обход прекращается, когда страница вывода заполнена.
+     * @param contacts Хранилище контактов.
+     * @param report Вывод с форматом и страницей.
      * @param ascending Порядок обхода: true - по возрастанию, false - по убыванию.
      */
-    void inOrder(const std::vector<Contact>& contacts, bool ascending = true) const;
+    void inOrder(const ContactStore& contacts, ReportWriter& report, bool ascending = true) const;
 
     /**
      * @brief Ищет контакты по ключу.
@@ -164,6 +214,12 @@ public:
      * @return Вектор ID найденных контактов.
      */
     std::vector<int> search(const std::string& key) const;
+
+    /**
+     * @brief Возвращает объём памяти дерева: узлы, ключи и номера записей.
+     * @return Объём памяти; элементы - узлы.
+     */
+    MemoryUsage memoryUsage() const;
 };
 
 #endif // BINARY_TREE_H
@@ -0,0 +1,155 @@
+// client.cpp
+
+#include "server.h"
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+
+/**
+ * @brief Проверяет, завершился ли ответ строкой ошибки.
+ * @param response Ответ сервера с завершающим переводом строки.
+ * @return true, если последняя строка начинается с "error:".
+ */
+bool isErrorResponse(const std::string& response) {
+    std::size_t end = response.size() > 1 ? response.rfind('\n', response.size() - 2) : std::string::npos;
+    std::size_t last = end == std::string::npos ? 0 : end + 1;
+    return response.compare(last, 6, "error:") == 0;
+}
+
+/**
+ * @brief Передаёт команды из потока серверу и выводит ответы.
+ * @param socketPath Путь сокета сервера.
+ * @param in Поток команд.
+ * @return Код завершения программы.
+ */
+int runCommands(const std::string& socketPath, std::istream& in) {
+    ServerClient client;
+    if(!client.connect(socketPath))
+        return 1;
+    std::string line, response;
+    while(std::getline(in, line)) {
+        // Пустые строки и комментарии сервер не подтверждает, поэтому они не отправляются
+        if(line.empty() || line[0] == '#')
+            continue;
+        if(!client.request(line, response)) {
+            std::cerr << "Соединение с сервером разорвано\n";
+            return 1;
+        }
+        std::cout << response;
+        if(line == "quit")
+            break;
+    }
+    std::cout.flush();
+    return 0;
+}
+
+/**
+ * @brief Нагружает сервер запросами из нескольких соединений и выводит пропускную способность.
+ * @param socketPath Путь сокета сервера.
+ * @param connections Количество параллельных соединений.
+ * @param requests Количество команд на соединение.
+ * @param pipeline Сколько команд соединение отправляет, не дожидаясь ответов.
+ * @param commands Команды, выполняемые по кругу; пустой вектор - поиск случайных имён.
+ * @return Код завершения программы.
+ */
+int runLoad(const std::string& socketPath, std::size_t connections, std::size_t requests, std::size_t pipeline,
+            const std::vector<std::string>& commands) {
+    std::atomic<std::size_t> completed(0), errors(0), failed(0);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for(std::size_t t = 0; t < connections; ++t) {
+        threads.emplace_back([&, t]() {
+            ServerClient client;
+            if(!client.connect(socketPath)) {
+                ++failed;
+                return;
+            }
+            std::mt19937 random(static_cast<unsigned>(t + 1));
+            std::size_t next = t;
+            auto command = [&]() {
+                if(!commands.empty())
+                    return commands[next++ % commands.size()];
+                return "find name Имя" + std::to_string(random() % 9973);
+            };
+            std::size_t sent = 0, received = 0;
+            std::string response;
+            while(received < requests) {
+                // Окно из pipeline команд без ожидания ответов
+                while(sent < requests && sent - received < pipeline) {
+                    if(!client.send(command())) {
+                        ++failed;
+                        return;
+                    }
+                    ++sent;
+                }
+                if(!client.receive(response)) {
+                    ++failed;
+                    return;
+                }
+                ++received;
+                ++completed;
+                if(isErrorResponse(response))
+                    ++errors;
+            }
+        });
+    }
+    for(auto& thread : threads)
+        thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Соединений: " << connections << ", команд: " << completed.load() << ", ошибок в ответах: "
+              << errors.load() << ", оборванных соединений: " << failed.load() << "\n"
+              << "Время: " << seconds << " с, " << static_cast<long long>(completed.load() / seconds) << " команд/с\n";
+    return failed.load() == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    if(argc < 2) {
+        std::cerr << "Использование: " << argv[0] << " <сокет> [файл команд]\n"
+                  << "               " << argv[0]
+                  << " <сокет> --load <соединений> <команд на соединение> [окно] [файл команд]\n";
+        return 1;
+    }
+    std::ios::sync_with_stdio(false);
+    const std::string socketPath = argv[1];
+
+    if(argc > 2 && std::string(argv[2]) == "--load") {
+        std::size_t connections = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 8;
+        std::size_t requests = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 10000;
+        std::size_t pipeline = argc > 5 ? std::strtoul(argv[5], nullptr, 10) : 1;
+        std::vector<std::string> commands;
+        if(argc > 6) {
+            std::ifstream in(argv[6]);
+            if(!in) {
+                std::cerr << "Не удалось открыть файл команд: " << argv[6] << "\n";
+                return 1;
+            }
+            std::string line;
+            while(std::getline(in, line)) {
+                if(!line.empty() && line[0] != '#')
+                    commands.push_back(line);
+            }
+        }
+        if(connections == 0 || requests == 0 || pipeline == 0) {
+            std::cerr << "Количество соединений, команд и окно должны быть положительными\n";
+            return 1;
+        }
+        return runLoad(socketPath, connections, requests, pipeline, commands);
+    }
+
+    if(argc > 2) {
+        std::ifstream script(argv[2]);
+        if(!script) {
+            std::cerr << "Не удалось открыть файл команд: " << argv[2] << "\n";
+            return 1;
+        }
+        return runCommands(socketPath, script);
+    }
+    return runCommands(socketPath, std::cin);
+}
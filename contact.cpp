@@ -1,16 +1,144 @@
 // contact.cpp
 
 #include "contact.h"
+#include "csv_reader.h"
+#include "csv_writer.h"
+#include "trace.h"
 #include <iostream>
 #include <algorithm>
+#include <functional>
+#include <iterator>
 #include <limits>
-#include <fstream>
+#include <numeric>
 
 // Инициализация глобального счётчика
 int global_id_counter = 1;
 
+namespace {
+    // Порядки индексов полные: равные ключи упорядочены по номеру записи,
+    // поэтому последовательная и параллельная сортировки дают один результат
+    bool nameAscLess(const Index& a, const Index& b) {
+        int order = a.key.compare(b.key);
+        return order != 0 ? order < 0 : a.recordNumber < b.recordNumber;
+    }
+
+    bool nameDescLess(const Index& a, const Index& b) {
+        int order = a.key.compare(b.key);
+        return order != 0 ? order > 0 : a.recordNumber < b.recordNumber;
+    }
+
+    bool phoneLess(const PhoneIndex& a, const PhoneIndex& b) {
+        return a.phone != b.phone ? a.phone < b.phone : a.recordNumber < b.recordNumber;
+    }
+
+    /**
+     * @class ParallelSorter
+     * @brief Сортировка массива отрезками с последующими раундами попарных слияний.
+     *
+     * Задачи отрезков и каждого раунда слияний выполняются одним parallelFor.
+     */
+    template<typename T>
+    class ParallelSorter {
+    private:
+        std::vector<T>& values;                 // Сортируемый массив
+        bool (*less)(const T&, const T&);       // Полный порядок
+        std::vector<T> buffer;                  // Второй массив для слияний
+        std::vector<std::size_t> runs;          // Границы упорядоченных отрезков
+        bool inBuffer;                          // Текущие отрезки лежат в buffer
+
+    public:
+        ParallelSorter(std::vector<T>& values, bool (*less)(const T&, const T&), std::size_t parts)
+            : values(values), less(less), inBuffer(false) {
+            parts = std::max<std::size_t>(1, std::min(parts, values.size() / 4096 + 1));
+            for(std::size_t i = 0; i <= parts; ++i)
+                runs.push_back(values.size() / parts * i + std::min(i, values.size() % parts));
+        }
+
+        // Сортировка каждого отрезка
+        void sortTasks(std::vector<std::function<void()>>& tasks) {
+            for(std::size_t i = 0; i + 1 < runs.size(); ++i) {
+                tasks.push_back([this, i] {
+                    std::sort(values.begin() + runs[i], values.begin() + runs[i + 1], less);
+                });
+            }
+        }
+
+        // Слияние соседних пар отрезков; false, если остался один отрезок
+        bool mergeTasks(std::vector<std::function<void()>>& tasks) {
+            if(runs.size() <= 2)
+                return false;
+            if(buffer.size() != values.size())
+                buffer.resize(values.size());
+            for(std::size_t i = 0; i + 1 < runs.size(); i += 2) {
+                tasks.push_back([this, i] {
+                    std::vector<T>& from = inBuffer ? buffer : values;
+                    std::vector<T>& to = inBuffer ? values : buffer;
+                    // Последний отрезок без пары переносится как есть
+                    std::size_t middle = runs[i + 1];
+                    std::size_t end = i + 2 < runs.size() ? runs[i + 2] : middle;
+                    std::merge(std::make_move_iterator(from.begin() + runs[i]),
+                               std::make_move_iterator(from.begin() + middle),
+                               std::make_move_iterator(from.begin() + middle),
+                               std::make_move_iterator(from.begin() + end),
+                               to.begin() + runs[i], less);
+                });
+            }
+            return true;
+        }
+
+        // Границы после раунда слияний
+        void mergeDone() {
+            std::vector<std::size_t> merged;
+            for(std::size_t i = 0; i < runs.size(); i += 2)
+                merged.push_back(runs[i]);
+            if(merged.back() != runs.back())
+                merged.push_back(runs.back());
+            runs.swap(merged);
+            inBuffer = !inBuffer;
+        }
+
+        // Результат в исходном массиве
+        void finish() {
+            if(inBuffer)
+                values.swap(buffer);
+            std::vector<T>().swap(buffer);
+        }
+    };
+
+    // Выполнение списка задач на пуле
+    void runTasks(ThreadPool& pool, std::vector<std::function<void()>>& tasks) {
+        pool.parallelFor(tasks.size(), [&](std::size_t i) { tasks[i](); });
+        tasks.clear();
+    }
+
+    // Сортировка массива отрезками и раундами слияний на пуле
+    template<typename T>
+    void sortOnPool(ThreadPool& pool, std::vector<T>& values, bool (*less)(const T&, const T&), std::size_t parts) {
+        ParallelSorter<T> sorter(values, less, parts);
+        std::vector<std::function<void()>> tasks;
+        {
+            TRACE_SPAN("sort runs");
+            sorter.sortTasks(tasks);
+            runTasks(pool, tasks);
+        }
+        while(sorter.mergeTasks(tasks)) {
+            TRACE_SPAN("merge round");
+            runTasks(pool, tasks);
+            sorter.mergeDone();
+        }
+        sorter.finish();
+    }
+
+    // Сообщение о загрузке файла и пропущенных строках
+    void reportLoaded(const std::string& filename, std::size_t rejected) {
+        std::cout << "Контакты успешно загружены из файла " << filename << "\n";
+        if(rejected > 0)
+            std::cerr << "Пропущено некорректных строк файла " << filename << ": " << rejected << "\n";
+    }
+}
+
 // Ввод данных контактов с валидацией
-void inputContacts(std::vector<Contact>& contacts) {
+void inputContacts(ContactStore& contacts) {
     int numContacts;
     std::cout << "Введите количество контактов: ";
     while(!(std::cin >> numContacts) || numContacts < 0) {
@@ -59,96 +187,208 @@ void inputContacts(std::vector<Contact>& contacts) {
 }
 
 // Построение индекс-массивов
-void IndexArray::buildIndices(const std::vector<Contact>& contacts) {
+void IndexArray::buildIndices(const ContactStore& contacts) {
+    TRACE_SPAN("IndexArray::buildIndices");
+    STATS_TIMED(StatOperation::INDEX_BUILD);
+    STATS_COUNT(StatCounter::INDEXED, contacts.size());
     nameIndexAsc.clear();
     nameIndexDesc.clear();
-    cityIndexAsc.clear();
-    cityIndexDesc.clear();
+    phoneIndex.clear();
 
     for(const auto& contact : contacts) {
         Index idx;
-        idx.key = contact.name;
+        idx.key = std::string(contact.name);
         idx.recordNumber = contact.id;
         nameIndexAsc.push_back(idx);
         nameIndexDesc.push_back(idx);
+        phoneIndex.push_back(PhoneIndex{ contact.phoneNumber, contact.id });
+    }
+    buildCityIndices(contacts);
+}
+
+// Параллельное построение индекс-массивов
+void IndexArray::buildIndices(const ContactStore& contacts, ThreadPool& pool) {
+    TRACE_SPAN("IndexArray::buildIndices");
+    STATS_TIMED(StatOperation::INDEX_BUILD);
+    STATS_COUNT(StatCounter::INDEXED, contacts.size());
+    std::size_t rows = contacts.size();
+    nameIndexAsc.assign(rows, Index());
+    nameIndexDesc.assign(rows, Index());
+    phoneIndex.assign(rows, PhoneIndex());
+
+    // Части строк заполняются независимо, индексы по городу - отдельной задачей
+    std::size_t parts = std::max<std::size_t>(1, std::min(pool.size() * 4, rows / 4096 + 1));
+    pool.parallelFor(parts + 1, [&](std::size_t part) {
+        if(part == parts) {
+            TRACE_SPAN("build city indices");
+            buildCityIndices(contacts);
+            return;
+        }
+        TRACE_SPAN("fill index part");
+        std::size_t end = rows / parts * (part + 1) + std::min(part + 1, rows % parts);
+        for(std::size_t row = rows / parts * part + std::min(part, rows % parts); row < end; ++row) {
+            ContactView contact = contacts[row];
+            nameIndexAsc[row].key.assign(contact.name);
+            nameIndexAsc[row].recordNumber = contact.id;
+            nameIndexDesc[row] = nameIndexAsc[row];
+            phoneIndex[row] = PhoneIndex{ contact.phoneNumber, contact.id };
+        }
+    });
+}
 
-        idx.key = contact.city;
-        cityIndexAsc.push_back(idx);
-        cityIndexDesc.push_back(idx);
+// Индексы по городу
+void IndexArray::buildCityIndices(const ContactStore& contacts) {
+    // Сортировка подсчётом по рангам городов в отсортированном словаре
+    const std::vector<std::uint32_t>& ranks = contacts.cityRanks();
+    std::size_t buckets = ranks.size();
+    std::vector<std::size_t> start(buckets + 1, 0);
+    for(std::size_t row = 0; row < contacts.size(); ++row)
+        ++start[ranks[contacts.cityCode(row)] + 1];
+    for(std::size_t b = 0; b < buckets; ++b)
+        start[b + 1] += start[b];
+
+    std::vector<std::size_t> next(start.begin(), start.end() - 1);
+    cityIndexAsc.recordNumbers.assign(contacts.size(), 0);
+    for(std::size_t row = 0; row < contacts.size(); ++row)
+        cityIndexAsc.recordNumbers[next[ranks[contacts.cityCode(row)]]++] = contacts.id(row);
+    cityIndexAsc.bucketStart = start;
+    cityIndexAsc.bucketOfCode = ranks;
+
+    // Индекс по убыванию - те же группы в обратном порядке
+    cityIndexDesc.recordNumbers.clear();
+    cityIndexDesc.recordNumbers.reserve(contacts.size());
+    cityIndexDesc.bucketStart.assign(1, 0);
+    for(std::size_t b = buckets; b-- > 0; ) {
+        cityIndexDesc.recordNumbers.insert(cityIndexDesc.recordNumbers.end(),
+                                           cityIndexAsc.recordNumbers.begin() + start[b],
+                                           cityIndexAsc.recordNumbers.begin() + start[b + 1]);
+        cityIndexDesc.bucketStart.push_back(cityIndexDesc.recordNumbers.size());
     }
+    cityIndexDesc.bucketOfCode.resize(buckets);
+    for(std::size_t code = 0; code < buckets; ++code)
+        cityIndexDesc.bucketOfCode[code] = static_cast<std::uint32_t>(buckets - 1 - ranks[code]);
 }
 
 // Сортировка индекс-массивов
 void IndexArray::sortIndices() {
+    STATS_TIMED(StatOperation::INDEX_SORT);
+    TRACE_SPAN("IndexArray::sortIndices");
     // Сортировка по имени по возрастанию
-    std::sort(nameIndexAsc.begin(), nameIndexAsc.end(),
-              [](const Index& a, const Index& b) { return a.key < b.key; });
+    {
+        TRACE_SPAN("sort name asc");
+        std::sort(nameIndexAsc.begin(), nameIndexAsc.end(), nameAscLess);
+    }
 
     // Сортировка по имени по убыванию
-    std::sort(nameIndexDesc.begin(), nameIndexDesc.end(),
-              [](const Index& a, const Index& b) { return a.key > b.key; });
+    {
+        TRACE_SPAN("sort name desc");
+        std::sort(nameIndexDesc.begin(), nameIndexDesc.end(), nameDescLess);
+    }
+
+    // Сортировка по номеру телефона: сравнение целых чисел
+    {
+        TRACE_SPAN("sort phone");
+        std::sort(phoneIndex.begin(), phoneIndex.end(), phoneLess);
+    }
 
-    // Сортировка по городу по возрастанию
-    std::sort(cityIndexAsc.begin(), cityIndexAsc.end(),
-              [](const Index& a, const Index& b) { return a.key < b.key; });
+    // Индексы по городу уже упорядочены сортировкой подсчётом в buildIndices
+}
+
+// Параллельная сортировка индекс-массивов
+void IndexArray::sortIndices(ThreadPool& pool, const std::function<void()>& nameAscSorted) {
+    STATS_TIMED(StatOperation::INDEX_SORT);
+    TRACE_SPAN("IndexArray::sortIndices");
+    // Каждый массив сортируется своей задачей группы и не ждёт раундов слияний остальных
+    std::size_t parts = pool.size() * 2;
+    TaskGroup group(pool);
+    group.run([&]() {
+        sortOnPool(pool, nameIndexAsc, nameAscLess, parts);
+        if(nameAscSorted)
+            nameAscSorted();
+    });
+    group.run([&]() { sortOnPool(pool, nameIndexDesc, nameDescLess, parts); });
+    sortOnPool(pool, phoneIndex, phoneLess, parts);
+    group.wait();
+}
+
+// Удаление записей из индекс-массивов
+void IndexArray::removeRecords(const std::unordered_set<int>& recordNumbers) {
+    if(recordNumbers.empty())
+        return;
+    TRACE_SPAN("IndexArray::removeRecords");
+    auto isRemoved = [&](const Index& idx) { return recordNumbers.count(idx.recordNumber) > 0; };
+    // std::remove_if сохраняет относительный порядок оставшихся элементов
+    for(std::vector<Index>* index : { &nameIndexAsc, &nameIndexDesc }) {
+        index->erase(std::remove_if(index->begin(), index->end(), isRemoved), index->end());
+    }
+    phoneIndex.erase(std::remove_if(phoneIndex.begin(), phoneIndex.end(),
+                                    [&](const PhoneIndex& idx) { return recordNumbers.count(idx.recordNumber) > 0; }),
+                     phoneIndex.end());
 
-    // Сортировка по городу по убыванию
-    std::sort(cityIndexDesc.begin(), cityIndexDesc.end(),
-              [](const Index& a, const Index& b) { return a.key > b.key; });
+    // Сжатие групп индексов по городу с пересчётом их границ
+    for(CityIndex* index : { &cityIndexAsc, &cityIndexDesc }) {
+        if(index->bucketStart.empty())
+            continue;
+        std::size_t kept = 0;
+        for(std::size_t b = 0; b + 1 < index->bucketStart.size(); ++b) {
+            std::size_t begin = index->bucketStart[b];
+            std::size_t end = index->bucketStart[b + 1];
+            index->bucketStart[b] = kept;
+            for(std::size_t i = begin; i < end; ++i) {
+                if(recordNumbers.count(index->recordNumbers[i]) == 0)
+                    index->recordNumbers[kept++] = index->recordNumbers[i];
+            }
+        }
+        index->bucketStart.back() = kept;
+        index->recordNumbers.resize(kept);
+    }
+}
+
+// Объём памяти индекс-массивов
+MemoryUsage IndexArray::memoryUsage() const {
+    MemoryUsage usage;
+    for(const std::vector<Index>* names : { &nameIndexAsc, &nameIndexDesc }) {
+        usage.elements += names->size();
+        usage.addVector(*names);
+        for(const Index& idx : *names)
+            usage.addString(idx.key);
+    }
+    for(const CityIndex* cities : { &cityIndexAsc, &cityIndexDesc }) {
+        usage.elements += cities->recordNumbers.size();
+        usage.addVector(cities->recordNumbers);
+        usage.addVector(cities->bucketStart);
+        usage.addVector(cities->bucketOfCode);
+    }
+    usage.elements += phoneIndex.size();
+    usage.addVector(phoneIndex);
+    return usage;
 }
 
 // Вывод всех контактов
-void printContacts(const std::vector<Contact>& contacts) {
-    std::cout << "\nСписок контактов:\n";
+void printContacts(const ContactStore& contacts, ReportWriter& report) {
+    report.heading("\nСписок контактов:\n");
     for(const auto& contact : contacts) {
-        std::cout << "ID: " << contact.id << "\n"
-                  << "Имя: " << contact.name << "\n"
-                  << "Номер телефона: " << contact.phoneNumber << "\n"
-                  << "Город: " << contact.city << "\n"
-                  << "-----------------------------\n";
+        if(!report.write(contact))
+            break;
     }
 }
 
 // Вывод отсортированных контактов по имени
-void printSortedByName(const std::vector<Contact>& contacts, const std::vector<Index>& nameIndex) {
+void printSortedByName(const ContactStore& contacts, const std::vector<Index>& nameIndex, ReportWriter& report) {
     for(const auto& idx : nameIndex) {
-        // Поиск контакта по ID
-        auto it = std::find_if(contacts.begin(), contacts.end(),
-                               [&](const Contact& c) { return c.id == idx.recordNumber; });
-        if(it != contacts.end()) {
-            std::cout << "ID: " << it->id << "\n"
-                      << "Имя: " << it->name << "\n"
-                      << "Номер телефона: " << it->phoneNumber << "\n"
-                      << "Город: " << it->city << "\n"
-                      << "-----------------------------\n";
-        }
-        else {
-            std::cerr << "Ошибка: Контакт с ID " << idx.recordNumber << " не найден.\n";
-        }
+        if(!report.write(contacts, idx.recordNumber))
+            break;
     }
 }
 
 // Вывод отсортированных контактов по городу
-void printSortedByCity(const std::vector<Contact>& contacts, const std::vector<Index>& cityIndex) {
-    for(const auto& idx : cityIndex) {
-        // Поиск контакта по ID
-        auto it = std::find_if(contacts.begin(), contacts.end(),
-                               [&](const Contact& c) { return c.id == idx.recordNumber; });
-        if(it != contacts.end()) {
-            std::cout << "ID: " << it->id << "\n"
-                      << "Имя: " << it->name << "\n"
-                      << "Номер телефона: " << it->phoneNumber << "\n"
-                      << "Город: " << it->city << "\n"
-                      << "-----------------------------\n";
-        }
-        else {
-            std::cerr << "Ошибка: Контакт с ID " << idx.recordNumber << " не найден.\n";
-        }
-    }
+void printSortedByCity(const ContactStore& contacts, const CityIndex& cityIndex, ReportWriter& report) {
+    report.write(contacts, cityIndex.recordNumbers);
 }
 
 // Итеративный бинарный поиск
 std::vector<int> binarySearchIterative(const std::vector<Index>& indexArray, const std::string& key) {
+    STATS_TIMED(StatOperation::SEARCH);
     std::vector<int> result;
     int left = 0;
     int right = indexArray.size() - 1;
@@ -167,6 +407,7 @@ std::vector<int> binarySearchIterative(const std::vector<Index>& indexArray, con
             for(int i = start; i <= end; ++i) {
                 result.push_back(indexArray[i].recordNumber);
             }
+            STATS_COUNT(StatCounter::FOUND, result.size());
             break;
         }
         else if(indexArray[mid].key < key) {
@@ -209,70 +450,113 @@ std::vector<int> binarySearchRecursive(const std::vector<Index>& indexArray, con
     return result;
 }
 
+// Номера записей индекса телефона из отрезка [low, high]
+static std::vector<int> searchPhoneRange(const std::vector<PhoneIndex>& phoneIndex, PackedPhone low, PackedPhone high) {
+    STATS_TIMED(StatOperation::SEARCH);
+    auto first = std::lower_bound(phoneIndex.begin(), phoneIndex.end(), low,
+                                  [](const PhoneIndex& idx, PackedPhone value) { return idx.phone < value; });
+    auto last = std::upper_bound(first, phoneIndex.end(), high,
+                                 [](PackedPhone value, const PhoneIndex& idx) { return value < idx.phone; });
+    std::vector<int> ids;
+    ids.reserve(last - first);
+    for(auto it = first; it != last; ++it)
+        ids.push_back(it->recordNumber);
+    STATS_COUNT(StatCounter::FOUND, ids.size());
+    return ids;
+}
+
+// Поиск по индексу города
+std::vector<int> searchCity(const CityIndex& cityIndex, std::uint32_t cityCode) {
+    STATS_TIMED(StatOperation::SEARCH);
+    if(cityCode >= cityIndex.bucketOfCode.size())
+        return {};
+    std::uint32_t bucket = cityIndex.bucketOfCode[cityCode];
+    STATS_COUNT(StatCounter::FOUND, cityIndex.bucketStart[bucket + 1] - cityIndex.bucketStart[bucket]);
+    return std::vector<int>(cityIndex.recordNumbers.begin() + cityIndex.bucketStart[bucket],
+                            cityIndex.recordNumbers.begin() + cityIndex.bucketStart[bucket + 1]);
+}
+
+// Поиск по номеру телефона
+std::vector<int> searchPhone(const std::vector<PhoneIndex>& phoneIndex, PackedPhone phone) {
+    return searchPhoneRange(phoneIndex, phone, phone);
+}
+
+// Поиск по префиксу номера телефона
+std::vector<int> searchPhonePrefix(const std::vector<PhoneIndex>& phoneIndex, const std::string& prefix) {
+    PackedPhone low, high;
+    if(!PackedPhone::prefixRange(prefix, low, high))
+        return {};
+    return searchPhoneRange(phoneIndex, low, high);
+}
+
 // Редактирование контакта
-void editContact(std::vector<Contact>& contacts, IndexArray& indices) {
+int editContact(ContactStore& contacts, IndexArray& indices) {
     std::string key;
     std::cout << "Введите имя контакта для редактирования: ";
     std::getline(std::cin, key);
 
-    bool found = false;
-    for(auto& contact : contacts) {
-        if(contact.name == key) {
-            found = true;
-            std::cout << "Введите новое имя контакта (оставьте пустым, чтобы оставить без изменений): ";
-            std::string newName;
-            std::getline(std::cin, newName);
-            if(!newName.empty())
-                contact.name = newName;
-
-            std::cout << "Введите новый номер телефона (оставьте пустым, чтобы оставить без изменений): ";
-            std::string newPhone;
-            std::getline(std::cin, newPhone);
-            if(!newPhone.empty()) {
-                if(validatePhoneNumber(newPhone))
-                    contact.phoneNumber = newPhone;
-                else
-                    std::cout << "Некорректный формат номера телефона. Оставлено прежнее значение.\n";
-            }
+    int editedId = -1;
+    // Поиск просматривает только столбец имён
+    std::size_t row = contacts.findName(key);
+    if(row != ContactStore::npos) { // Предполагается уникальность имени: редактируется первое совпадение
+        editedId = contacts.id(row);
+        std::cout << "Введите новое имя контакта (оставьте пустым, чтобы оставить без изменений): ";
+        std::string newName;
+        std::getline(std::cin, newName);
+        if(!newName.empty())
+            contacts.setName(row, newName);
+
+        std::cout << "Введите новый номер телефона (оставьте пустым, чтобы оставить без изменений): ";
+        std::string newPhone;
+        std::getline(std::cin, newPhone);
+        if(!newPhone.empty()) {
+            PackedPhone phone;
+            if(PackedPhone::parse(newPhone, phone))
+                contacts.setPhoneNumber(row, phone);
+            else
+                std::cout << "Некорректный формат номера телефона. Оставлено прежнее значение.\n";
+        }
 
-            std::cout << "Введите новый город (оставьте пустым, чтобы оставить без изменений): ";
-            std::string newCity;
-            std::getline(std::cin, newCity);
-            if(!newCity.empty())
-                contact.city = newCity;
+        std::cout << "Введите новый город (оставьте пустым, чтобы оставить без изменений): ";
+        std::string newCity;
+        std::getline(std::cin, newCity);
+        if(!newCity.empty())
+            contacts.setCity(row, newCity);
 
-            // Перестроение индекс-массивов
-            indices.buildIndices(contacts);
-            indices.sortIndices();
+        // Перестроение индекс-массивов
+        indices.buildIndices(contacts);
+        indices.sortIndices();
 
-            std::cout << "Контакт успешно обновлен.\n";
-            break; // Предполагается уникальность имени. Если нет, удалите этот break.
-        }
+        std::cout << "Контакт успешно обновлен.\n";
     }
-    if(!found) {
+    if(editedId == -1) {
         std::cout << "Контакт с именем \"" << key << "\" не найден.\n";
     }
+    return editedId;
 }
 
 // Удаление контакта
-void deleteContact(std::vector<Contact>& contacts, IndexArray& indices) {
+std::vector<int> deleteContact(ContactStore& contacts, IndexArray& indices) {
     std::string key;
     std::cout << "Введите имя контакта для удаления: ";
     std::getline(std::cin, key);
 
-    auto it = std::remove_if(contacts.begin(), contacts.end(),
-                             [&](const Contact& c) { return c.name == key; });
+    std::vector<int> removedIds;
+    {
+        STATS_TIMED(StatOperation::REMOVE);
+        removedIds = contacts.removeIf([&](const ContactView& c) { return c.name == key; });
+        // Удаление записей из индекс-массивов без пересортировки
+        if(!removedIds.empty())
+            indices.removeRecords(std::unordered_set<int>(removedIds.begin(), removedIds.end()));
+    }
 
-    if(it != contacts.end()) {
-        contacts.erase(it, contacts.end());
-        // Перестроение индекс-массивов
-        indices.buildIndices(contacts);
-        indices.sortIndices();
+    if(!removedIds.empty()) {
         std::cout << "Контакт успешно удален.\n";
     }
     else {
         std::cout << "Контакт с именем \"" << key << "\" не найден.\n";
     }
+    return removedIds;
 }
 
 // Проверка на пустое имя
@@ -287,60 +571,121 @@ bool validateCity(const std::string& city) {
 
 // Проверка формата номера телефона
 bool validatePhoneNumber(const std::string& phoneNumber) {
-    if(phoneNumber.length() < 7 || phoneNumber.length() > 15)
-        return false;
-    for(char c : phoneNumber) {
-        if(!std::isdigit(c))
-            return false;
-    }
-    return true;
+    return validatePhoneDigits(phoneNumber);
 }
 
 // Сохранение контактов в файл
-void saveContactsToFile(const std::vector<Contact>& contacts, const std::string& filename) {
-    std::ofstream outFile(filename);
-    if(!outFile) {
-        std::cerr << "Не удалось открыть файл для записи: " << filename << "\n";
+void saveContactsToFile(const ContactStore& contacts, const std::string& filename) {
+    // Запись во временный файл крупными блоками с заменой целевого в конце
+    STATS_TIMED(StatOperation::FILE_WRITE);
+    TRACE_SPAN("saveContactsToFile");
+    CsvWriter writer;
+    if(!writer.open(filename))
         return;
-    }
-    for(const auto& contact : contacts) {
-        outFile << contact.id << "," << contact.name << "," << contact.phoneNumber << "," << contact.city << "\n";
-    }
-    outFile.close();
+    for(const auto& contact : contacts)
+        writer.writeContact(contact);
+    if(!writer.commit())
+        return;
+    STATS_COUNT(StatCounter::ROWS_WRITTEN, contacts.size());
     std::cout << "Контакты успешно сохранены в файл " << filename << "\n";
 }
 
 // Загрузка контактов из файла
-void loadContactsFromFile(std::vector<Contact>& contacts, const std::string& filename) {
-    std::ifstream inFile(filename);
-    if(!inFile) {
+std::size_t loadContactsFromFile(ContactStore& contacts, const std::string& filename) {
+    // Файл отображается в память и разбирается без построчного копирования
+    STATS_TIMED(StatOperation::FILE_READ);
+    TRACE_SPAN("loadContactsFromFile");
+    MappedFile file;
+    if(!file.open(filename)) {
         std::cerr << "Не удалось открыть файл для чтения: " << filename << "\n";
-        return;
+        return 0;
     }
     contacts.clear();
-    std::string line;
-    while(std::getline(inFile, line)) {
-        Contact contact;
-        size_t pos1 = line.find(',');
-        size_t pos2 = line.find(',', pos1 + 1);
-        size_t pos3 = line.find(',', pos2 + 1);
+    std::size_t rejected = 0;
+    parseContactsCsv(file.view(),
+        [&](const CsvRecord& record) {
+            PackedPhone phone;
+            if(!PackedPhone::parse(record.phoneNumber, phone)) {
+                std::cerr << "Некорректный номер телефона в строке: " << record.line << "\n";
+                ++rejected;
+                return;
+            }
 
-        if(pos1 == std::string::npos || pos2 == std::string::npos || pos3 == std::string::npos) {
-            std::cerr << "Некорректный формат строки: " << line << "\n";
-            continue;
-        }
+            // Обновление глобального счётчика, если необходимо
+            if(record.id >= global_id_counter)
+                global_id_counter = record.id + 1;
 
-        contact.id = std::stoi(line.substr(0, pos1));
-        contact.name = line.substr(pos1 + 1, pos2 - pos1 - 1);
-        contact.phoneNumber = line.substr(pos2 + 1, pos3 - pos2 - 1);
-        contact.city = line.substr(pos3 + 1);
+            contacts.push_back(record.id, record.name, phone, record.city);
+        },
+        [&](std::string_view line) {
+            std::cerr << "Некорректный формат строки: " << line << "\n";
+            ++rejected;
+        });
+    STATS_COUNT(StatCounter::ROWS_READ, contacts.size());
+    reportLoaded(filename, rejected);
+    return rejected;
+}
 
-        // Обновление глобального счётчика, если необходимо
-        if(contact.id >= global_id_counter)
-            global_id_counter = contact.id + 1;
+// Параллельная загрузка контактов из файла
+std::size_t loadContactsFromFileParallel(ContactStore& contacts, const std::string& filename, ThreadPool& pool) {
+    STATS_TIMED(StatOperation::FILE_READ);
+    TRACE_SPAN("loadContactsFromFileParallel");
+    MappedFile file;
+    if(!file.open(filename)) {
+        std::cerr << "Не удалось открыть файл для чтения: " << filename << "\n";
+        return 0;
+    }
+    std::string_view text = file.view();
+
+    // Границы частей сдвигаются к началу следующей строки
+    std::size_t parts = text.size() < (1 << 16) ? 1 : pool.size() * 4;
+    std::vector<std::size_t> bounds(parts + 1, text.size());
+    bounds[0] = 0;
+    for(std::size_t i = 1; i < parts; ++i) {
+        std::size_t pos = std::max(bounds[i - 1], text.size() / parts * i);
+        std::size_t newline = text.find('\n', pos);
+        bounds[i] = newline == std::string_view::npos ? text.size() : newline + 1;
+    }
 
-        contacts.push_back(contact);
+    // Пакет каждой части: контакты, наибольший ID, сообщения об ошибках и число пропущенных строк
+    std::vector<ContactStore> batches(parts);
+    std::vector<int> maxIds(parts, 0);
+    std::vector<std::string> errors(parts);
+    std::vector<std::size_t> rejected(parts, 0);
+    pool.parallelFor(parts, [&](std::size_t part) {
+        TRACE_SPAN("parse part");
+        ContactStore& batch = batches[part];
+        std::string& log = errors[part];
+        parseContactsCsv(text.substr(bounds[part], bounds[part + 1] - bounds[part]),
+            [&](const CsvRecord& record) {
+                PackedPhone phone;
+                if(!PackedPhone::parse(record.phoneNumber, phone)) {
+                    log.append("Некорректный номер телефона в строке: ").append(record.line).append("\n");
+                    ++rejected[part];
+                    return;
+                }
+                maxIds[part] = std::max(maxIds[part], record.id);
+                batch.push_back(record.id, record.name, phone, record.city);
+            },
+            [&](std::string_view line) {
+                log.append("Некорректный формат строки: ").append(line).append("\n");
+                ++rejected[part];
+            });
+    });
+
+    // Объединение в порядке файла
+    {
+        TRACE_SPAN("merge parts");
+        contacts.clear();
+        for(std::size_t part = 0; part < parts; ++part) {
+            std::cerr << errors[part];
+            contacts.appendBatch(batches[part]);
+            if(!batches[part].empty() && maxIds[part] >= global_id_counter)
+                global_id_counter = maxIds[part] + 1;
+        }
     }
-    inFile.close();
-    std::cout << "Контакты успешно загружены из файла " << filename << "\n";
+    STATS_COUNT(StatCounter::ROWS_READ, contacts.size());
+    std::size_t skipped = std::accumulate(rejected.begin(), rejected.end(), std::size_t(0));
+    reportLoaded(filename, skipped);
+    return skipped;
 }
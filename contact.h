@@ -3,8 +3,13 @@
 #ifndef CONTACT_H
 #define CONTACT_H
 
+#include "contact_store.h"
+#include "thread_pool.h"
+#include "report_writer.h"
 #include <string>
 #include <vector>
+#include <unordered_set>
+#include <functional>
 
 // Глобальный счётчик для уникальных ID
 extern int global_id_counter;
@@ -12,6 +17,7 @@ extern int global_id_counter;
 /**
  * @struct Contact
  * @brief Структура для хранения информации о контакте.
+ * Используется для ввода и разбора файлов; сами контакты хранятся в ContactStore.
  */
 struct Contact {
     int id;                         ///< Уникальный ID контакта
@@ -29,6 +35,28 @@ struct Index {
     int recordNumber;     ///< Номер записи в основном массиве
 };
 
+/**
+ * @struct CityIndex
+ * @brief Индекс по городу, построенный сортировкой подсчётом по кодам словаря.
+ *
+ * Записи сгруппированы по городам; группа города находится по его коду
+ * без сравнения строк.
+ */
+struct CityIndex {
+    std::vector<int> recordNumbers;             ///< Номера записей, сгруппированные по городу
+    std::vector<std::size_t> bucketStart;       ///< Начало каждой группы (последний элемент - конец)
+    std::vector<std::uint32_t> bucketOfCode;    ///< Номер группы для каждого кода города
+};
+
+/**
+ * @struct PhoneIndex
+ * @brief Элемент индекса по номеру телефона.
+ */
+struct PhoneIndex {
+    PackedPhone phone;    ///< Упакованный номер телефона
+    int recordNumber;     ///< Номер записи в основном массиве
+};
+
 /**
  * @struct IndexArray
  * @brief Структура для хранения индекс-массивов.
@@ -36,48 +64,94 @@ struct Index {
 struct IndexArray {
     std::vector<Index> nameIndexAsc;       ///< Индекс по имени по возрастанию
     std::vector<Index> nameIndexDesc;      ///< Индекс по имени по убыванию
-    std::vector<Index> cityIndexAsc;       ///< Индекс по городу по возрастанию
-    std::vector<Index> cityIndexDesc;      ///< Индекс по городу по убыванию
+    CityIndex cityIndexAsc;                ///< Индекс по городу по возрастанию
+    CityIndex cityIndexDesc;               ///< Индекс по городу по убыванию
+    std::vector<PhoneIndex> phoneIndex;    ///< Индекс по номеру телефона по возрастанию
 
     /**
      * @brief Создаёт индексы на основе контактов.
-     * @param contacts Вектор контактов.
+     * Индексы по городу сразу строятся упорядоченными сортировкой подсчётом за O(n).
+     * @param contacts Хранилище контактов.
+     */
+    void buildIndices(const ContactStore& contacts);
+
+    /**
+     * @brief Создаёт индексы на основе контактов на пуле потоков.
+     * Результат совпадает с последовательным buildIndices. Хранилище не
+     * должно изменяться, а cityRanks() - впервые вычисляться одновременно
+     * с построением.
+     * @param contacts Хранилище контактов.
+     * @param pool Пул потоков.
      */
-    void buildIndices(const std::vector<Contact>& contacts);
+    void buildIndices(const ContactStore& contacts, ThreadPool& pool);
 
     /**
-     * @brief Сортирует индекс-массивы.
+     * @brief Сортирует индекс-массивы по имени и по номеру телефона.
+     * Равные ключи упорядочены по номеру записи.
      */
     void sortIndices();
+
+    /**
+     * @brief Сортирует индекс-массивы одновременно на пуле потоков, каждый - по частям
+     * с попарными слияниями. Результат совпадает с последовательным sortIndices.
+     * @param pool Пул потоков.
+     * @param nameAscSorted Вызывается задачей пула, как только отсортирован nameIndexAsc,
+     * пока остальные массивы ещё сортируются; может читать только nameIndexAsc.
+     */
+    void sortIndices(ThreadPool& pool, const std::function<void()>& nameAscSorted = nullptr);
+
+    /**
+     * @brief Удаляет из всех индекс-массивов записи с заданными номерами.
+     * Один проход по каждому массиву; порядок сортировки сохраняется,
+     * поэтому повторная сортировка не требуется.
+     * @param recordNumbers Номера удаляемых записей.
+     */
+    void removeRecords(const std::unordered_set<int>& recordNumbers);
+
+    /**
+     * @brief Возвращает объём памяти всех индекс-массивов, включая ключи-строки.
+     * @return Объём памяти; элементы - записи всех индексов.
+     */
+    MemoryUsage memoryUsage() const;
+
+private:
+    /**
+     * @brief Строит индексы по городу сортировкой подсчётом за O(n).
+     * @param contacts Хранилище контактов.
+     */
+    void buildCityIndices(const ContactStore& contacts);
 };
 
 // Объявления функций
 
 /**
  * @brief Вводит данные контактов с валидацией.
- * @param contacts Вектор для хранения контактов.
+ * @param contacts Хранилище контактов.
  */
-void inputContacts(std::vector<Contact>& contacts);
+void inputContacts(ContactStore& contacts);
 
 /**
  * @brief Выводит все контакты.
- * @param contacts Вектор контактов.
+ * @param contacts Хранилище контактов.
+ * @param report Вывод с форматом и страницей.
  */
-void printContacts(const std::vector<Contact>& contacts);
+void printContacts(const ContactStore& contacts, ReportWriter& report);
 
 /**
  * @brief Выводит контакты, отсортированные по имени.
- * @param contacts Вектор контактов.
+ * @param contacts Хранилище контактов.
  * @param nameIndex Отсортированный индекс по имени.
+ * @param report Вывод с форматом и страницей.
  */
-void printSortedByName(const std::vector<Contact>& contacts, const std::vector<Index>& nameIndex);
+void printSortedByName(const ContactStore& contacts, const std::vector<Index>& nameIndex, ReportWriter& report);
 
 /**
  * @brief Выводит контакты, отсортированные по городу.
- * @param contacts Вектор контактов.
- * @param cityIndex Отсортированный индекс по городу.
+ * @param contacts Хранилище контактов.
+ * @param cityIndex Индекс по городу.
+ * @param report Вывод с форматом и страницей.
  */
-void printSortedByCity(const std::vector<Contact>& contacts, const std::vector<Index>& cityIndex);
+void printSortedByCity(const ContactStore& contacts, const CityIndex& cityIndex, ReportWriter& report);
 
 /**
  * @brief Итеративный бинарный поиск по индекс-массиву.
@@ -97,19 +171,47 @@ std::vector<int> binarySearchIterative(const std::vector<Index>& indexArray, con
  */
 std::vector<int> binarySearchRecursive(const std::vector<Index>& indexArray, const std::string& key, int left, int right);
 
+/**
+ * @brief Поиск по индексу города: прямое обращение к группе по коду города.
+ * @param cityIndex Индекс по городу.
+ * @param cityCode Код города (ContactStore::findCity).
+ * @return Вектор ID найденных контактов.
+ */
+std::vector<int> searchCity(const CityIndex& cityIndex, std::uint32_t cityCode);
+
+/**
+ * @brief Поиск по индексу телефона: бинарный поиск целого значения номера.
+ * @param phoneIndex Индекс по номеру телефона.
+ * @param phone Упакованный номер телефона.
+ * @return Вектор ID найденных контактов.
+ */
+std::vector<int> searchPhone(const std::vector<PhoneIndex>& phoneIndex, PackedPhone phone);
+
+/**
+ * @brief Поиск по индексу телефона всех номеров, начинающихся с префикса.
+ * Номера с префиксом образуют непрерывный отрезок индекса, который
+ * находится двумя бинарными поисками.
+ * @param phoneIndex Индекс по номеру телефона.
+ * @param prefix Начальные цифры номера (0-15 цифр).
+ * @return Вектор ID найденных контактов в порядке номеров телефонов.
+ */
+std::vector<int> searchPhonePrefix(const std::vector<PhoneIndex>& phoneIndex, const std::string& prefix);
+
 /**
  * @brief Редактирует контакт по имени.
- * @param contacts Вектор контактов.
+ * @param contacts Хранилище контактов.
  * @param indices Структура индекс-массивов.
+ * @return ID отредактированного контакта или -1, если контакт не найден.
  */
-void editContact(std::vector<Contact>& contacts, IndexArray& indices);
+int editContact(ContactStore& contacts, IndexArray& indices);
 
 /**
  * @brief Удаляет контакт по имени.
- * @param contacts Вектор контактов.
+ * @param contacts Хранилище контактов.
  * @param indices Структура индекс-массивов.
+ * @return Вектор ID удалённых контактов.
  */
-void deleteContact(std::vector<Contact>& contacts, IndexArray& indices);
+std::vector<int> deleteContact(ContactStore& contacts, IndexArray& indices);
 
 /**
  * @brief Проверяет, не пустое ли имя.
@@ -134,16 +236,33 @@ bool validatePhoneNumber(const std::string& phoneNumber);
 
 /**
  * @brief Сохраняет контакты в файл.
- * @param contacts Вектор контактов.
+ * @param contacts Хранилище контактов.
  * @param filename Имя файла для сохранения.
  */
-void saveContactsToFile(const std::vector<Contact>& contacts, const std::string& filename);
+void saveContactsToFile(const ContactStore& contacts, const std::string& filename);
 
 /**
  * @brief Загружает контакты из файла.
- * @param contacts Вектор контактов для загрузки.
+ * Строки с ошибками формата или номера телефона пропускаются с сообщением;
+ * перезапись такого файла удалила бы их, поэтому вызывающий код сохраняет
+ * контакты в него, только если пропущенных строк нет.
+ * @param contacts Хранилище контактов для загрузки.
+ * @param filename Имя файла для загрузки.
+ * @return Количество пропущенных строк.
+ */
+std::size_t loadContactsFromFile(ContactStore& contacts, const std::string& filename);
+
+/**
+ * @brief Загружает контакты из файла параллельно.
+ * Файл делится на части по границам строк, каждая часть разбирается
+ * отдельной задачей пула в собственное хранилище-пакет, затем пакеты
+ * добавляются в порядке следования в файле. Результат и сообщения об
+ * ошибках совпадают с loadContactsFromFile.
+ * @param contacts Хранилище контактов для загрузки.
  * @param filename Имя файла для загрузки.
+ * @param pool Пул потоков для разбора.
+ * @return Количество пропущенных строк.
  */
-void loadContactsFromFile(std::vector<Contact>& contacts, const std::string& filename);
+std::size_t loadContactsFromFileParallel(ContactStore& contacts, const std::string& filename, ThreadPool& pool);
 
 #endif // CONTACT_H
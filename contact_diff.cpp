@@ -0,0 +1,93 @@
+// contact_diff.cpp
+
+#include "contact_diff.h"
+#include "contact.h"
+#include "trace.h"
+#include <unordered_set>
+
+namespace {
+    // Поля контакта через запятую
+    void printFields(std::ostream& out, const ContactView& contact) {
+        out << contact.name << "," << contact.phoneNumber << "," << contact.city;
+    }
+}
+
+// Сравнение хранилищ
+ContactDiff diffContacts(const ContactStore& base, const ContactStore& other) {
+    TRACE_SPAN("diffContacts");
+    ContactDiff diff;
+    std::size_t row = 0, otherRow = 0;
+    while(row < base.size() && otherRow < other.size()) {
+        int id = base.id(row);
+        int otherId = other.id(otherRow);
+        if(id < otherId) {
+            diff.removed.push_back(row++);
+        }
+        else if(otherId < id) {
+            diff.added.push_back(otherRow++);
+        }
+        else {
+            if(base.phoneNumber(row) != other.phoneNumber(otherRow) || base.name(row) != other.name(otherRow) ||
+               base.city(row) != other.city(otherRow))
+                diff.changed.emplace_back(row, otherRow);
+            ++row;
+            ++otherRow;
+        }
+    }
+    for(; row < base.size(); ++row)
+        diff.removed.push_back(row);
+    for(; otherRow < other.size(); ++otherRow)
+        diff.added.push_back(otherRow);
+    return diff;
+}
+
+// Вывод различий
+void printContactDiff(std::ostream& out, const ContactStore& base, const ContactStore& other, const ContactDiff& diff) {
+    for(std::size_t row : diff.added) {
+        ContactView contact = other[row];
+        out << "+ " << contact.id << ",";
+        printFields(out, contact);
+        out << "\n";
+    }
+    for(std::size_t row : diff.removed) {
+        ContactView contact = base[row];
+        out << "- " << contact.id << ",";
+        printFields(out, contact);
+        out << "\n";
+    }
+    for(const auto& change : diff.changed) {
+        out << "~ " << base.id(change.first) << ": ";
+        printFields(out, base[change.first]);
+        out << " -> ";
+        printFields(out, other[change.second]);
+        out << "\n";
+    }
+}
+
+// Применение различий
+void applyContactDiff(ContactStore& base, const ContactStore& other, const ContactDiff& diff) {
+    TRACE_SPAN("applyContactDiff");
+    // Изменения - до удаления, пока номера строк base действительны
+    for(const auto& change : diff.changed) {
+        ContactView contact = other[change.second];
+        base.setName(change.first, contact.name);
+        base.setPhoneNumber(change.first, contact.phoneNumber);
+        base.setCity(change.first, contact.city);
+    }
+    if(!diff.removed.empty()) {
+        std::unordered_set<int> removedIds;
+        for(std::size_t row : diff.removed)
+            removedIds.insert(base.id(row));
+        base.removeIf([&](const ContactView& c) { return removedIds.count(c.id) > 0; });
+    }
+    if(!diff.added.empty()) {
+        ContactStore batch;
+        for(std::size_t row : diff.added) {
+            ContactView contact = other[row];
+            batch.push_back(contact.id, contact.name, contact.phoneNumber, contact.city);
+            if(contact.id >= global_id_counter)
+                global_id_counter = contact.id + 1;
+        }
+        base.appendBatch(batch);
+    }
+}
@@ -0,0 +1,63 @@
+// contact_diff.h
+
+#ifndef CONTACT_DIFF_H
+#define CONTACT_DIFF_H
+
+#include "contact_store.h"
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <ostream>
+
+/**
+ * @struct ContactDiff
+ * @brief Различия двух хранилищ контактов, сопоставленных по ID.
+ *
+ * Все списки упорядочены по ID.
+ */
+struct ContactDiff {
+    std::vector<std::size_t> added;     ///< Строки второго хранилища, ID которых нет в первом
+    std::vector<std::size_t> removed;   ///< Строки первого хранилища, ID которых нет во втором
+    std::vector<std::pair<std::size_t, std::size_t>> changed; ///< Строки (в первом, во втором) с одинаковым ID и разными полями
+
+    /**
+     * @brief Проверяет, совпадают ли хранилища.
+     * @return true, если различий нет.
+     */
+    bool empty() const { return added.empty() && removed.empty() && changed.empty(); }
+};
+
+/**
+ * @brief Сравнивает два хранилища одним линейным проходом слияния по ID.
+ * Хранилища упорядочены по ID, поэтому сортировка не нужна. Города
+ * сравниваются по названиям, так как словари хранилищ независимы.
+ * @param base Исходное хранилище.
+ * @param other Хранилище, с которым сравнивается исходное.
+ * @return Различия: добавленные, удалённые и изменённые контакты.
+ */
+ContactDiff diffContacts(const ContactStore& base, const ContactStore& other);
+
+/**
+ * @brief Выводит различия построчно.
+ * Формат: "+ id,имя,телефон,город" для добавленных, "- ..." для удалённых,
+ * "~ id: старые поля -> новые поля" для изменённых.
+ * @param out Поток вывода.
+ * @param base Исходное хранилище.
+ * @param other Хранилище, с которым сравнивалось исходное.
+ * @param diff Различия, найденные diffContacts.
+ */
+void printContactDiff(std::ostream& out, const ContactStore& base, const ContactStore& other, const ContactDiff& diff);
+
+/**
+ * @brief Применяет различия к исходному хранилищу пакетом.
+ * Изменённые поля переписываются на месте, удалённые контакты убираются
+ * одним проходом removeIf, добавленные вливаются одним appendBatch.
+ * После применения base совпадает с other; global_id_counter становится
+ * больше наибольшего добавленного ID.
+ * @param base Исходное хранилище (изменяется).
+ * @param other Хранилище, с которым сравнивалось исходное.
+ * @param diff Различия, найденные diffContacts для этих хранилищ.
+ */
+void applyContactDiff(ContactStore& base, const ContactStore& other, const ContactDiff& diff);
+
+#endif // CONTACT_DIFF_H
@@ -0,0 +1,291 @@
+// contact_store.cpp
+
+#include "contact_store.h"
+#include "contact.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstring>
+
+// Конструктор
+ContactStore::ContactStore() : garbageBytes(0), cityRanksValid(true) {}
+
+// Добавление строки в арену
+StringSpan ContactStore::append(std::string& arena, std::string_view value) {
+    // Строка может ссылаться на саму арену, которую append перераспределит
+    if(!arena.empty() && value.data() >= arena.data() && value.data() < arena.data() + arena.size()) {
+        std::string copy(value);
+        return append(arena, copy);
+    }
+    StringSpan span{ arena.size(), static_cast<std::uint32_t>(value.size()) };
+    arena.append(value.data(), value.size());
+    return span;
+}
+
+// Кодирование города
+std::uint32_t ContactStore::internCity(std::string_view city) {
+    // Поиск по представлению строки: повторяющиеся города не выделяют память
+    auto it = cityLookup.find(city);
+    if(it != cityLookup.end())
+        return it->second;
+    std::uint32_t code = static_cast<std::uint32_t>(cityNames.size());
+    cityNames.emplace_back(city);
+    cityLookup.emplace(cityNames.back(), code);
+    cityRanksValid = false;
+    return code;
+}
+
+// Поиск кода города
+std::uint32_t ContactStore::findCity(std::string_view city) const {
+    auto it = cityLookup.find(city);
+    return it != cityLookup.end() ? it->second : noCity;
+}
+
+// Ранги городов в отсортированном словаре
+const std::vector<std::uint32_t>& ContactStore::cityRanks() const {
+    if(!cityRanksValid) {
+        std::vector<std::uint32_t> order(cityNames.size());
+        for(std::uint32_t code = 0; code < order.size(); ++code)
+            order[code] = code;
+        std::sort(order.begin(), order.end(),
+                  [this](std::uint32_t a, std::uint32_t b) { return cityName(a) < cityName(b); });
+        cityRankCache.assign(order.size(), 0);
+        for(std::uint32_t rank = 0; rank < order.size(); ++rank)
+            cityRankCache[order[rank]] = rank;
+        cityRanksValid = true;
+    }
+    return cityRankCache;
+}
+
+// Резервирование памяти
+void ContactStore::reserve(std::size_t rows) {
+    ids.reserve(rows);
+    names.reserve(rows);
+    phones.reserve(rows);
+    cityCodes.reserve(rows);
+}
+
+// Объём памяти хранилища
+MemoryUsage ContactStore::memoryUsage() const {
+    MemoryUsage usage;
+    usage.elements = size();
+    usage.addVector(ids);
+    usage.addVector(names);
+    usage.addVector(phones);
+    usage.addVector(cityCodes);
+    // Устаревшие строки арены - накладные расходы
+    usage.addString(nameArena);
+    usage.usedBytes -= garbageBytes;
+    usage.addDeque(cityNames);
+    for(const std::string& city : cityNames)
+        usage.addString(city);
+    usage.addHashTable(cityLookup, true);
+    usage.addVector(cityRankCache);
+    return usage;
+}
+
+// Очистка хранилища
+void ContactStore::clear() {
+    ids.clear();
+    names.clear();
+    phones.clear();
+    cityCodes.clear();
+    nameArena.clear();
+    garbageBytes = 0;
+    cityLookup.clear();
+    cityNames.clear();
+    cityRankCache.clear();
+    cityRanksValid = true;
+}
+
+// Добавление контакта
+void ContactStore::push_back(const Contact& contact) {
+    PackedPhone phone;
+    PackedPhone::parse(contact.phoneNumber, phone);
+    push_back(contact.id, contact.name, phone, contact.city);
+}
+
+// Добавление контакта из представлений строк
+void ContactStore::push_back(int id, std::string_view name, PackedPhone phone, std::string_view city) {
+    StringSpan nameSpan = append(nameArena, name);
+    std::uint32_t code = internCity(city);
+
+    // Быстрый путь: ID больше последнего
+    if(ids.empty() || id > ids.back()) {
+        ids.push_back(id);
+        names.push_back(nameSpan);
+        phones.push_back(phone);
+        cityCodes.push_back(code);
+        return;
+    }
+
+    // Вставка в позицию с сохранением порядка по ID
+    std::size_t row = std::lower_bound(ids.begin(), ids.end(), id) - ids.begin();
+    ids.insert(ids.begin() + row, id);
+    names.insert(names.begin() + row, nameSpan);
+    phones.insert(phones.begin() + row, phone);
+    cityCodes.insert(cityCodes.begin() + row, code);
+}
+
+// Добавление пакета контактов
+void ContactStore::appendBatch(const ContactStore& batch) {
+    if(batch.empty())
+        return;
+
+    // Перевод кодов словаря пакета в коды этого словаря
+    std::vector<std::uint32_t> codeMap(batch.cityNames.size());
+    for(std::uint32_t code = 0; code < codeMap.size(); ++code)
+        codeMap[code] = internCity(batch.cityNames[code]);
+
+    std::uint64_t shift = nameArena.size();
+    nameArena.append(batch.nameArena);
+    garbageBytes += batch.garbageBytes;
+    auto batchName = [&](std::size_t row) {
+        return StringSpan{ batch.names[row].offset + shift, batch.names[row].length };
+    };
+
+    if(ids.empty() || batch.ids.front() > ids.back()) {
+        // Пакет целиком после последнего ID: дописывание столбцов
+        ids.insert(ids.end(), batch.ids.begin(), batch.ids.end());
+        phones.insert(phones.end(), batch.phones.begin(), batch.phones.end());
+        names.reserve(names.size() + batch.size());
+        cityCodes.reserve(cityCodes.size() + batch.size());
+        for(std::size_t row = 0; row < batch.size(); ++row) {
+            names.push_back(batchName(row));
+            cityCodes.push_back(codeMap[batch.cityCodes[row]]);
+        }
+        return;
+    }
+
+    // Диапазоны ID пересекаются: слияние столбцов одним линейным проходом.
+    // Контакт пакета встаёт перед контактом с тем же ID, как при push_back
+    std::size_t total = ids.size() + batch.size();
+    std::vector<int> mergedIds;
+    std::vector<StringSpan> mergedNames;
+    std::vector<PackedPhone> mergedPhones;
+    std::vector<std::uint32_t> mergedCodes;
+    mergedIds.reserve(total);
+    mergedNames.reserve(total);
+    mergedPhones.reserve(total);
+    mergedCodes.reserve(total);
+    std::size_t row = 0, batchRow = 0;
+    while(row < ids.size() || batchRow < batch.size()) {
+        if(batchRow < batch.size() && (row == ids.size() || batch.ids[batchRow] <= ids[row])) {
+            mergedIds.push_back(batch.ids[batchRow]);
+            mergedNames.push_back(batchName(batchRow));
+            mergedPhones.push_back(batch.phones[batchRow]);
+            mergedCodes.push_back(codeMap[batch.cityCodes[batchRow]]);
+            ++batchRow;
+        }
+        else {
+            mergedIds.push_back(ids[row]);
+            mergedNames.push_back(names[row]);
+            mergedPhones.push_back(phones[row]);
+            mergedCodes.push_back(cityCodes[row]);
+            ++row;
+        }
+    }
+    ids.swap(mergedIds);
+    names.swap(mergedNames);
+    phones.swap(mergedPhones);
+    cityCodes.swap(mergedCodes);
+}
+
+// Копия контакта
+Contact ContactStore::at(std::size_t row) const {
+    return Contact{ ids[row], std::string(name(row)), phones[row].str(), std::string(city(row)) };
+}
+
+// Поиск строки по ID
+std::size_t ContactStore::rowOf(int id) const {
+    // Быстрый путь: ID без пропусков совпадает с номером строки + 1
+    if(id >= 1 && static_cast<std::size_t>(id) <= ids.size() && ids[id - 1] == id)
+        return static_cast<std::size_t>(id - 1);
+
+    auto it = std::lower_bound(ids.begin(), ids.end(), id);
+    if(it != ids.end() && *it == id)
+        return static_cast<std::size_t>(it - ids.begin());
+    return npos;
+}
+
+// Поиск по столбцу имён
+std::size_t ContactStore::findName(std::string_view name, std::size_t from) const {
+    const char* arena = nameArena.data();
+    for(std::size_t row = from; row < names.size(); ++row) {
+        // Сначала сравниваются длины, символы - только при совпадении
+        if(names[row].length == name.size() &&
+           std::memcmp(arena + names[row].offset, name.data(), name.size()) == 0)
+            return row;
+    }
+    return npos;
+}
+
+// Поиск по столбцу телефонов
+std::size_t ContactStore::findPhone(PackedPhone phone, std::size_t from) const {
+    for(std::size_t row = from; row < phones.size(); ++row) {
+        if(phones[row] == phone)
+            return row;
+    }
+    return npos;
+}
+
+// Изменение имени
+void ContactStore::setName(std::size_t row, std::string_view value) {
+    garbageBytes += names[row].length;
+    names[row] = append(nameArena, value);
+    compactIfNeeded();
+}
+
+// Изменение города
+void ContactStore::setCity(std::size_t row, std::string_view value) {
+    cityCodes[row] = internCity(value);
+}
+
+// Пакетное удаление по предикату
+std::vector<int> ContactStore::removeIf(const std::function<bool(const ContactView&)>& predicate) {
+    TRACE_SPAN("ContactStore::removeIf");
+    std::vector<int> removedIds;
+    std::size_t kept = 0;
+    for(std::size_t row = 0; row < ids.size(); ++row) {
+        if(predicate((*this)[row])) {
+            removedIds.push_back(ids[row]);
+            garbageBytes += names[row].length;
+            continue;
+        }
+        // Сдвиг оставшихся строк во всех столбцах за один проход
+        if(kept != row) {
+            ids[kept] = ids[row];
+            names[kept] = names[row];
+            phones[kept] = phones[row];
+            cityCodes[kept] = cityCodes[row];
+        }
+        ++kept;
+    }
+    ids.resize(kept);
+    names.resize(kept);
+    phones.resize(kept);
+    cityCodes.resize(kept);
+    compactIfNeeded();
+    return removedIds;
+}
+
+// Сжатие арены при необходимости
+void ContactStore::compactIfNeeded() {
+    if(garbageBytes > 4096 && garbageBytes * 2 > nameArena.size())
+        compact();
+}
+
+// Сжатие арены имён
+void ContactStore::compact() {
+    std::string packed;
+    std::size_t total = 0;
+    for(const StringSpan& span : names)
+        total += span.length;
+    packed.reserve(total);
+    for(StringSpan& span : names) {
+        std::uint64_t offset = packed.size();
+        packed.append(nameArena, span.offset, span.length);
+        span.offset = offset;
+    }
+    nameArena.swap(packed);
+    garbageBytes = 0;
+}
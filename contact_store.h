@@ -0,0 +1,349 @@
+// contact_store.h
+
+#ifndef CONTACT_STORE_H
+#define CONTACT_STORE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <unordered_map>
+#include <deque>
+#include "phone_number.h"
+#include "memory_usage.h"
+
+struct Contact;
+struct IndexArray;
+
+/**
+ * @struct ContactView
+ * @brief Представление контакта из колоночного хранилища.
+ *
+ * Поля совпадают по именам с полями Contact, но строки не копируются:
+ * они ссылаются на арены хранилища и действительны до следующего изменения
+ * хранилища.
+ */
+struct ContactView {
+    int id;                         ///< Уникальный ID контакта
+    std::string_view name;          ///< Имя контакта
+    PackedPhone phoneNumber;        ///< Упакованный номер телефона
+    std::string_view city;          ///< Город
+    std::uint32_t cityCode;         ///< Код города в словаре хранилища
+};
+
+/**
+ * @struct StringSpan
+ * @brief Положение строки в арене символов.
+ */
+struct StringSpan {
+    std::uint64_t offset;           ///< Смещение строки в арене
+    std::uint32_t length;           ///< Длина строки в байтах
+};
+
+/**
+ * @class ContactStore
+ * @brief Колоночное хранилище контактов (structure-of-arrays).
+ *
+ * ID хранятся в отдельном столбце, имя - как пара смещение+длина в
+ * непрерывной арене символов, телефон - как упакованное 64-битное число.
+ * Просмотр одного столбца (например, поиск по имени) читает память
+ * последовательно и не затрагивает остальные поля. Строки упорядочены по ID.
+ *
+ * Города словарно закодированы: в строке хранится 32-битный код, а каждое
+ * название хранится один раз. Ранги кодов в отсортированном словаре позволяют
+ * сравнивать и сортировать города как целые числа.
+ */
+class ContactStore {
+private:
+    std::vector<int> ids;               ///< Столбец ID
+    std::vector<StringSpan> names;      ///< Столбец имён
+    std::vector<PackedPhone> phones;    ///< Столбец упакованных номеров телефонов
+    std::vector<std::uint32_t> cityCodes; ///< Столбец кодов городов
+    std::string nameArena;              ///< Арена символов имён
+    std::size_t garbageBytes;           ///< Байты арены, занятые устаревшими строками
+
+    std::deque<std::string> cityNames;                              ///< Словарь городов: код -> название (адреса строк стабильны)
+    std::unordered_map<std::string_view, std::uint32_t> cityLookup; ///< Название -> код города, ключи ссылаются на cityNames
+    mutable std::vector<std::uint32_t> cityRankCache;           ///< Код -> ранг в отсортированном словаре
+    mutable bool cityRanksValid;                                ///< Актуален ли cityRankCache
+
+    /**
+     * @brief Возвращает код города, добавляя его в словарь при необходимости.
+     * @param city Название города.
+     * @return Код города.
+     */
+    std::uint32_t internCity(std::string_view city);
+
+    /**
+     * @brief Добавляет строку в арену.
+     * @param arena Арена символов.
+     * @param value Строка.
+     * @return Положение строки в арене.
+     */
+    static StringSpan append(std::string& arena, std::string_view value);
+
+    /**
+     * @brief Возвращает строку из арены.
+     * @param arena Арена символов.
+     * @param span Положение строки.
+     * @return Представление строки.
+     */
+    static std::string_view view(const std::string& arena, StringSpan span) {
+        return std::string_view(arena.data() + span.offset, span.length);
+    }
+
+    /**
+     * @brief Сжимает арену имён, если устаревшие строки занимают больше половины её объёма.
+     */
+    void compactIfNeeded();
+
+    // Загрузка снимка заполняет столбцы напрямую
+    friend bool loadSnapshot(const std::string& filename, ContactStore& contacts, IndexArray& indices);
+
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1); ///< Признак отсутствия строки
+    static constexpr std::uint32_t noCity = static_cast<std::uint32_t>(-1); ///< Признак отсутствия города
+
+    /**
+     * @class const_iterator
+     * @brief Итератор по строкам хранилища, возвращающий ContactView.
+     */
+    class const_iterator {
+    private:
+        const ContactStore* store;  ///< Хранилище
+        std::size_t row;            ///< Номер строки
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ContactView;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = ContactView;
+
+        const_iterator(const ContactStore* store, std::size_t row) : store(store), row(row) {}
+        ContactView operator*() const { return (*store)[row]; }
+        const_iterator& operator++() { ++row; return *this; }
+        bool operator==(const const_iterator& other) const { return row == other.row; }
+        bool operator!=(const const_iterator& other) const { return row != other.row; }
+    };
+
+    /**
+     * @brief Конструктор пустого хранилища.
+     */
+    ContactStore();
+
+    // Ключи cityLookup ссылаются на строки cityNames, поэтому хранилище только перемещается
+    ContactStore(const ContactStore&) = delete;
+    ContactStore& operator=(const ContactStore&) = delete;
+    ContactStore(ContactStore&&) = default;
+    ContactStore& operator=(ContactStore&&) = default;
+
+    /**
+     * @brief Возвращает количество контактов.
+     * @return Количество контактов.
+     */
+    std::size_t size() const { return ids.size(); }
+
+    /**
+     * @brief Проверяет, пусто ли хранилище.
+     * @return true, если контактов нет.
+     */
+    bool empty() const { return ids.empty(); }
+
+    /**
+     * @brief Резервирует память под заданное количество контактов.
+     * @param rows Ожидаемое количество контактов.
+     */
+    void reserve(std::size_t rows);
+
+    /**
+     * @brief Возвращает объём памяти хранилища: столбцы, арену имён и словарь городов.
+     * @return Объём памяти; элементы - контакты.
+     */
+    MemoryUsage memoryUsage() const;
+
+    /**
+     * @brief Удаляет все контакты.
+     */
+    void clear();
+
+    /**
+     * @brief Добавляет контакт с сохранением порядка по ID.
+     * Контакт с ID больше последнего добавляется в конец за O(1),
+     * иначе вставляется в свою позицию. Некорректный номер телефона
+     * сохраняется как пустой.
+     * @param contact Контакт для добавления.
+     */
+    void push_back(const Contact& contact);
+
+    /**
+     * @brief Добавляет контакт из представлений строк без промежуточных копий.
+     * @param id ID контакта.
+     * @param name Имя контакта.
+     * @param phone Упакованный номер телефона.
+     * @param city Город.
+     */
+    void push_back(int id, std::string_view name, PackedPhone phone, std::string_view city);
+
+    /**
+     * @brief Добавляет все контакты другого хранилища с сохранением порядка по ID.
+     * Арена имён пакета копируется одним блоком, коды городов переводятся в
+     * коды этого словаря. Если ID пакета больше последнего ID, столбцы
+     * дописываются целиком, иначе сливаются одним линейным проходом.
+     * @param batch Хранилище-пакет (не должно совпадать с этим хранилищем).
+     */
+    void appendBatch(const ContactStore& batch);
+
+    /**
+     * @brief Возвращает ID контакта в строке.
+     * @param row Номер строки.
+     * @return ID контакта.
+     */
+    int id(std::size_t row) const { return ids[row]; }
+
+    /**
+     * @brief Возвращает имя контакта в строке.
+     * @param row Номер строки.
+     * @return Имя контакта.
+     */
+    std::string_view name(std::size_t row) const { return view(nameArena, names[row]); }
+
+    /**
+     * @brief Возвращает номер телефона контакта в строке.
+     * @param row Номер строки.
+     * @return Упакованный номер телефона.
+     */
+    PackedPhone phoneNumber(std::size_t row) const { return phones[row]; }
+
+    /**
+     * @brief Возвращает город контакта в строке.
+     * @param row Номер строки.
+     * @return Город.
+     */
+    std::string_view city(std::size_t row) const { return cityName(cityCodes[row]); }
+
+    /**
+     * @brief Возвращает код города контакта в строке.
+     * @param row Номер строки.
+     * @return Код города.
+     */
+    std::uint32_t cityCode(std::size_t row) const { return cityCodes[row]; }
+
+    /**
+     * @brief Возвращает название города по коду.
+     * @param code Код города.
+     * @return Название города.
+     */
+    std::string_view cityName(std::uint32_t code) const { return cityNames[code]; }
+
+    /**
+     * @brief Возвращает количество городов в словаре.
+     * @return Размер словаря городов.
+     */
+    std::size_t cityCount() const { return cityNames.size(); }
+
+    /**
+     * @brief Находит код города по названию.
+     * @param city Название города.
+     * @return Код города или noCity, если такого города нет в словаре.
+     */
+    std::uint32_t findCity(std::string_view city) const;
+
+    /**
+     * @brief Возвращает ранги кодов городов в лексикографически отсортированном словаре.
+     * Пересчитывается за O(D log D) после добавления новых городов.
+     * Метод не потокобезопасен, пока ранги не рассчитаны.
+     * @return Вектор рангов, индексированный кодом города.
+     */
+    const std::vector<std::uint32_t>& cityRanks() const;
+
+    /**
+     * @brief Возвращает представление контакта в строке.
+     * @param row Номер строки.
+     * @return Представление контакта.
+     */
+    ContactView operator[](std::size_t row) const {
+        return ContactView{ ids[row], name(row), phones[row], city(row), cityCodes[row] };
+    }
+
+    /**
+     * @brief Возвращает копию контакта в строке.
+     * @param row Номер строки.
+     * @return Контакт.
+     */
+    Contact at(std::size_t row) const;
+
+    /**
+     * @brief Находит строку контакта по ID.
+     * O(1) для ID без пропусков, иначе бинарный поиск по столбцу ID.
+     * @param id ID контакта.
+     * @return Номер строки или npos.
+     */
+    std::size_t rowOf(int id) const;
+
+    /**
+     * @brief Находит первую строку с заданным именем, просматривая только столбец имён.
+     * @param name Имя для поиска.
+     * @param from Строка, с которой начинается поиск.
+     * @return Номер строки или npos.
+     */
+    std::size_t findName(std::string_view name, std::size_t from = 0) const;
+
+    /**
+     * @brief Находит первую строку с заданным номером, сравнивая целые числа.
+     * @param phone Упакованный номер для поиска.
+     * @param from Строка, с которой начинается поиск.
+     * @return Номер строки или npos.
+     */
+    std::size_t findPhone(PackedPhone phone, std::size_t from = 0) const;
+
+    /**
+     * @brief Изменяет имя контакта.
+     * @param row Номер строки.
+     * @param value Новое имя.
+     */
+    void setName(std::size_t row, std::string_view value);
+
+    /**
+     * @brief Изменяет номер телефона контакта.
+     * @param row Номер строки.
+     * @param value Новый упакованный номер телефона.
+     */
+    void setPhoneNumber(std::size_t row, PackedPhone value) { phones[row] = value; }
+
+    /**
+     * @brief Изменяет город контакта.
+     * @param row Номер строки.
+     * @param value Новый город.
+     */
+    void setCity(std::size_t row, std::string_view value);
+
+    /**
+     * @brief Удаляет все контакты, удовлетворяющие предикату, за один проход.
+     * @param predicate Условие удаления.
+     * @return Вектор ID удалённых контактов.
+     */
+    std::vector<int> removeIf(const std::function<bool(const ContactView&)>& predicate);
+
+    /**
+     * @brief Переписывает арену имён в порядке строк, освобождая место устаревших строк.
+     */
+    void compact();
+
+    /**
+     * @brief Итератор на первую строку.
+     * @return Итератор.
+     */
+    const_iterator begin() const { return const_iterator(this, 0); }
+
+    /**
+     * @brief Итератор за последней строкой.
+     * @return Итератор.
+     */
+    const_iterator end() const { return const_iterator(this, ids.size()); }
+};
+
+#endif // CONTACT_STORE_H
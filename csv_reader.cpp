@@ -0,0 +1,139 @@
+// csv_reader.cpp
+
+#include "csv_reader.h"
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Деструктор
+MappedFile::~MappedFile() {
+    close();
+}
+
+// Отображение файла в память
+bool MappedFile::open(const std::string& filename) {
+    close();
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if(fd < 0)
+        return false;
+    struct stat info;
+    if(::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    length = static_cast<std::size_t>(info.st_size);
+    if(length > 0) {
+        void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(mapped == MAP_FAILED) {
+            ::close(fd);
+            length = 0;
+            return false;
+        }
+        // Файл читается один раз от начала до конца
+        ::madvise(mapped, length, MADV_SEQUENTIAL);
+        bytes = static_cast<const char*>(mapped);
+    }
+    // Отображение остаётся действительным после закрытия дескриптора
+    ::close(fd);
+    return true;
+}
+
+// Снятие отображения
+void MappedFile::close() {
+    if(bytes)
+        ::munmap(const_cast<char*>(bytes), length);
+    bytes = nullptr;
+    length = 0;
+}
+
+// Поиск запятой или перевода строки
+const char* findDelimiter(const char* begin, const char* end) {
+    const char* p = begin;
+#ifdef __SSE2__
+    const __m128i commas = _mm_set1_epi8(',');
+    const __m128i newlines = _mm_set1_epi8('\n');
+    for(; end - p >= 16; p += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(block, commas), _mm_cmpeq_epi8(block, newlines));
+        int mask = _mm_movemask_epi8(hits);
+        if(mask != 0)
+            return p + __builtin_ctz(static_cast<unsigned>(mask));
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t commas = vdupq_n_u8(',');
+    const uint8x16_t newlines = vdupq_n_u8('\n');
+    for(; end - p >= 16; p += 16) {
+        uint8x16_t block = vld1q_u8(reinterpret_cast<const std::uint8_t*>(p));
+        uint8x16_t hits = vorrq_u8(vceqq_u8(block, commas), vceqq_u8(block, newlines));
+        // Сужение со сдвигом оставляет по 4 бита на байт: 64-битная маска вместо movemask
+        std::uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hits), 4)), 0);
+        if(mask != 0)
+            return p + (__builtin_ctzll(mask) >> 2);
+    }
+#endif
+    for(; p < end; ++p) {
+        if(*p == ',' || *p == '\n')
+            return p;
+    }
+    return end;
+}
+
+// Разбор CSV-файла контактов
+std::size_t parseContactsCsv(std::string_view text,
+                             const std::function<void(const CsvRecord&)>& onRecord,
+                             const std::function<void(std::string_view)>& onError) {
+    const char* p = text.data();
+    const char* end = p + text.size();
+    std::size_t parsed = 0;
+    while(p < end) {
+        const char* lineStart = p;
+        const char* fields[3];
+        int commas = 0;
+        // Поиск трёх запятых; перевод строки раньше них означает ошибку
+        const char* hit = findDelimiter(p, end);
+        while(hit != end && *hit == ',' && commas < 3) {
+            fields[commas++] = hit;
+            if(commas < 3)
+                hit = findDelimiter(hit + 1, end);
+        }
+        // Город - остаток строки, в нём запятые допустимы
+        const char* lineEnd = commas == 3 ? fields[2] + 1 : hit;
+        if(lineEnd != end && *lineEnd != '\n') {
+            const void* newline = std::memchr(lineEnd, '\n', static_cast<std::size_t>(end - lineEnd));
+            lineEnd = newline ? static_cast<const char*>(newline) : end;
+        }
+        p = lineEnd == end ? end : lineEnd + 1;
+        if(lineEnd > lineStart && lineEnd[-1] == '\r')
+            --lineEnd;
+        if(lineEnd == lineStart)
+            continue;
+
+        std::string_view line(lineStart, static_cast<std::size_t>(lineEnd - lineStart));
+        CsvRecord record;
+        if(commas < 3) {
+            onError(line);
+            continue;
+        }
+        std::from_chars_result id = std::from_chars(lineStart, fields[0], record.id);
+        if(id.ec != std::errc() || id.ptr != fields[0]) {
+            onError(line);
+            continue;
+        }
+        record.name = std::string_view(fields[0] + 1, static_cast<std::size_t>(fields[1] - fields[0] - 1));
+        record.phoneNumber = std::string_view(fields[1] + 1, static_cast<std::size_t>(fields[2] - fields[1] - 1));
+        record.city = std::string_view(fields[2] + 1, static_cast<std::size_t>(lineEnd - fields[2] - 1));
+        record.line = line;
+        onRecord(record);
+        ++parsed;
+    }
+    return parsed;
+}
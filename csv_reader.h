@@ -0,0 +1,92 @@
+// csv_reader.h
+
+#ifndef CSV_READER_H
+#define CSV_READER_H
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <functional>
+
+/**
+ * @class MappedFile
+ * @brief Файл, отображённый в память только для чтения (POSIX mmap).
+ *
+ * Содержимое доступно как непрерывный массив байтов без копирования в
+ * буферы потока. Отображение снимается в деструкторе.
+ */
+class MappedFile {
+private:
+    const char* bytes;  ///< Начало отображения
+    std::size_t length; ///< Размер файла в байтах
+
+public:
+    /**
+     * @brief Конструктор пустого отображения.
+     */
+    MappedFile() : bytes(nullptr), length(0) {}
+
+    /**
+     * @brief Деструктор. Снимает отображение.
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Отображает файл в память.
+     * @param filename Имя файла.
+     * @return true, если файл открыт; пустой файл тоже считается открытым.
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * @brief Снимает отображение.
+     */
+    void close();
+
+    /**
+     * @brief Возвращает содержимое файла.
+     * @return Представление байтов файла.
+     */
+    std::string_view view() const { return std::string_view(bytes, length); }
+};
+
+/**
+ * @struct CsvRecord
+ * @brief Строка CSV-файла контактов "id,имя,телефон,город".
+ *
+ * Поля ссылаются на разбираемый буфер и не копируются.
+ */
+struct CsvRecord {
+    int id;                         ///< ID контакта
+    std::string_view name;          ///< Имя контакта
+    std::string_view phoneNumber;   ///< Номер телефона (не проверен)
+    std::string_view city;          ///< Город: всё после третьей запятой
+    std::string_view line;          ///< Вся строка, для сообщений об ошибках
+};
+
+/**
+ * @brief Находит первую запятую или перевод строки.
+ * Поиск ведётся блоками по 16 байт инструкциями SSE2 (x86-64) или NEON (arm64), если они доступны.
+ * @param begin Начало диапазона.
+ * @param end Конец диапазона.
+ * @return Указатель на найденный символ или end.
+ */
+const char* findDelimiter(const char* begin, const char* end);
+
+/**
+ * @brief Разбирает CSV-файл контактов без промежуточных строк.
+ * Разделители ищутся findDelimiter, ID разбирается std::from_chars.
+ * Завершающий символ '\r' и пустые строки пропускаются.
+ * @param text Содержимое файла.
+ * @param onRecord Вызывается для каждой корректной строки.
+ * @param onError Вызывается для строки некорректного формата.
+ * @return Количество корректных строк.
+ */
+std::size_t parseContactsCsv(std::string_view text,
+                             const std::function<void(const CsvRecord&)>& onRecord,
+                             const std::function<void(std::string_view)>& onError);
+
+#endif // CSV_READER_H
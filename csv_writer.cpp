@@ -0,0 +1,139 @@
+// csv_writer.cpp
+
+#include "csv_writer.h"
+#include <iostream>
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Конструктор
+CsvWriter::CsvWriter() : fd(-1), written(0), failed(false) {}
+
+// Деструктор
+CsvWriter::~CsvWriter() {
+    discard();
+}
+
+// Создание временного файла
+bool CsvWriter::open(const std::string& filename) {
+    discard();
+    path = filename;
+    temporary = filename + ".tmp";
+    // Новый файл получает права прежнего, а не права по умолчанию
+    struct stat target;
+    bool exists = ::stat(path.c_str(), &target) == 0;
+    fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd >= 0 && exists && ::fchmod(fd, target.st_mode & 07777) != 0) {
+        ::close(fd);
+        fd = -1;
+        std::remove(temporary.c_str());
+    }
+    if(fd < 0) {
+        std::cerr << "Не удалось открыть файл для записи: " << temporary << "\n";
+        return false;
+    }
+    buffer.reserve(bufferSize + 256);
+    written = 0;
+    failed = false;
+    return true;
+}
+
+// Передача буфера в файл
+void CsvWriter::flush() {
+    const char* data = buffer.data();
+    std::size_t remaining = buffer.size();
+    while(remaining > 0 && !failed) {
+        ssize_t count = ::write(fd, data, remaining);
+        if(count <= 0) {
+            failed = true;
+            break;
+        }
+        data += count;
+        remaining -= static_cast<std::size_t>(count);
+        written += static_cast<std::uint64_t>(count);
+    }
+    buffer.clear();
+}
+
+// Запись целого числа
+void CsvWriter::writeInt(long long value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    write(std::string_view(digits, static_cast<std::size_t>(result.ptr - digits)));
+}
+
+// Запись строки контакта
+void CsvWriter::writeContact(const ContactView& contact) {
+    char phone[PackedPhone::maxDigits];
+    writeInt(contact.id);
+    buffer.push_back(',');
+    buffer.append(contact.name);
+    buffer.push_back(',');
+    buffer.append(phone, contact.phoneNumber.format(phone));
+    buffer.push_back(',');
+    buffer.append(contact.city);
+    write('\n');
+}
+
+// Завершение записи
+bool CsvWriter::commit() {
+    if(fd < 0)
+        return false;
+    flush();
+    bool synced = syncDescriptor(fd);
+    bool closed = ::close(fd) == 0;
+    fd = -1;
+    if(failed || !synced || !closed || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::cerr << "Не удалось записать файл: " << path << "\n";
+        std::remove(temporary.c_str());
+        return false;
+    }
+    // Без синхронизации каталога сбой сразу после rename может вернуть прежний файл
+    if(!syncParentDirectory(path)) {
+        std::cerr << "Не удалось сохранить на диске каталог файла: " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+// Отмена записи
+void CsvWriter::discard() {
+    buffer.clear();
+    if(fd < 0)
+        return;
+    ::close(fd);
+    fd = -1;
+    std::remove(temporary.c_str());
+}
+
+// Синхронизация дескриптора с диском
+bool syncDescriptor(int fd, bool directory) {
+#if defined(__APPLE__)
+    (void)directory;
+    return ::fsync(fd) == 0;
+#else
+    return directory ? ::fsync(fd) == 0 : ::fdatasync(fd) == 0;
+#endif
+}
+
+// Синхронизация файла по имени
+bool syncFile(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_WRONLY);
+    if(fd < 0)
+        return false;
+    bool synced = syncDescriptor(fd);
+    return ::close(fd) == 0 && synced;
+}
+
+// Синхронизация каталога файла
+bool syncParentDirectory(const std::string& filename) {
+    std::filesystem::path directory = std::filesystem::path(filename).parent_path();
+    int fd = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY);
+    if(fd < 0)
+        return false;
+    bool synced = syncDescriptor(fd, true);
+    return ::close(fd) == 0 && synced;
+}
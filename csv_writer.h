@@ -0,0 +1,136 @@
+// csv_writer.h
+
+#ifndef CSV_WRITER_H
+#define CSV_WRITER_H
+
+#include "contact_store.h"
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class CsvWriter
+ * @brief Буферизованная атомарная запись текстового файла.
+ *
+ * Строки собираются в буфере большого размера (числа - через std::to_chars)
+ * и передаются в файл крупными блоками. Данные пишутся во временный файл
+ * "имя.tmp" с правами доступа целевого файла, который при commit синхронизируется
+ * с диском и переименовывается поверх целевого; затем на диск сбрасывается каталог.
+ * Сбой посреди записи оставляет прежний файл целым.
+ */
+class CsvWriter {
+private:
+    std::string path;           ///< Имя целевого файла
+    std::string temporary;      ///< Имя временного файла
+    int fd;                     ///< Дескриптор временного файла (-1, если закрыт)
+    std::string buffer;         ///< Данные, ещё не переданные в файл
+    std::uint64_t written;      ///< Байт передано в файл
+    bool failed;                ///< Была ошибка записи
+
+    /**
+     * @brief Передаёт буфер в файл.
+     */
+    void flush();
+
+public:
+    /**
+     * @brief Размер буфера, при заполнении которого данные передаются в файл.
+     */
+    static constexpr std::size_t bufferSize = 1 << 20;
+
+    /**
+     * @brief Конструктор закрытого писателя.
+     */
+    CsvWriter();
+
+    /**
+     * @brief Деструктор. Незавершённая запись отменяется.
+     */
+    ~CsvWriter();
+
+    CsvWriter(const CsvWriter&) = delete;
+    CsvWriter& operator=(const CsvWriter&) = delete;
+
+    /**
+     * @brief Создаёт временный файл рядом с целевым.
+     * @param filename Имя целевого файла.
+     * @return true, если временный файл создан.
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * @brief Добавляет строку.
+     * @param text Текст.
+     */
+    void write(std::string_view text) {
+        buffer.append(text);
+        if(buffer.size() >= bufferSize)
+            flush();
+    }
+
+    /**
+     * @brief Добавляет символ.
+     * @param c Символ.
+     */
+    void write(char c) {
+        buffer.push_back(c);
+        if(buffer.size() >= bufferSize)
+            flush();
+    }
+
+    /**
+     * @brief Добавляет целое число в десятичной записи.
+     * @param value Число.
+     */
+    void writeInt(long long value);
+
+    /**
+     * @brief Добавляет строку контакта "id,имя,телефон,город\n".
+     * @param contact Контакт.
+     */
+    void writeContact(const ContactView& contact);
+
+    /**
+     * @brief Завершает запись: сбрасывает буфер, синхронизирует временный файл
+     * с диском, переименовывает его в целевой и синхронизирует каталог.
+     * @return true, если файл записан и переименование сохранено на диске.
+     */
+    bool commit();
+
+    /**
+     * @brief Отменяет запись и удаляет временный файл; целевой файл не изменяется.
+     */
+    void discard();
+
+    /**
+     * @brief Возвращает количество записанных байтов вместе с буфером.
+     * @return Размер в байтах.
+     */
+    std::uint64_t size() const { return written + buffer.size(); }
+};
+
+/**
+ * @brief Сбрасывает данные открытого файла или каталога на диск.
+ * Для файла используется fdatasync, для каталога и на macOS - fsync.
+ * @param fd Дескриптор.
+ * @param directory true, если дескриптор открыт для каталога.
+ * @return true, если данные на диске.
+ */
+bool syncDescriptor(int fd, bool directory = false);
+
+/**
+ * @brief Сбрасывает на диск файл по имени.
+ * @param filename Имя файла.
+ * @return true, если данные файла на диске.
+ */
+bool syncFile(const std::string& filename);
+
+/**
+ * @brief Сбрасывает на диск каталог файла, сохраняя его создание или переименование.
+ * @param filename Имя файла в каталоге.
+ * @return true, если запись каталога на диске.
+ */
+bool syncParentDirectory(const std::string& filename);
+
+#endif // CSV_WRITER_H
@@ -0,0 +1,678 @@
+// external_index.cpp
+
+#include "external_index.h"
+#include "phone_number.h"
+#include "csv_writer.h"
+#include "trace.h"
+#include <iostream>
+#include <algorithm>
+#include <queue>
+#include <memory>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+    const char indexMagic[8] = { 'C', 'O', 'N', 'T', 'D', 'I', 'D', 'X' };
+    const char frontCodedMagic[8] = { 'C', 'O', 'N', 'T', 'F', 'I', 'D', 'X' };
+    constexpr std::uint32_t indexVersion = 1;
+    constexpr std::uint32_t byteOrderMark = 0x01020304;
+    constexpr std::size_t writeBlock = 1 << 20;
+    constexpr std::size_t minReadBuffer = 64 << 10;
+    constexpr std::uint32_t frontCodedBlock = 64; // Записей в блоке фронтального кодирования
+
+    // Заголовок файла индекса
+    struct IndexHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint32_t key;
+        std::uint32_t reserved;
+        std::uint64_t count;
+        std::uint64_t entriesOffset;
+        std::uint64_t keysOffset;
+        std::uint64_t keysSize;
+    };
+
+    // Заголовок файла индекса с фронтальным кодированием
+    struct FrontCodedHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint32_t key;
+        std::uint32_t blockEntries;
+        std::uint64_t count;
+        std::uint64_t blocksEnd;
+        std::uint64_t blockCount;
+        std::uint64_t tableOffset;
+    };
+
+    // Запись отрезка в памяти: ключ ссылается на отображённый CSV-файл
+    struct RunEntry {
+        std::string_view key;
+        std::uint64_t lineOffset;
+        int id;
+    };
+
+    bool entryLess(const RunEntry& a, const RunEntry& b) {
+        int order = a.key.compare(b.key);
+        if(order != 0)
+            return order < 0;
+        return a.id != b.id ? a.id < b.id : a.lineOffset < b.lineOffset;
+    }
+
+    // Последовательная буферизованная запись в файл с заданного смещения
+    class BlockWriter {
+    private:
+        int fd;
+        std::uint64_t offset;
+        std::string buffer;
+        bool failed;
+
+    public:
+        BlockWriter(int fd, std::uint64_t offset) : fd(fd), offset(offset), failed(false) {
+            buffer.reserve(writeBlock);
+        }
+
+        template<typename T>
+        void put(const T& value) {
+            append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        void append(const char* data, std::size_t size) {
+            buffer.append(data, size);
+            if(buffer.size() >= writeBlock)
+                flush();
+        }
+
+        bool flush() {
+            const char* data = buffer.data();
+            std::size_t remaining = buffer.size();
+            while(remaining > 0 && !failed) {
+                ssize_t written = ::pwrite(fd, data, remaining, static_cast<off_t>(offset));
+                if(written <= 0) {
+                    failed = true;
+                    break;
+                }
+                data += written;
+                remaining -= static_cast<std::size_t>(written);
+                offset += static_cast<std::uint64_t>(written);
+            }
+            buffer.clear();
+            return !failed;
+        }
+    };
+
+    // Последовательное чтение отрезка с диска
+    class RunReader {
+    private:
+        int fd;
+        std::vector<char> buffer;
+        std::size_t position;
+        std::size_t filled;
+
+        bool read(char* out, std::size_t size) {
+            while(size > 0) {
+                if(position == filled) {
+                    ssize_t got = ::read(fd, buffer.data(), buffer.size());
+                    if(got <= 0)
+                        return false;
+                    position = 0;
+                    filled = static_cast<std::size_t>(got);
+                }
+                std::size_t part = std::min(size, filled - position);
+                std::memcpy(out, buffer.data() + position, part);
+                position += part;
+                out += part;
+                size -= part;
+            }
+            return true;
+        }
+
+    public:
+        std::string key;
+        std::uint64_t lineOffset = 0;
+        int id = 0;
+
+        RunReader(int fd, std::size_t bufferSize) : fd(fd), buffer(bufferSize), position(0), filled(0) {}
+        ~RunReader() { ::close(fd); }
+
+        RunReader(const RunReader&) = delete;
+        RunReader& operator=(const RunReader&) = delete;
+
+        // Чтение следующей записи; false в конце отрезка
+        bool next() {
+            std::uint32_t length;
+            if(!read(reinterpret_cast<char*>(&length), sizeof(length)) ||
+               !read(reinterpret_cast<char*>(&id), sizeof(id)) ||
+               !read(reinterpret_cast<char*>(&lineOffset), sizeof(lineOffset)))
+                return false;
+            key.resize(length);
+            return read(&key[0], length);
+        }
+    };
+
+    // Ключ строки CSV по атрибуту индекса
+    std::string_view keyOf(const CsvRecord& record, IndexKey key) {
+        switch(key) {
+            case IndexKey::NAME: return record.name;
+            case IndexKey::CITY: return record.city;
+            default: return record.phoneNumber;
+        }
+    }
+
+    // Запись целого без знака кодом переменной длины (7 бит на байт)
+    void putVarint(std::string& out, std::uint64_t value) {
+        while(value >= 0x80) {
+            out.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    // Чтение кода переменной длины с проверкой границ
+    bool getVarint(const char*& p, const char* end, std::uint64_t& value) {
+        value = 0;
+        for(int shift = 0; shift < 64 && p < end; shift += 7) {
+            std::uint8_t byte = static_cast<std::uint8_t>(*p++);
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if(!(byte & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    // Знаковая разность в беззнаковом виде: малые по модулю значения дают короткий код
+    std::uint64_t zigzag(std::int64_t value) {
+        return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+    }
+
+    std::int64_t unzigzag(std::uint64_t value) {
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    // Индекс с таблицей записей фиксированного размера и блоком ключей.
+    // Таблица и ключи пишутся двумя последовательными потоками в свои области файла
+    class PlainOutput {
+    private:
+        int fd;
+        IndexHeader header;
+        BlockWriter entryWriter;
+        BlockWriter keyWriter;
+        std::uint64_t keyOffset;
+
+    public:
+        PlainOutput(int fd, IndexKey key, std::uint64_t count, std::uint64_t keyBytes)
+            : fd(fd), header(), entryWriter(fd, sizeof(IndexHeader)),
+              keyWriter(fd, sizeof(IndexHeader) + count * sizeof(DiskIndex::Entry)), keyOffset(0) {
+            std::memcpy(header.magic, indexMagic, sizeof(indexMagic));
+            header.version = indexVersion;
+            header.byteOrder = byteOrderMark;
+            header.key = static_cast<std::uint32_t>(key);
+            header.count = count;
+            header.entriesOffset = sizeof(IndexHeader);
+            header.keysOffset = header.entriesOffset + count * sizeof(DiskIndex::Entry);
+            header.keysSize = keyBytes;
+        }
+
+        void add(const std::string& key, int id, std::uint64_t lineOffset) {
+            DiskIndex::Entry entry{ keyOffset, static_cast<std::uint32_t>(key.size()), id, lineOffset };
+            entryWriter.put(entry);
+            keyWriter.append(key.data(), key.size());
+            keyOffset += key.size();
+        }
+
+        bool finish() {
+            return entryWriter.flush() && keyWriter.flush() &&
+                   ::pwrite(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+        }
+    };
+
+    // Индекс с фронтальным кодированием: блоки по frontCodedBlock записей,
+    // за ними таблица смещений блоков
+    class FrontCodedOutput {
+    private:
+        int fd;
+        FrontCodedHeader header;
+        BlockWriter writer;
+        std::string block;
+        std::vector<std::uint64_t> blockOffsets;
+        std::uint64_t position;
+        std::string previousKey;
+        int previousId;
+        std::uint64_t previousLine;
+        std::uint32_t inBlock;
+
+        void flushBlock() {
+            if(block.empty())
+                return;
+            blockOffsets.push_back(position);
+            writer.append(block.data(), block.size());
+            position += block.size();
+            block.clear();
+            inBlock = 0;
+        }
+
+    public:
+        FrontCodedOutput(int fd, IndexKey key)
+            : fd(fd), header(), writer(fd, sizeof(FrontCodedHeader)), position(sizeof(FrontCodedHeader)),
+              previousId(0), previousLine(0), inBlock(0) {
+            std::memcpy(header.magic, frontCodedMagic, sizeof(frontCodedMagic));
+            header.version = indexVersion;
+            header.byteOrder = byteOrderMark;
+            header.key = static_cast<std::uint32_t>(key);
+            header.blockEntries = frontCodedBlock;
+        }
+
+        void add(const std::string& key, int id, std::uint64_t lineOffset) {
+            // Первый ключ блока хранится целиком, чтобы блок декодировался независимо
+            std::size_t shared = 0;
+            if(inBlock == 0) {
+                previousId = 0;
+                previousLine = 0;
+            }
+            else {
+                std::size_t limit = std::min(key.size(), previousKey.size());
+                while(shared < limit && key[shared] == previousKey[shared])
+                    ++shared;
+            }
+            putVarint(block, shared);
+            putVarint(block, key.size() - shared);
+            block.append(key, shared, std::string::npos);
+            putVarint(block, zigzag(static_cast<std::int64_t>(id) - previousId));
+            putVarint(block, zigzag(static_cast<std::int64_t>(lineOffset - previousLine)));
+            previousKey = key;
+            previousId = id;
+            previousLine = lineOffset;
+            ++header.count;
+            if(++inBlock == frontCodedBlock)
+                flushBlock();
+        }
+
+        bool finish() {
+            flushBlock();
+            header.blocksEnd = position;
+            header.blockCount = blockOffsets.size();
+            header.tableOffset = (position + 7) / 8 * 8;
+            std::uint64_t padding = header.tableOffset - position;
+            static const char zeros[8] = {};
+            writer.append(zeros, padding);
+            writer.append(reinterpret_cast<const char*>(blockOffsets.data()), blockOffsets.size() * sizeof(std::uint64_t));
+            return writer.flush() &&
+                   ::pwrite(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+        }
+    };
+
+    // Слияние отсортированных отрезков; возвращает количество записей
+    template<typename Output>
+    std::uint64_t mergeRuns(std::vector<std::unique_ptr<RunReader>>& readers, Output& output) {
+        auto greater = [&](std::size_t a, std::size_t b) {
+            const RunReader& x = *readers[a];
+            const RunReader& y = *readers[b];
+            int order = x.key.compare(y.key);
+            if(order != 0)
+                return order > 0;
+            return x.id != y.id ? x.id > y.id : x.lineOffset > y.lineOffset;
+        };
+        std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(greater)> heap(greater);
+        for(std::size_t r = 0; r < readers.size(); ++r) {
+            if(readers[r]->next())
+                heap.push(r);
+        }
+        std::uint64_t written = 0;
+        while(!heap.empty()) {
+            std::size_t r = heap.top();
+            heap.pop();
+            RunReader& reader = *readers[r];
+            output.add(reader.key, reader.id, reader.lineOffset);
+            ++written;
+            if(reader.next())
+                heap.push(r);
+        }
+        return written;
+    }
+
+    // Синхронизация и закрытие файла
+    bool closeSynced(int fd) {
+        bool synced = syncDescriptor(fd);
+        return ::close(fd) == 0 && synced;
+    }
+}
+
+// Построение индекса во внешней памяти
+bool buildExternalIndex(const std::string& csvFile, const std::string& indexFile, IndexKey key,
+                        std::size_t memoryBudget, IndexFormat format) {
+    MappedFile csv;
+    if(!csv.open(csvFile)) {
+        std::cerr << "Не удалось открыть файл для чтения: " << csvFile << "\n";
+        return false;
+    }
+    std::string_view text = csv.view();
+
+    // Фаза 1: отрезки, помещающиеся в memoryBudget, сортируются и сбрасываются на диск
+    std::vector<std::string> runFiles;
+    std::vector<RunEntry> run;
+    std::size_t runBytes = 0;
+    std::uint64_t totalCount = 0;
+    std::uint64_t totalKeyBytes = 0;
+    bool ok = true;
+
+    auto removeRuns = [&] {
+        for(const std::string& name : runFiles)
+            std::remove(name.c_str());
+    };
+
+    auto spillRun = [&] {
+        if(run.empty() || !ok)
+            return;
+        TRACE_SPAN("external index spill run");
+        std::sort(run.begin(), run.end(), entryLess);
+        std::string name = indexFile + ".run" + std::to_string(runFiles.size());
+        int fd = ::open(name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if(fd < 0) {
+            std::cerr << "Не удалось открыть файл для записи: " << name << "\n";
+            ok = false;
+            return;
+        }
+        runFiles.push_back(name);
+        BlockWriter out(fd, 0);
+        for(const RunEntry& entry : run) {
+            out.put(static_cast<std::uint32_t>(entry.key.size()));
+            out.put(entry.id);
+            out.put(entry.lineOffset);
+            out.append(entry.key.data(), entry.key.size());
+        }
+        ok = out.flush() && ::close(fd) == 0;
+        run.clear();
+        runBytes = 0;
+    };
+
+    parseContactsCsv(text,
+        [&](const CsvRecord& record) {
+            if(!validatePhoneDigits(record.phoneNumber))
+                return;
+            RunEntry entry{ keyOf(record, key), static_cast<std::uint64_t>(record.line.data() - text.data()), record.id };
+            run.push_back(entry);
+            runBytes += sizeof(RunEntry) + entry.key.size();
+            ++totalCount;
+            totalKeyBytes += entry.key.size();
+            if(runBytes >= memoryBudget)
+                spillRun();
+        },
+        [](std::string_view) {});
+    spillRun();
+    std::vector<RunEntry>().swap(run);
+    if(!ok) {
+        removeRuns();
+        return false;
+    }
+
+    // Фаза 2: k-путевое слияние отрезков в файл индекса выбранного формата
+    std::string temporary = indexFile + ".tmp";
+    int fd = ::open(temporary.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0) {
+        std::cerr << "Не удалось открыть файл для записи: " << temporary << "\n";
+        removeRuns();
+        return false;
+    }
+
+    std::size_t readBuffer = std::max(minReadBuffer, memoryBudget / (runFiles.size() + 1));
+    std::vector<std::unique_ptr<RunReader>> readers;
+    for(const std::string& name : runFiles) {
+        int runFd = ::open(name.c_str(), O_RDONLY);
+        if(runFd < 0) {
+            ok = false;
+            break;
+        }
+        readers.push_back(std::make_unique<RunReader>(runFd, readBuffer));
+    }
+    if(ok) {
+        TRACE_SPAN("external index merge");
+        if(format == IndexFormat::FRONT_CODED) {
+            FrontCodedOutput output(fd, key);
+            ok = mergeRuns(readers, output) == totalCount && output.finish();
+        }
+        else {
+            PlainOutput output(fd, key, totalCount, totalKeyBytes);
+            ok = mergeRuns(readers, output) == totalCount && output.finish();
+        }
+    }
+    readers.clear();
+    removeRuns();
+
+    ok = closeSynced(fd) && ok;
+    if(!ok || std::rename(temporary.c_str(), indexFile.c_str()) != 0) {
+        std::cerr << "Не удалось записать индекс: " << indexFile << "\n";
+        std::remove(temporary.c_str());
+        return false;
+    }
+    std::cout << "Индекс " << indexFile << " построен: " << totalCount << " записей, "
+              << runFiles.size() << " отрезков\n";
+    return true;
+}
+
+// Открытие индекса
+bool DiskIndex::open(const std::string& filename) {
+    entries = nullptr;
+    keys = nullptr;
+    count = keysSize = 0;
+    if(!file.open(filename)) {
+        std::cerr << "Не удалось открыть файл для чтения: " << filename << "\n";
+        return false;
+    }
+    std::string_view bytes = file.view();
+    IndexHeader header;
+    bool valid = bytes.size() >= sizeof(header);
+    if(valid) {
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        valid = std::memcmp(header.magic, indexMagic, sizeof(indexMagic)) == 0 &&
+                header.version == indexVersion && header.byteOrder == byteOrderMark &&
+                header.key <= static_cast<std::uint32_t>(IndexKey::PHONE) &&
+                header.entriesOffset == sizeof(IndexHeader) &&
+                header.count <= (bytes.size() - header.entriesOffset) / sizeof(Entry) &&
+                header.keysOffset == header.entriesOffset + header.count * sizeof(Entry) &&
+                header.keysSize <= bytes.size() - header.keysOffset;
+    }
+    if(!valid) {
+        std::cerr << "Неподдерживаемый формат индекса: " << filename << "\n";
+        file.close();
+        return false;
+    }
+    entries = reinterpret_cast<const Entry*>(bytes.data() + header.entriesOffset);
+    keys = bytes.data() + header.keysOffset;
+    count = header.count;
+    keysSize = header.keysSize;
+    attribute = static_cast<IndexKey>(header.key);
+    return true;
+}
+
+// Ключ записи
+std::string_view DiskIndex::keyAt(std::size_t position) const {
+    const Entry& entry = entries[position];
+    if(entry.keyOffset > keysSize || entry.keyLength > keysSize - entry.keyOffset)
+        return std::string_view();
+    return std::string_view(keys + entry.keyOffset, entry.keyLength);
+}
+
+// Отрезок записей с ключом
+std::pair<std::size_t, std::size_t> DiskIndex::equalRange(std::string_view key) const {
+    std::size_t first = 0, last = size();
+    // Левая граница: первый ключ не меньше искомого
+    while(first < last) {
+        std::size_t mid = first + (last - first) / 2;
+        if(keyAt(mid) < key)
+            first = mid + 1;
+        else
+            last = mid;
+    }
+    // Правая граница: первый ключ больше искомого
+    std::size_t end = first;
+    last = size();
+    while(end < last) {
+        std::size_t mid = end + (last - end) / 2;
+        if(keyAt(mid) == key)
+            end = mid + 1;
+        else
+            last = mid;
+    }
+    return { first, end };
+}
+
+// Отрезок записей с префиксом
+std::pair<std::size_t, std::size_t> DiskIndex::prefixRange(std::string_view prefix) const {
+    std::size_t first = 0, last = size();
+    while(first < last) {
+        std::size_t mid = first + (last - first) / 2;
+        if(keyAt(mid) < prefix)
+            first = mid + 1;
+        else
+            last = mid;
+    }
+    // Ключи с префиксом идут подряд сразу за левой границей
+    std::size_t end = first;
+    last = size();
+    while(end < last) {
+        std::size_t mid = end + (last - end) / 2;
+        if(keyAt(mid).substr(0, prefix.size()) == prefix)
+            end = mid + 1;
+        else
+            last = mid;
+    }
+    return { first, end };
+}
+
+// Бинарный поиск по ключу
+std::vector<int> DiskIndex::search(std::string_view key) const {
+    std::vector<int> result;
+    auto range = equalRange(key);
+    for(std::size_t position = range.first; position < range.second; ++position)
+        result.push_back(recordNumber(position));
+    return result;
+}
+
+// Открытие сжатого индекса
+bool FrontCodedIndex::open(const std::string& filename) {
+    bytes = nullptr;
+    blocks = nullptr;
+    blockCount = blocksEnd = count = 0;
+    if(!file.open(filename)) {
+        std::cerr << "Не удалось открыть файл для чтения: " << filename << "\n";
+        return false;
+    }
+    std::string_view view = file.view();
+    FrontCodedHeader header;
+    bool valid = view.size() >= sizeof(header);
+    if(valid) {
+        std::memcpy(&header, view.data(), sizeof(header));
+        valid = std::memcmp(header.magic, frontCodedMagic, sizeof(frontCodedMagic)) == 0 &&
+                header.version == indexVersion && header.byteOrder == byteOrderMark &&
+                header.key <= static_cast<std::uint32_t>(IndexKey::PHONE) &&
+                header.blockEntries == frontCodedBlock &&
+                header.blocksEnd >= sizeof(header) && header.blocksEnd <= header.tableOffset &&
+                header.tableOffset % 8 == 0 && header.tableOffset <= view.size() &&
+                header.blockCount <= (view.size() - header.tableOffset) / sizeof(std::uint64_t) &&
+                header.blockCount == (header.count + frontCodedBlock - 1) / frontCodedBlock;
+    }
+    if(valid) {
+        // Смещения блоков возрастают и лежат в области блоков
+        const std::uint64_t* table = reinterpret_cast<const std::uint64_t*>(view.data() + header.tableOffset);
+        std::uint64_t previous = sizeof(header);
+        for(std::uint64_t b = 0; valid && b < header.blockCount; ++b) {
+            valid = table[b] >= previous && table[b] < header.blocksEnd;
+            previous = table[b] + 1;
+        }
+        blocks = table;
+    }
+    if(!valid) {
+        std::cerr << "Неподдерживаемый формат индекса: " << filename << "\n";
+        blocks = nullptr;
+        file.close();
+        return false;
+    }
+    bytes = view.data();
+    blockCount = header.blockCount;
+    blocksEnd = header.blocksEnd;
+    count = header.count;
+    attribute = static_cast<IndexKey>(header.key);
+    return true;
+}
+
+// Первый ключ блока
+std::string_view FrontCodedIndex::firstKey(std::size_t block) const {
+    const char* p = bytes + blocks[block];
+    const char* end = bytes + blocksEnd;
+    std::uint64_t shared, length;
+    if(!getVarint(p, end, shared) || !getVarint(p, end, length) || shared != 0 ||
+       length > static_cast<std::uint64_t>(end - p))
+        return std::string_view();
+    return std::string_view(p, length);
+}
+
+// Обход записей от нижней границы ключа
+void FrontCodedIndex::scanFrom(std::string_view key,
+                               const std::function<bool(std::string_view, int, std::uint64_t)>& visit) const {
+    if(blockCount == 0)
+        return;
+    // Последний блок, первый ключ которого меньше искомого: равные ключи
+    // могут начинаться в его конце
+    std::size_t first = 0, last = blockCount;
+    while(first < last) {
+        std::size_t mid = first + (last - first) / 2;
+        if(firstKey(mid) < key)
+            first = mid + 1;
+        else
+            last = mid;
+    }
+    std::size_t block = first > 0 ? first - 1 : 0;
+
+    std::string current;
+    std::uint64_t remaining = count - block * static_cast<std::uint64_t>(frontCodedBlock);
+    for(; block < blockCount; ++block) {
+        const char* p = bytes + blocks[block];
+        const char* end = bytes + (block + 1 < blockCount ? blocks[block + 1] : blocksEnd);
+        std::uint64_t entries = std::min<std::uint64_t>(remaining, frontCodedBlock);
+        remaining -= entries;
+        std::int64_t id = 0;
+        std::uint64_t line = 0;
+        for(std::uint64_t i = 0; i < entries; ++i) {
+            std::uint64_t shared, length, idDelta, lineDelta;
+            if(!getVarint(p, end, shared) || !getVarint(p, end, length) || shared > current.size() ||
+               length > static_cast<std::uint64_t>(end - p))
+                return;
+            current.resize(shared);
+            current.append(p, length);
+            p += length;
+            if(!getVarint(p, end, idDelta) || !getVarint(p, end, lineDelta))
+                return;
+            id += unzigzag(idDelta);
+            line += static_cast<std::uint64_t>(unzigzag(lineDelta));
+            if(current < key)
+                continue;
+            if(!visit(current, static_cast<int>(id), line))
+                return;
+        }
+    }
+}
+
+// Поиск записей по ключу или префиксу
+std::size_t FrontCodedIndex::find(std::string_view key, bool prefix,
+                                  const std::function<void(std::string_view, int, std::uint64_t)>& visit) const {
+    std::size_t found = 0;
+    scanFrom(key, [&](std::string_view current, int id, std::uint64_t line) {
+        bool matches = prefix ? current.substr(0, key.size()) == key : current == key;
+        if(!matches)
+            return false;
+        visit(current, id, line);
+        ++found;
+        return true;
+    });
+    return found;
+}
+
+// Бинарный поиск по ключу
+std::vector<int> FrontCodedIndex::search(std::string_view key) const {
+    std::vector<int> result;
+    find(key, false, [&](std::string_view, int id, std::uint64_t) { result.push_back(id); });
+    return result;
+}
@@ -0,0 +1,231 @@
+// external_index.h
+
+#ifndef EXTERNAL_INDEX_H
+#define EXTERNAL_INDEX_H
+
+#include "csv_reader.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/**
+ * @enum IndexKey
+ * @brief Атрибут, по которому строится индекс на диске.
+ */
+enum class IndexKey {
+    NAME,   ///< Имя
+    CITY,   ///< Город
+    PHONE   ///< Номер телефона (цифры в тексте, порядок совпадает с PackedPhone)
+};
+
+/**
+ * @enum IndexFormat
+ * @brief Формат файла индекса на диске.
+ */
+enum class IndexFormat {
+    PLAIN,          ///< Таблица записей фиксированного размера (DiskIndex)
+    FRONT_CODED     ///< Блоки с фронтальным кодированием ключей (FrontCodedIndex)
+};
+
+/**
+ * @brief Строит отсортированный индекс CSV-файла контактов во внешней памяти.
+ *
+ * CSV-файл отображается в память и читается отрезками, которые помещаются в
+ * заданный объём памяти. Каждый отрезок сортируется по (ключ, ID) и
+ * сбрасывается во временный файл рядом с индексом; затем отрезки сливаются
+ * k-путевым слиянием в файл индекса. Одновременно в памяти находится только
+ * один отрезок или буферы чтения отрезков, поэтому файл может быть больше
+ * оперативной памяти. Строки с некорректным ID или номером пропускаются.
+ * @param csvFile Имя CSV-файла контактов.
+ * @param indexFile Имя создаваемого файла индекса.
+ * @param key Атрибут индекса.
+ * @param memoryBudget Объём памяти под отрезок в байтах.
+ * @param format Формат файла индекса.
+ * @return true, если индекс записан.
+ */
+bool buildExternalIndex(const std::string& csvFile, const std::string& indexFile, IndexKey key,
+                        std::size_t memoryBudget = 64 << 20, IndexFormat format = IndexFormat::PLAIN);
+
+/**
+ * @class DiskIndex
+ * @brief Отсортированный индекс на диске, доступный через mmap.
+ *
+ * Файл содержит заголовок, таблицу записей фиксированного размера (смещение
+ * и длина ключа, ID контакта, смещение строки в CSV-файле) и блок символов
+ * ключей. Поиск - бинарный по таблице записей без загрузки файла в память.
+ */
+class DiskIndex {
+public:
+    /**
+     * @struct Entry
+     * @brief Запись таблицы индекса.
+     */
+    struct Entry {
+        std::uint64_t keyOffset;    ///< Смещение ключа в блоке символов
+        std::uint32_t keyLength;    ///< Длина ключа
+        std::int32_t recordNumber;  ///< ID контакта
+        std::uint64_t lineOffset;   ///< Смещение строки контакта в CSV-файле
+    };
+
+private:
+    MappedFile file;                ///< Отображённый файл индекса
+    const Entry* entries;           ///< Таблица записей
+    const char* keys;               ///< Блок символов ключей
+    std::uint64_t count;            ///< Количество записей
+    std::uint64_t keysSize;         ///< Размер блока символов
+    IndexKey attribute;             ///< Атрибут индекса
+
+public:
+    /**
+     * @brief Конструктор пустого индекса.
+     */
+    DiskIndex() : entries(nullptr), keys(nullptr), count(0), keysSize(0), attribute(IndexKey::NAME) {}
+
+    /**
+     * @brief Открывает файл индекса и проверяет заголовок.
+     * @param filename Имя файла индекса.
+     * @return true, если индекс открыт.
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * @brief Возвращает количество записей.
+     * @return Количество записей.
+     */
+    std::size_t size() const { return static_cast<std::size_t>(count); }
+
+    /**
+     * @brief Возвращает атрибут индекса.
+     * @return Атрибут.
+     */
+    IndexKey key() const { return attribute; }
+
+    /**
+     * @brief Возвращает ключ записи.
+     * @param position Номер записи.
+     * @return Ключ; пустой, если запись указывает за пределы файла.
+     */
+    std::string_view keyAt(std::size_t position) const;
+
+    /**
+     * @brief Возвращает ID контакта записи.
+     * @param position Номер записи.
+     * @return ID контакта.
+     */
+    int recordNumber(std::size_t position) const { return entries[position].recordNumber; }
+
+    /**
+     * @brief Возвращает смещение строки контакта в CSV-файле.
+     * @param position Номер записи.
+     * @return Смещение в байтах.
+     */
+    std::uint64_t lineOffset(std::size_t position) const { return entries[position].lineOffset; }
+
+    /**
+     * @brief Находит отрезок записей с заданным ключом.
+     * @param key Ключ.
+     * @return Полуинтервал [first, second) номеров записей.
+     */
+    std::pair<std::size_t, std::size_t> equalRange(std::string_view key) const;
+
+    /**
+     * @brief Находит отрезок записей, ключ которых начинается с префикса.
+     * @param prefix Префикс ключа.
+     * @return Полуинтервал [first, second) номеров записей.
+     */
+    std::pair<std::size_t, std::size_t> prefixRange(std::string_view prefix) const;
+
+    /**
+     * @brief Бинарный поиск по ключу.
+     * @param key Ключ для поиска.
+     * @return Вектор ID найденных контактов.
+     */
+    std::vector<int> search(std::string_view key) const;
+};
+
+/**
+ * @class FrontCodedIndex
+ * @brief Сжатый отсортированный индекс на диске с фронтальным кодированием.
+ *
+ * Записи хранятся блоками фиксированной длины. Первый ключ блока записан
+ * целиком, каждый следующий - длиной общего с предыдущим префикса и
+ * остатком; ID и смещения строк - разностями с предыдущей записью в коде
+ * переменной длины. Таблица смещений блоков служит выборкой для бинарного
+ * поиска по первым ключам, поэтому поиск декодирует только блоки, в которых
+ * лежат найденные записи (и, возможно, предыдущий блок).
+ */
+class FrontCodedIndex {
+private:
+    MappedFile file;                ///< Отображённый файл индекса
+    const char* bytes;              ///< Начало файла
+    const std::uint64_t* blocks;    ///< Таблица смещений блоков
+    std::uint64_t blockCount;       ///< Количество блоков
+    std::uint64_t blocksEnd;        ///< Конец области блоков
+    std::uint64_t count;            ///< Количество записей
+    IndexKey attribute;             ///< Атрибут индекса
+
+    /**
+     * @brief Возвращает первый ключ блока без декодирования остальных записей.
+     * @param block Номер блока.
+     * @return Ключ; пустой, если блок повреждён.
+     */
+    std::string_view firstKey(std::size_t block) const;
+
+    /**
+     * @brief Обходит записи, начиная с блока, где может лежать первый ключ
+     * не меньше заданного, пока visit возвращает true.
+     * @param key Нижняя граница ключа.
+     * @param visit Функция (ключ, ID, смещение строки); false прекращает обход.
+     */
+    void scanFrom(std::string_view key,
+                  const std::function<bool(std::string_view, int, std::uint64_t)>& visit) const;
+
+public:
+    /**
+     * @brief Конструктор пустого индекса.
+     */
+    FrontCodedIndex() : bytes(nullptr), blocks(nullptr), blockCount(0), blocksEnd(0), count(0),
+                        attribute(IndexKey::NAME) {}
+
+    /**
+     * @brief Открывает файл индекса и проверяет заголовок и таблицу блоков.
+     * @param filename Имя файла индекса.
+     * @return true, если индекс открыт.
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * @brief Возвращает количество записей.
+     * @return Количество записей.
+     */
+    std::size_t size() const { return static_cast<std::size_t>(count); }
+
+    /**
+     * @brief Возвращает атрибут индекса.
+     * @return Атрибут.
+     */
+    IndexKey key() const { return attribute; }
+
+    /**
+     * @brief Находит записи с ключом, равным заданному или начинающимся с него.
+     * @param key Ключ или префикс.
+     * @param prefix true - поиск по префиксу, false - точное совпадение.
+     * @param visit Функция (ключ, ID, смещение строки в CSV) для каждой записи.
+     * @return Количество найденных записей.
+     */
+    std::size_t find(std::string_view key, bool prefix,
+                     const std::function<void(std::string_view, int, std::uint64_t)>& visit) const;
+
+    /**
+     * @brief Бинарный поиск по ключу.
+     * @param key Ключ для поиска.
+     * @return Вектор ID найденных контактов.
+     */
+    std::vector<int> search(std::string_view key) const;
+};
+
+#endif // EXTERNAL_INDEX_H
@@ -0,0 +1,378 @@
+// generator.cpp
+
+#include "csv_writer.h"
+#include "thread_pool.h"
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+namespace {
+    // Имена и фамилии примерно в порядке частоты: первые выбираются чаще
+    const char* russianMaleNames[] = {
+        "Александр", "Сергей", "Дмитрий", "Андрей", "Алексей", "Максим", "Евгений", "Иван", "Михаил", "Артём",
+        "Николай", "Владимир", "Денис", "Павел", "Роман", "Игорь", "Олег", "Никита", "Кирилл", "Антон",
+        "Юрий", "Илья", "Виктор", "Егор", "Константин", "Вадим", "Григорий", "Тимур", "Фёдор", "Борис"
+    };
+    const char* russianFemaleNames[] = {
+        "Елена", "Ольга", "Наталья", "Екатерина", "Анна", "Татьяна", "Мария", "Ирина", "Светлана", "Юлия",
+        "Анастасия", "Дарья", "Марина", "Людмила", "Валентина", "Галина", "Надежда", "Виктория", "Ксения", "Алина",
+        "Полина", "Софья", "Вера", "Любовь", "Евгения", "Кристина", "Алёна", "Вероника", "Лариса", "Зоя"
+    };
+    const char* russianSurnames[] = {
+        "Иванов", "Смирнов", "Кузнецов", "Попов", "Васильев", "Петров", "Соколов", "Михайлов", "Новиков", "Фёдоров",
+        "Морозов", "Волков", "Алексеев", "Лебедев", "Семёнов", "Егоров", "Павлов", "Козлов", "Степанов", "Николаев",
+        "Орлов", "Андреев", "Макаров", "Никитин", "Захаров", "Зайцев", "Соловьёв", "Борисов", "Яковлев", "Григорьев",
+        "Романов", "Воробьёв", "Сергеев", "Кузьмин", "Фролов", "Александров", "Дмитриев", "Королёв", "Гусев", "Киселёв",
+        "Ильин", "Максимов", "Поляков", "Сорокин", "Виноградов", "Ковалёв", "Белов", "Медведев", "Антонов", "Тарасов",
+        "Жуков", "Баранов", "Филиппов", "Комаров", "Давыдов", "Беляев", "Герасимов", "Богданов", "Осипов", "Сидоров",
+        "Матвеев", "Титов", "Марков", "Миронов", "Крылов", "Куликов", "Карпов", "Власов", "Мельников", "Денисов",
+        "Гаврилов", "Тихонов", "Казаков", "Афанасьев", "Данилов", "Савельев", "Тимофеев", "Фомин", "Чернов", "Абрамов",
+        "Мартынов", "Ефимов", "Федотов", "Щербаков", "Назаров", "Калинин", "Исаев", "Чернышёв", "Быков", "Маслов",
+        "Родионов", "Коновалов", "Лазарев", "Воронин", "Климов", "Филатов", "Пономарёв", "Голубев", "Кудрявцев", "Прохоров",
+        "Островский", "Вишневский", "Ковальский", "Шевченко", "Бондаренко", "Ткаченко", "Ким", "Цой", "Лукашенко", "Гордиенко"
+    };
+    const char* latinFirstNames[] = {
+        "James", "Mary", "John", "Patricia", "Robert", "Jennifer", "Michael", "Linda", "William", "Elizabeth",
+        "David", "Barbara", "Richard", "Susan", "Joseph", "Jessica", "Thomas", "Sarah", "Charles", "Karen",
+        "Daniel", "Anna", "Matthew", "Emma", "Anthony", "Olivia", "Mark", "Sophia", "Paul", "Laura"
+    };
+    const char* latinSurnames[] = {
+        "Smith", "Johnson", "Williams", "Brown", "Jones", "Garcia", "Miller", "Davis", "Rodriguez", "Martinez",
+        "Hernandez", "Lopez", "Gonzalez", "Wilson", "Anderson", "Thomas", "Taylor", "Moore", "Jackson", "Martin",
+        "Lee", "Perez", "Thompson", "White", "Harris", "Sanchez", "Clark", "Ramirez", "Lewis", "Robinson",
+        "Walker", "Young", "Allen", "King", "Wright", "Scott", "Torres", "Nguyen", "Hill", "Flores",
+        "Schmidt", "Muller", "Rossi", "Dubois", "Novak", "Kowalski", "Jensen", "Larsen", "Silva", "Costa"
+    };
+    // Города в порядке убывания населения
+    const char* cityNames[] = {
+        "Москва", "Санкт-Петербург", "Новосибирск", "Екатеринбург", "Казань", "Нижний Новгород", "Красноярск",
+        "Челябинск", "Самара", "Уфа", "Ростов-на-Дону", "Краснодар", "Омск", "Воронеж", "Пермь", "Волгоград",
+        "Саратов", "Тюмень", "Тольятти", "Барнаул", "Ижевск", "Махачкала", "Хабаровск", "Ульяновск", "Иркутск",
+        "Владивосток", "Ярославль", "Севастополь", "Томск", "Ставрополь", "Кемерово", "Набережные Челны",
+        "Оренбург", "Новокузнецк", "Балашиха", "Рязань", "Чебоксары", "Калининград", "Пенза", "Липецк", "Киров",
+        "Астрахань", "Тула", "Сочи", "Курск", "Улан-Удэ", "Тверь", "Магнитогорск", "Брянск", "Иваново", "Якутск",
+        "Владимир", "Белгород", "Сургут", "Архангельск", "Калуга", "Чита", "Смоленск", "Вологда", "Мурманск"
+    };
+
+    /**
+     * @struct Random
+     * @brief Быстрый генератор псевдослучайных чисел SplitMix64.
+     */
+    struct Random {
+        std::uint64_t state;    ///< Состояние генератора
+
+        /**
+         * @brief Возвращает следующее 64-битное число.
+         * @return Случайное число.
+         */
+        std::uint64_t next() {
+            std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+
+        /**
+         * @brief Возвращает равномерное число из [0, 1).
+         * @return Случайное число.
+         */
+        double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+        /**
+         * @brief Возвращает равномерное целое из [0, bound).
+         * @param bound Граница.
+         * @return Случайное число.
+         */
+        std::uint64_t below(std::uint64_t bound) {
+            return static_cast<std::uint64_t>((static_cast<unsigned __int128>(next()) * bound) >> 64);
+        }
+    };
+
+    /**
+     * @class ZipfTable
+     * @brief Выбор ранга из [0, n) с вероятностью, пропорциональной 1/(ранг+1)^s.
+     */
+    class ZipfTable {
+    private:
+        std::vector<double> cumulative;     ///< Накопленные вероятности рангов
+
+    public:
+        /**
+         * @brief Конструктор.
+         * @param n Количество рангов.
+         * @param exponent Показатель s (0 - равномерное распределение).
+         */
+        ZipfTable(std::size_t n, double exponent) : cumulative(n) {
+            double sum = 0;
+            for(std::size_t i = 0; i < n; ++i)
+                cumulative[i] = (sum += 1.0 / std::pow(static_cast<double>(i + 1), exponent));
+            for(double& value : cumulative)
+                value /= sum;
+        }
+
+        /**
+         * @brief Выбирает ранг.
+         * @param random Генератор.
+         * @return Ранг из [0, n).
+         */
+        std::size_t sample(Random& random) const {
+            auto it = std::upper_bound(cumulative.begin(), cumulative.end(), random.uniform());
+            return std::min(static_cast<std::size_t>(it - cumulative.begin()), cumulative.size() - 1);
+        }
+    };
+
+    /**
+     * @brief Возвращает фамилию в женской форме.
+     * @param surname Фамилия в мужской форме.
+     * @return Фамилия в женской форме.
+     */
+    std::string feminineSurname(std::string_view surname) {
+        auto endsWith = [&](std::string_view ending) {
+            return surname.size() >= ending.size() && surname.substr(surname.size() - ending.size()) == ending;
+        };
+        if(endsWith("ский"))
+            return std::string(surname.substr(0, surname.size() - std::string_view("ий").size())) + "ая";
+        if(endsWith("ов") || endsWith("ев") || endsWith("ёв") || endsWith("ин"))
+            return std::string(surname) + "а";
+        return std::string(surname);
+    }
+
+    /**
+     * @struct GeneratorOptions
+     * @brief Параметры генерации.
+     */
+    struct GeneratorOptions {
+        std::uint64_t rows = 1000000;   ///< Количество строк
+        std::uint64_t seed = 1;         ///< Начальное значение генератора
+        std::size_t cities = 60;        ///< Количество городов
+        double zipf = 1.0;              ///< Показатель распределения Ципфа для городов
+        double latin = 0.1;             ///< Доля латинских имён
+        double duplicates = 0.0;        ///< Доля строк, повторяющих имя одной из предыдущих строк
+        long long startId = 1;          ///< ID первой строки
+        std::size_t threads = 0;        ///< Потоков генерации (0 - число аппаратных потоков)
+    };
+
+    /**
+     * @class DatasetGenerator
+     * @brief Генерирует строки CSV независимыми блоками.
+     *
+     * Генератор каждого блока инициализируется номером блока, поэтому
+     * результат не зависит от числа потоков и одинаков при одном seed.
+     */
+    class DatasetGenerator {
+    private:
+        GeneratorOptions options;               ///< Параметры
+        std::vector<std::string> cities;        ///< Названия городов
+        std::vector<std::string> femaleSurnames; ///< Русские фамилии в женской форме
+        ZipfTable cityRanks;                    ///< Распределение городов
+        ZipfTable russianFirstRanks;            ///< Распределение русских имён
+        ZipfTable russianSurnameRanks;          ///< Распределение русских фамилий
+        ZipfTable latinFirstRanks;              ///< Распределение латинских имён
+        ZipfTable latinSurnameRanks;            ///< Распределение латинских фамилий
+
+    public:
+        static constexpr std::uint64_t blockRows = 1 << 16;    ///< Строк в блоке
+        static constexpr std::size_t recentNames = 1024;       ///< Имён блока, доступных для повтора
+
+        /**
+         * @brief Конструктор. Готовит словари и таблицы распределений.
+         * @param options Параметры генерации.
+         */
+        explicit DatasetGenerator(const GeneratorOptions& options)
+            : options(options), cityRanks(options.cities, options.zipf),
+              russianFirstRanks(std::size(russianMaleNames), 0.8),
+              russianSurnameRanks(std::size(russianSurnames), 0.9),
+              latinFirstRanks(std::size(latinFirstNames), 0.8),
+              latinSurnameRanks(std::size(latinSurnames), 0.9) {
+            // Городов больше, чем в списке: остальные получают номер района
+            for(std::size_t i = 0; i < options.cities; ++i) {
+                if(i < std::size(cityNames))
+                    cities.emplace_back(cityNames[i]);
+                else
+                    cities.push_back(std::string(cityNames[i % std::size(cityNames)]) + "-" +
+                                     std::to_string(i / std::size(cityNames)));
+            }
+            for(const char* surname : russianSurnames)
+                femaleSurnames.push_back(feminineSurname(surname));
+        }
+
+        /**
+         * @brief Генерирует блок строк.
+         * @param block Номер блока.
+         * @param out Строка, в которую дописываются строки CSV.
+         */
+        void generate(std::uint64_t block, std::string& out) const {
+            Random random{ options.seed * 0x9E3779B97F4A7C15ull + block };
+            random.next();
+            std::uint64_t first = block * blockRows;
+            std::uint64_t last = std::min(options.rows, first + blockRows);
+            std::vector<std::string> recent;
+            recent.reserve(recentNames);
+            std::string name;
+            char number[24];
+            for(std::uint64_t row = first; row < last; ++row) {
+                auto id = std::to_chars(number, number + sizeof(number), options.startId + static_cast<long long>(row));
+                out.append(number, id.ptr);
+                out.push_back(',');
+
+                // Имя: повтор одного из предыдущих или новое из распределения
+                if(!recent.empty() && random.uniform() < options.duplicates) {
+                    out.append(recent[random.below(recent.size())]);
+                }
+                else {
+                    if(random.uniform() < options.latin) {
+                        name.assign(latinFirstNames[latinFirstRanks.sample(random)]);
+                        name.push_back(' ');
+                        name.append(latinSurnames[latinSurnameRanks.sample(random)]);
+                    }
+                    else {
+                        bool female = random.next() & 1;
+                        std::size_t first = russianFirstRanks.sample(random);
+                        std::size_t surname = russianSurnameRanks.sample(random);
+                        name.assign(female ? russianFemaleNames[first] : russianMaleNames[first]);
+                        name.push_back(' ');
+                        name.append(female ? femaleSurnames[surname] : std::string(russianSurnames[surname]));
+                    }
+                    out.append(name);
+                    if(recent.size() < recentNames)
+                        recent.push_back(name);
+                    else
+                        recent[random.below(recentNames)] = name;
+                }
+                out.push_back(',');
+
+                // Мобильный номер 79XXXXXXXXX
+                std::uint64_t digits = 79000000000ull + random.below(1000000000ull);
+                auto phone = std::to_chars(number, number + sizeof(number), digits);
+                out.append(number, phone.ptr);
+                out.push_back(',');
+                out.append(cities[cityRanks.sample(random)]);
+                out.push_back('\n');
+            }
+        }
+
+        /**
+         * @brief Возвращает количество блоков.
+         * @return Количество блоков.
+         */
+        std::uint64_t blocks() const { return (options.rows + blockRows - 1) / blockRows; }
+    };
+
+    // Запись блока в стандартный вывод
+    bool writeAll(int fd, const std::string& data) {
+        const char* pointer = data.data();
+        std::size_t remaining = data.size();
+        while(remaining > 0) {
+            ssize_t count = ::write(fd, pointer, remaining);
+            if(count <= 0)
+                return false;
+            pointer += count;
+            remaining -= static_cast<std::size_t>(count);
+        }
+        return true;
+    }
+}
+
+/**
+ * @brief Генератор синтетических контактов в формате saveContactsToFile.
+ *
+ * Использование:
+ *   generator <файл|-> [--rows N] [--seed N] [--cities N] [--zipf S]
+ *             [--latin P] [--duplicates P] [--start-id N] [--threads N]
+ * Города распределены по закону Ципфа с показателем S, имена - русские
+ * (с согласованием фамилии по полу) и латинские в доле P; --duplicates
+ * задаёт долю строк, повторяющих имя одной из предыдущих строк блока.
+ * Вместо "-" строки выводятся в стандартный вывод.
+ */
+int main(int argc, char* argv[]) {
+    if(argc < 2) {
+        std::cerr << "Использование: " << argv[0] << " <файл|-> [--rows N] [--seed N] [--cities N] [--zipf S]"
+                  << " [--latin P] [--duplicates P] [--start-id N] [--threads N]\n";
+        return 1;
+    }
+    const std::string filename = argv[1];
+    GeneratorOptions options;
+    for(int i = 2; i + 1 < argc; i += 2) {
+        std::string argument = argv[i];
+        const char* value = argv[i + 1];
+        if(argument == "--rows")
+            options.rows = std::strtoull(value, nullptr, 10);
+        else if(argument == "--seed")
+            options.seed = std::strtoull(value, nullptr, 10);
+        else if(argument == "--cities")
+            options.cities = std::strtoul(value, nullptr, 10);
+        else if(argument == "--zipf")
+            options.zipf = std::strtod(value, nullptr);
+        else if(argument == "--latin")
+            options.latin = std::strtod(value, nullptr);
+        else if(argument == "--duplicates")
+            options.duplicates = std::strtod(value, nullptr);
+        else if(argument == "--start-id")
+            options.startId = std::strtoll(value, nullptr, 10);
+        else if(argument == "--threads")
+            options.threads = std::strtoul(value, nullptr, 10);
+        else {
+            std::cerr << "Неизвестный параметр: " << argument << "\n";
+            return 1;
+        }
+    }
+    if((argc - 2) % 2 != 0) {
+        std::cerr << "Не задано значение параметра " << argv[argc - 1] << "\n";
+        return 1;
+    }
+    if(options.cities == 0 || options.zipf < 0 || options.latin < 0 || options.latin > 1 ||
+       options.duplicates < 0 || options.duplicates > 1 || options.startId < 0 ||
+       options.startId + static_cast<long long>(options.rows) > 2147483648ll) {
+        std::cerr << "Некорректные параметры генерации\n";
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    DatasetGenerator generator(options);
+    ThreadPool pool(options.threads);
+    bool toStdout = filename == "-";
+    CsvWriter writer;
+    if(!toStdout && !writer.open(filename))
+        return 1;
+
+    // Блоки генерируются параллельно группами и записываются по порядку
+    std::uint64_t blocks = generator.blocks();
+    std::size_t group = pool.size() * 2;
+    std::vector<std::string> buffers(group);
+    std::uint64_t bytes = 0;
+    for(std::uint64_t first = 0; first < blocks; first += group) {
+        std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(group, blocks - first));
+        pool.parallelFor(count, [&](std::size_t i) {
+            buffers[i].clear();
+            generator.generate(first + i, buffers[i]);
+        });
+        for(std::size_t i = 0; i < count; ++i) {
+            bytes += buffers[i].size();
+            if(toStdout) {
+                if(!writeAll(STDOUT_FILENO, buffers[i])) {
+                    std::cerr << "Не удалось записать данные в стандартный вывод\n";
+                    return 1;
+                }
+            }
+            else {
+                writer.write(buffers[i]);
+            }
+        }
+    }
+    if(!toStdout && !writer.commit())
+        return 1;
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "Создано строк: " << options.rows << ", байт: " << bytes << ", за " << seconds << " с ("
+              << static_cast<long long>(bytes / seconds / (1 << 20)) << " МБ/с)\n";
+    return 0;
+}
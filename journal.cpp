@@ -0,0 +1,291 @@
+// journal.cpp
+
+#include "journal.h"
+#include "csv_reader.h"
+#include "csv_writer.h"
+#include "contact.h"
+#include "trace.h"
+#include <iostream>
+#include <cstring>
+#include <unordered_set>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const char journalMagic[8] = { 'C', 'O', 'N', 'T', 'J', 'R', 'N', 'L' };
+    constexpr std::uint32_t journalVersion = 1;
+    constexpr std::uint32_t byteOrderMark = 0x01020304;
+    constexpr std::size_t headerSize = 16;
+    constexpr std::size_t recordPrefix = 8; // Длина тела и контрольная сумма
+
+    // Типы записей
+    enum RecordType : std::uint8_t {
+        InsertRecord = 1,
+        UpdateRecord = 2,
+        DeleteRecord = 3
+    };
+
+    // Контрольная сумма FNV-1a
+    std::uint32_t checksum(std::string_view bytes) {
+        std::uint32_t hash = 2166136261u;
+        for(unsigned char c : bytes) {
+            hash ^= c;
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    // Добавление значения в буфер
+    template<typename T>
+    void put(std::string& buffer, T value) {
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    // Последовательное чтение тела записи с проверкой границ
+    struct PayloadReader {
+        std::string_view bytes;
+
+        template<typename T>
+        bool get(T& value) {
+            if(bytes.size() < sizeof(value))
+                return false;
+            std::memcpy(&value, bytes.data(), sizeof(value));
+            bytes.remove_prefix(sizeof(value));
+            return true;
+        }
+
+        bool getString(std::string_view& value) {
+            std::uint32_t length;
+            if(!get(length) || bytes.size() < length)
+                return false;
+            value = bytes.substr(0, length);
+            bytes.remove_prefix(length);
+            return true;
+        }
+    };
+
+    // Запись в файл целиком, начиная с заданного смещения
+    bool writeAll(int fd, const char* data, std::size_t size, std::uint64_t offset) {
+        while(size > 0) {
+            ssize_t written = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+            if(written <= 0)
+                return false;
+            data += written;
+            size -= static_cast<std::size_t>(written);
+            offset += static_cast<std::uint64_t>(written);
+        }
+        return true;
+    }
+}
+
+// Конструктор
+Journal::Journal() : fd(-1), fileBytes(0) {}
+
+// Деструктор
+Journal::~Journal() {
+    commit();
+    if(fd >= 0)
+        ::close(fd);
+}
+
+// Открытие журнала
+bool Journal::open(const std::string& filename) {
+    if(fd >= 0)
+        ::close(fd);
+    path = filename;
+    fd = ::open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+    if(fd < 0) {
+        std::cerr << "Не удалось открыть журнал: " << filename << "\n";
+        return false;
+    }
+    struct stat info;
+    if(::fstat(fd, &info) != 0) {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    fileBytes = static_cast<std::uint64_t>(info.st_size);
+
+    char header[headerSize];
+    if(fileBytes < headerSize) {
+        // Новый или оборванный при создании журнал
+        std::memcpy(header, journalMagic, sizeof(journalMagic));
+        std::memcpy(header + 8, &journalVersion, sizeof(journalVersion));
+        std::memcpy(header + 12, &byteOrderMark, sizeof(byteOrderMark));
+        if(::ftruncate(fd, 0) != 0 || !writeAll(fd, header, headerSize, 0) || !syncDescriptor(fd)) {
+            std::cerr << "Не удалось записать журнал: " << filename << "\n";
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+        fileBytes = headerSize;
+        return true;
+    }
+
+    bool valid = ::pread(fd, header, headerSize, 0) == static_cast<ssize_t>(headerSize) &&
+                 std::memcmp(header, journalMagic, sizeof(journalMagic)) == 0;
+    if(valid) {
+        std::uint32_t version, byteOrder;
+        std::memcpy(&version, header + 8, 4);
+        std::memcpy(&byteOrder, header + 12, 4);
+        valid = version == journalVersion && byteOrder == byteOrderMark;
+    }
+    if(!valid) {
+        std::cerr << "Неподдерживаемый формат журнала: " << filename << "\n";
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    return true;
+}
+
+// Применение журнала
+std::size_t Journal::replay(ContactStore& contacts) {
+    if(fd < 0)
+        return 0;
+    STATS_TIMED(StatOperation::FILE_READ);
+    TRACE_SPAN("Journal::replay");
+    MappedFile file;
+    if(!file.open(path))
+        return 0;
+    std::string_view bytes = file.view();
+
+    // Удаления копятся и выполняются одним проходом по хранилищу
+    std::unordered_set<int> pendingDeletes;
+    auto flushDeletes = [&] {
+        if(pendingDeletes.empty())
+            return;
+        contacts.removeIf([&](const ContactView& c) { return pendingDeletes.count(c.id) > 0; });
+        pendingDeletes.clear();
+    };
+
+    std::size_t applied = 0;
+    std::size_t position = headerSize;
+    while(bytes.size() - position >= recordPrefix) {
+        std::uint32_t length, sum;
+        std::memcpy(&length, bytes.data() + position, 4);
+        std::memcpy(&sum, bytes.data() + position + 4, 4);
+        if(length == 0 || length > bytes.size() - position - recordPrefix)
+            break;
+        std::string_view payload = bytes.substr(position + recordPrefix, length);
+        if(checksum(payload) != sum)
+            break;
+
+        PayloadReader reader{ payload };
+        std::uint8_t type;
+        int id;
+        if(!reader.get(type) || !reader.get(id))
+            break;
+        if(type == DeleteRecord) {
+            pendingDeletes.insert(id);
+        }
+        else if(type == InsertRecord || type == UpdateRecord) {
+            std::uint64_t phoneBits;
+            std::string_view name, city;
+            if(!reader.get(phoneBits) || !reader.getString(name) || !reader.getString(city))
+                break;
+            if(pendingDeletes.count(id))
+                flushDeletes();
+            // Добавление и изменение применяются как "вставить или заменить"
+            PackedPhone phone = PackedPhone::fromBits(phoneBits);
+            std::size_t row = contacts.rowOf(id);
+            if(row == ContactStore::npos) {
+                contacts.push_back(id, name, phone, city);
+            }
+            else {
+                contacts.setName(row, name);
+                contacts.setPhoneNumber(row, phone);
+                contacts.setCity(row, city);
+            }
+            if(id >= global_id_counter)
+                global_id_counter = id + 1;
+        }
+        else {
+            break;
+        }
+        ++applied;
+        position += recordPrefix + length;
+    }
+    flushDeletes();
+
+    // Незавершённая запись после сбоя отбрасывается, новые записи пойдут за последней целой
+    if(position < bytes.size()) {
+        std::cerr << "Журнал " << path << " обрезан до последней целой записи\n";
+        if(::ftruncate(fd, static_cast<off_t>(position)) == 0)
+            fileBytes = position;
+    }
+    return applied;
+}
+
+// Запись с контактом
+void Journal::appendContact(std::uint8_t type, const ContactView& contact) {
+    std::size_t start = buffer.size();
+    buffer.append(recordPrefix, '\0');
+    put(buffer, type);
+    put(buffer, contact.id);
+    put(buffer, contact.phoneNumber.packed());
+    put(buffer, static_cast<std::uint32_t>(contact.name.size()));
+    buffer.append(contact.name);
+    put(buffer, static_cast<std::uint32_t>(contact.city.size()));
+    buffer.append(contact.city);
+    sealRecord(start);
+}
+
+// Завершение записи
+void Journal::sealRecord(std::size_t start) {
+    std::string_view payload(buffer.data() + start + recordPrefix, buffer.size() - start - recordPrefix);
+    std::uint32_t length = static_cast<std::uint32_t>(payload.size());
+    std::uint32_t sum = checksum(payload);
+    std::memcpy(&buffer[start], &length, 4);
+    std::memcpy(&buffer[start + 4], &sum, 4);
+}
+
+// Добавление контакта
+void Journal::logInsert(const ContactView& contact) {
+    appendContact(InsertRecord, contact);
+}
+
+// Изменение контакта
+void Journal::logUpdate(const ContactView& contact) {
+    appendContact(UpdateRecord, contact);
+}
+
+// Удаление контакта
+void Journal::logDelete(int id) {
+    std::size_t start = buffer.size();
+    buffer.append(recordPrefix, '\0');
+    put(buffer, static_cast<std::uint8_t>(DeleteRecord));
+    put(buffer, id);
+    sealRecord(start);
+}
+
+// Запись накопленных изменений на диск
+bool Journal::commit() {
+    if(buffer.empty())
+        return true;
+    if(fd < 0) {
+        buffer.clear();
+        return false;
+    }
+    STATS_TIMED(StatOperation::FILE_WRITE);
+    // Одна запись и одна синхронизация на весь пакет
+    if(!writeAll(fd, buffer.data(), buffer.size(), fileBytes) || !syncDescriptor(fd)) {
+        std::cerr << "Не удалось записать журнал: " << path << "\n";
+        return false;
+    }
+    fileBytes += buffer.size();
+    buffer.clear();
+    return true;
+}
+
+// Очистка журнала
+bool Journal::reset() {
+    buffer.clear();
+    if(fd < 0)
+        return false;
+    if(::ftruncate(fd, static_cast<off_t>(headerSize)) != 0 || !syncDescriptor(fd))
+        return false;
+    fileBytes = headerSize;
+    return true;
+}
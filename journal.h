@@ -0,0 +1,110 @@
+// journal.h
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "contact_store.h"
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @class Journal
+ * @brief Журнал изменений контактов, дописываемый в конец файла (write-ahead log).
+ *
+ * Каждое добавление, изменение и удаление записывается компактной двоичной
+ * записью: длина, контрольная сумма FNV-1a и тело с ID и значениями полей.
+ * Записи копятся в буфере и сбрасываются на диск одним write и одним fsync
+ * при commit, поэтому пакетное удаление стоит одной синхронизации. При
+ * запуске журнал применяется поверх последнего снимка; обрезанная при сбое
+ * последняя запись отбрасывается. Применение идемпотентно, так что журнал,
+ * уже вошедший в снимок, можно применить повторно.
+ */
+class Journal {
+private:
+    std::string path;           ///< Имя файла журнала
+    int fd;                     ///< Дескриптор файла журнала (-1, если закрыт)
+    std::string buffer;         ///< Записи, ещё не переданные в файл
+    std::uint64_t fileBytes;    ///< Размер файла журнала
+
+    /**
+     * @brief Добавляет в буфер запись с контактом.
+     * @param type Тип записи.
+     * @param contact Контакт.
+     */
+    void appendContact(std::uint8_t type, const ContactView& contact);
+
+    /**
+     * @brief Завершает запись: дописывает длину и контрольную сумму тела.
+     * @param start Смещение начала записи в буфере.
+     */
+    void sealRecord(std::size_t start);
+
+public:
+    /**
+     * @brief Конструктор закрытого журнала.
+     */
+    Journal();
+
+    /**
+     * @brief Деструктор. Сбрасывает буфер и закрывает файл.
+     */
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    /**
+     * @brief Открывает журнал, создавая файл с заголовком при необходимости.
+     * @param filename Имя файла журнала.
+     * @return true, если журнал открыт.
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * @brief Применяет записи журнала к хранилищу.
+     * Повреждённый хвост файла (незавершённая запись) обрезается.
+     * global_id_counter становится больше наибольшего добавленного ID.
+     * @param contacts Хранилище контактов.
+     * @return Количество применённых записей.
+     */
+    std::size_t replay(ContactStore& contacts);
+
+    /**
+     * @brief Записывает добавление контакта.
+     * @param contact Добавленный контакт.
+     */
+    void logInsert(const ContactView& contact);
+
+    /**
+     * @brief Записывает новые значения полей контакта.
+     * @param contact Изменённый контакт.
+     */
+    void logUpdate(const ContactView& contact);
+
+    /**
+     * @brief Записывает удаление контакта.
+     * @param id ID удалённого контакта.
+     */
+    void logDelete(int id);
+
+    /**
+     * @brief Передаёт накопленные записи в файл и синхронизирует его с диском.
+     * @return true, если записи сохранены.
+     */
+    bool commit();
+
+    /**
+     * @brief Очищает журнал после записи снимка, оставляя только заголовок.
+     * @return true, если журнал очищен.
+     */
+    bool reset();
+
+    /**
+     * @brief Возвращает размер журнала вместе с ещё не записанными данными.
+     * @return Размер в байтах.
+     */
+    std::uint64_t size() const { return fileBytes + buffer.size(); }
+};
+
+#endif // JOURNAL_H
@@ -1,13 +1,19 @@
 // linked_list.cpp
 
 #include "linked_list.h"
+#include "csv_reader.h"
+#include "csv_writer.h"
+#include "trace.h"
 #include <iostream>
 #include <algorithm>
 
 // Конструктор
-LinkedList::LinkedList(PrimarySortAttribute primaryAttr, SecondarySortAttribute secondaryAttr,
+LinkedList::LinkedList(ContactStore& store, PrimarySortAttribute primaryAttr, SecondarySortAttribute secondaryAttr,
                        SortOrder primaryOrd, SortOrder secondaryOrd)
-    : head(nullptr),
+    : store(&store),
+      head(nullptr),
+      firstInserted(nullptr),
+      lastInserted(nullptr),
       primaryAttribute(primaryAttr),
       secondaryAttribute(secondaryAttr),
       primaryOrder(primaryOrd),
@@ -15,16 +21,36 @@ LinkedList::LinkedList(PrimarySortAttribute primaryAttr, SecondarySortAttribute
 
 // Перемещающий конструктор
 LinkedList::LinkedList(LinkedList&& other) noexcept
-    : head(std::move(other.head)),
+    : store(other.store),
+      head(std::move(other.head)),
+      nodes(std::move(other.nodes)),
+      nameIndex(std::move(other.nameIndex)),
+      cityIndex(std::move(other.cityIndex)),
+      firstInserted(other.firstInserted),
+      lastInserted(other.lastInserted),
       primaryAttribute(other.primaryAttribute),
       secondaryAttribute(other.secondaryAttribute),
       primaryOrder(other.primaryOrder),
-      secondaryOrder(other.secondaryOrder) {}
+      secondaryOrder(other.secondaryOrder) {
+    other.firstInserted = nullptr;
+    other.lastInserted = nullptr;
+}
 
 // Перемещающий оператор присваивания
 LinkedList& LinkedList::operator=(LinkedList&& other) noexcept {
     if(this != &other) {
+        // Итеративное освобождение, чтобы не переполнить стек на длинных списках
+        while(head)
+            head = std::move(head->next);
+        store = other.store;
         head = std::move(other.head);
+        nodes = std::move(other.nodes);
+        nameIndex = std::move(other.nameIndex);
+        cityIndex = std::move(other.cityIndex);
+        firstInserted = other.firstInserted;
+        lastInserted = other.lastInserted;
+        other.firstInserted = nullptr;
+        other.lastInserted = nullptr;
         primaryAttribute = other.primaryAttribute;
         secondaryAttribute = other.secondaryAttribute;
         primaryOrder = other.primaryOrder;
@@ -35,121 +61,484 @@ LinkedList& LinkedList::operator=(LinkedList&& other) noexcept {
 
 // Деструктор
 LinkedList::~LinkedList() {
-    // Умные указатели автоматически освобождают память
+    // Итеративное освобождение, чтобы не переполнить стек на длинных списках
+    while(head)
+        head = std::move(head->next);
 }
 
-// Функция сравнения для сортировки
-bool LinkedList::compare(const Contact& a, const Contact& b) const {
-    // Сравнение по первичному атрибуту
-    bool primaryComparison;
-    if(primaryAttribute == PrimarySortAttribute::NAME) {
-        if(primaryOrder == SortOrder::ASCENDING)
-            primaryComparison = a.name < b.name;
-        else
-            primaryComparison = a.name > b.name;
-    }
-    else { // CITY
-        if(primaryOrder == SortOrder::ASCENDING)
-            primaryComparison = a.city < b.city;
-        else
-            primaryComparison = a.city > b.city;
+// Упаковка префикса ключа в число
+std::uint64_t LinkedList::keyPrefix(std::string_view key) {
+    std::uint64_t prefix = 0;
+    for(size_t i = 0; i < 8; ++i) {
+        prefix <<= 8;
+        if(i < key.size())
+            prefix |= static_cast<unsigned char>(key[i]);
     }
+    return prefix;
+}
+
+// Кэширование префиксов ключей узла
+void LinkedList::cachePrefixes(ListNode& node, const ContactView& contact) {
+    node.namePrefix = keyPrefix(contact.name);
+    node.cityPrefix = keyPrefix(contact.city);
+}
+
+// Получение строки хранилища по узлу
+std::size_t LinkedList::resolve(const ListNode& node) const {
+    return store->rowOf(node.id);
+}
+
+// Функция сравнения для сортировки
+bool LinkedList::compare(const ListNode& a, const ListNode& b) const {
+    std::size_t rowA = ContactStore::npos;
+    std::size_t rowB = ContactStore::npos;
+    bool resolved = false;
 
-    if(primaryComparison)
-        return true;
-    else if(!primaryComparison) {
-        // Сравнение по второстепенному атрибуту, если первичные атрибуты равны
-        if(secondaryAttribute == SecondarySortAttribute::NAME) {
-            if(secondaryOrder == SortOrder::ASCENDING)
-                return a.name < b.name;
-            else
-                return a.name > b.name;
+    // Сравнение по одному атрибуту: <0, 0 или >0 с учётом порядка сортировки
+    auto compareBy = [&](bool byName, SortOrder order) {
+        std::uint64_t prefixA = byName ? a.namePrefix : a.cityPrefix;
+        std::uint64_t prefixB = byName ? b.namePrefix : b.cityPrefix;
+        int result;
+        if(prefixA != prefixB) {
+            result = prefixA < prefixB ? -1 : 1;
         }
-        else { // CITY
-            if(secondaryOrder == SortOrder::ASCENDING)
-                return a.city < b.city;
-            else
-                return a.city > b.city;
+        else {
+            // Префиксы совпали - сравниваем полные строки из хранилища
+            if(!resolved) {
+                rowA = resolve(a);
+                rowB = resolve(b);
+                resolved = true;
+            }
+            if(rowA == ContactStore::npos || rowB == ContactStore::npos) {
+                // Узел удалённого из хранилища контакта больше найденных узлов с тем же
+                // префиксом, а между такими узлами порядок задаёт ID: равенство с любым
+                // узлом нарушило бы транзитивность сравнения
+                if(rowA != ContactStore::npos)
+                    result = -1;
+                else if(rowB != ContactStore::npos)
+                    result = 1;
+                else
+                    result = a.id < b.id ? -1 : (a.id > b.id ? 1 : 0);
+            }
+            else if(byName) {
+                result = store->name(rowA).compare(store->name(rowB));
+            }
+            else {
+                // Города сравниваются по рангам в отсортированном словаре
+                const std::vector<std::uint32_t>& ranks = store->cityRanks();
+                std::uint32_t rankA = ranks[store->cityCode(rowA)];
+                std::uint32_t rankB = ranks[store->cityCode(rowB)];
+                result = rankA < rankB ? -1 : (rankA > rankB ? 1 : 0);
+            }
         }
-    }
-    return false;
+        return order == SortOrder::ASCENDING ? result : -result;
+    };
+
+    // Сравнение по первичному атрибуту
+    int primaryComparison = compareBy(primaryAttribute == PrimarySortAttribute::NAME, primaryOrder);
+    if(primaryComparison != 0)
+        return primaryComparison < 0;
+
+    // Сравнение по второстепенному атрибуту, если первичные атрибуты равны
+    return compareBy(secondaryAttribute == SecondarySortAttribute::NAME, secondaryOrder) < 0;
 }
 
-// Вставка в список с сортировкой
-void LinkedList::insert(const Contact& contact) {
-    // Создание нового узла
-    std::unique_ptr<ListNode> newNode = std::make_unique<ListNode>(contact);
-    
+// Вставка узла в отсортированную позицию
+void LinkedList::link(std::unique_ptr<ListNode> node) {
     // Если список пуст или новый элемент должен быть первым
-    if(!head || compare(contact, head->contact)) {
-        newNode->next = std::move(head);
-        head = std::move(newNode);
+    if(!head || compare(*node, *head)) {
+        node->prev = nullptr;
+        if(head)
+            head->prev = node.get();
+        node->next = std::move(head);
+        head = std::move(node);
         return;
     }
 
     // Поиск позиции для вставки
     ListNode* current = head.get();
-    while(current->next && !compare(contact, current->next->contact)) {
+    while(current->next && !compare(*node, *current->next)) {
         current = current->next.get();
     }
 
     // Вставка после текущего узла
-    newNode->next = std::move(current->next);
-    current->next = std::move(newNode);
+    node->prev = current;
+    if(current->next)
+        current->next->prev = node.get();
+    node->next = std::move(current->next);
+    current->next = std::move(node);
+}
+
+// Извлечение узла из списка
+std::unique_ptr<ListNode> LinkedList::unlink(ListNode* node) {
+    std::unique_ptr<ListNode>& owner = node->prev ? node->prev->next : head;
+    std::unique_ptr<ListNode> taken = std::move(owner);
+    owner = std::move(taken->next);
+    if(owner)
+        owner->prev = taken->prev;
+    taken->prev = nullptr;
+    return taken;
+}
+
+// Добавление узла в хэш-индексы
+void LinkedList::indexNode(ListNode& node, const ContactView& contact) {
+    auto nameIt = nameIndex.try_emplace(std::string(contact.name)).first;
+    node.namePosition = nameIt->second.size();
+    nameIt->second.push_back(&node);
+    node.nameBucket = &*nameIt;
+
+    auto cityIt = cityIndex.try_emplace(std::string(contact.city)).first;
+    node.cityPosition = cityIt->second.size();
+    cityIt->second.push_back(&node);
+    node.cityBucket = &*cityIt;
+}
+
+// Удаление узла из хэш-индексов
+void LinkedList::unindexNode(ListNode& node) {
+    // Последний узел элемента переносится на место удаляемого: O(1) при любом размере элемента
+    auto detach = [&node](KeyIndex& index, KeyBucket*& bucket, std::size_t ListNode::*position) {
+        if(!bucket)
+            return;
+        std::vector<ListNode*>& bucketNodes = bucket->second;
+        ListNode* moved = bucketNodes.back();
+        bucketNodes[node.*position] = moved;
+        moved->*position = node.*position;
+        bucketNodes.pop_back();
+        if(bucketNodes.empty())
+            index.erase(bucket->first);
+        bucket = nullptr;
+    };
+    detach(nameIndex, node.nameBucket, &ListNode::namePosition);
+    detach(cityIndex, node.cityBucket, &ListNode::cityPosition);
+}
+
+// Исключение узла из цепочки порядка вставки
+void LinkedList::unthread(ListNode& node) {
+    if(node.insertedPrev)
+        node.insertedPrev->insertedNext = node.insertedNext;
+    else
+        firstInserted = node.insertedNext;
+    if(node.insertedNext)
+        node.insertedNext->insertedPrev = node.insertedPrev;
+    else
+        lastInserted = node.insertedPrev;
+    node.insertedPrev = nullptr;
+    node.insertedNext = nullptr;
+}
+
+// Полное удаление узла
+void LinkedList::destroy(ListNode* node) {
+    unindexNode(*node);
+    unthread(*node);
+    nodes.erase(node->id);
+    unlink(node);
+}
+
+// Вставка в список с сортировкой
+bool LinkedList::insert(int id) {
+    if(nodes.count(id))
+        return false;
+    std::size_t row = store->rowOf(id);
+    if(row == ContactStore::npos)
+        return false;
+
+    // Создание нового узла
+    ContactView contact = (*store)[row];
+    std::unique_ptr<ListNode> newNode = std::make_unique<ListNode>(id);
+    cachePrefixes(*newNode, contact);
+    indexNode(*newNode, contact);
+
+    // Добавление в конец цепочки порядка вставки
+    newNode->insertedPrev = lastInserted;
+    if(lastInserted)
+        lastInserted->insertedNext = newNode.get();
+    else
+        firstInserted = newNode.get();
+    lastInserted = newNode.get();
+
+    nodes[id] = newNode.get();
+    link(std::move(newNode));
+    return true;
+}
+
+// Пакетная вставка контактов
+size_t LinkedList::insertAll(const std::vector<int>& ids) {
+    TRACE_SPAN("LinkedList::insertAll");
+    std::vector<std::unique_ptr<ListNode>> detached;
+    detached.reserve(nodes.size() + ids.size());
+    detachAll(detached);
+
+    size_t inserted = 0;
+    for(int id : ids) {
+        std::size_t row = store->rowOf(id);
+        if(row == ContactStore::npos || nodes.count(id))
+            continue;
+        ContactView contact = (*store)[row];
+        std::unique_ptr<ListNode> newNode = std::make_unique<ListNode>(id);
+        cachePrefixes(*newNode, contact);
+        indexNode(*newNode, contact);
+
+        newNode->insertedPrev = lastInserted;
+        if(lastInserted)
+            lastInserted->insertedNext = newNode.get();
+        else
+            firstInserted = newNode.get();
+        lastInserted = newNode.get();
+
+        nodes[id] = newNode.get();
+        detached.push_back(std::move(newNode));
+        ++inserted;
+    }
+
+    // Новые узлы идут после существующих: устойчивая сортировка ставит их
+    // после равных, как и последовательная вставка
+    relinkSorted(detached);
+    return inserted;
+}
+
+// Перестановка узла после редактирования контакта
+void LinkedList::update(int id) {
+    auto it = nodes.find(id);
+    if(it == nodes.end())
+        return;
+    std::size_t row = store->rowOf(id);
+    if(row == ContactStore::npos) {
+        // Контакт удалён из хранилища - удаляем и узел
+        destroy(it->second);
+        return;
+    }
+    // Порядок вставки сохраняется, меняются только позиция и индексы
+    unindexNode(*it->second);
+    std::unique_ptr<ListNode> node = unlink(it->second);
+    ContactView contact = (*store)[row];
+    cachePrefixes(*node, contact);
+    indexNode(*node, contact);
+    link(std::move(node));
+}
+
+// Перестановка узлов после пакетного изменения контактов
+void LinkedList::updateAll(const std::vector<int>& ids) {
+    TRACE_SPAN("LinkedList::updateAll");
+    for(int id : ids) {
+        auto it = nodes.find(id);
+        if(it == nodes.end())
+            continue;
+        std::size_t row = store->rowOf(id);
+        if(row == ContactStore::npos) {
+            destroy(it->second);
+            continue;
+        }
+        ContactView contact = (*store)[row];
+        unindexNode(*it->second);
+        cachePrefixes(*it->second, contact);
+        indexNode(*it->second, contact);
+    }
+    std::vector<std::unique_ptr<ListNode>> detached;
+    detached.reserve(nodes.size());
+    detachAll(detached);
+    relinkSorted(detached);
+}
+
+// Удаление узла по ID контакта
+void LinkedList::erase(int id) {
+    auto it = nodes.find(id);
+    if(it == nodes.end())
+        return;
+    destroy(it->second);
+}
+
+// Пакетное удаление по предикату
+size_t LinkedList::removeIf(const std::function<bool(const ContactView&)>& predicate) {
+    std::unordered_set<int> ids;
+    for(const ListNode* current = head.get(); current; current = current->next.get()) {
+        std::size_t row = resolve(*current);
+        if(row != ContactStore::npos && predicate((*store)[row]))
+            ids.insert(current->id);
+    }
+    return removeIds(ids);
+}
+
+// Пакетное удаление по набору ID
+size_t LinkedList::removeIds(const std::unordered_set<int>& ids) {
+    if(ids.empty() || !head)
+        return 0;
+    TRACE_SPAN("LinkedList::removeIds");
+
+    // Небольшой набор: удаление поштучно через таблицу узлов
+    if(ids.size() * 8 < nodes.size()) {
+        size_t removed = 0;
+        for(int id : ids) {
+            auto it = nodes.find(id);
+            if(it != nodes.end()) {
+                destroy(it->second);
+                ++removed;
+            }
+        }
+        return removed;
+    }
+
+    // Большой набор: один проход по каждому хэш-индексу ...
+    auto isRemoved = [&ids](const ListNode* node) { return ids.count(node->id) > 0; };
+    for(auto indexPosition : { std::make_pair(&nameIndex, &ListNode::namePosition),
+                               std::make_pair(&cityIndex, &ListNode::cityPosition) }) {
+        KeyIndex* index = indexPosition.first;
+        for(auto it = index->begin(); it != index->end(); ) {
+            std::vector<ListNode*>& bucketNodes = it->second;
+            bucketNodes.erase(std::remove_if(bucketNodes.begin(), bucketNodes.end(), isRemoved), bucketNodes.end());
+            if(bucketNodes.empty()) {
+                it = index->erase(it);
+                continue;
+            }
+            // Оставшиеся узлы сдвинулись: позиции пересчитываются
+            for(std::size_t i = 0; i < bucketNodes.size(); ++i)
+                bucketNodes[i]->*indexPosition.second = i;
+            ++it;
+        }
+    }
+
+    // ... и один проход по списку
+    size_t removed = 0;
+    ListNode* current = head.get();
+    while(current) {
+        ListNode* next = current->next.get();
+        if(isRemoved(current)) {
+            unthread(*current);
+            nodes.erase(current->id);
+            unlink(current);
+            ++removed;
+        }
+        current = next;
+    }
+    return removed;
+}
+
+// Сбор узлов с заданным значением атрибута
+std::vector<const ListNode*> LinkedList::collect(bool byName, const std::string& key) const {
+    std::vector<const ListNode*> result;
+    const KeyIndex& index = byName ? nameIndex : cityIndex;
+    auto it = index.find(key);
+    if(it == index.end())
+        return result;
+
+    const KeyBucket* bucket = &*it;
+    auto bucketOf = [byName](const ListNode* node) -> const KeyBucket* {
+        return byName ? node->nameBucket : node->cityBucket;
+    };
+
+    bool isPrimary = (primaryAttribute == PrimarySortAttribute::NAME) == byName;
+    if(isPrimary) {
+        // Узлы с равным основным ключом расположены подряд: идём к началу группы
+        const ListNode* first = bucket->second.front();
+        while(first->prev && bucketOf(first->prev) == bucket)
+            first = first->prev;
+        for(const ListNode* node = first; node && bucketOf(node) == bucket; node = node->next.get())
+            result.push_back(node);
+    }
+    else {
+        // Узлы второстепенного ключа разбросаны по списку: сортируем только их
+        result.assign(bucket->second.begin(), bucket->second.end());
+        std::sort(result.begin(), result.end(),
+                  [this](const ListNode* a, const ListNode* b) { return compare(*a, *b); });
+    }
+    return result;
+}
+
+// Вывод контакта узла
+bool LinkedList::printNode(const ListNode& node, ReportWriter& report) const {
+    return report.write(*store, node.id);
 }
 
 // Вывод списка в порядке сортировки
 void LinkedList::printSorted() const {
+    ReportWriter report(std::cout);
+    printSorted(report);
+}
+
+// Вывод списка в порядке сортировки через общий вывод
+void LinkedList::printSorted(ReportWriter& report) const {
     if(!head) {
-        std::cout << "Линейный список пуст.\n";
+        report.heading("Линейный список пуст.\n");
         return;
     }
-    ListNode* current = head.get();
-    while(current) {
-        std::cout << "ID: " << current->contact.id << "\n"
-                  << "Имя: " << current->contact.name << "\n"
-                  << "Номер телефона: " << current->contact.phoneNumber << "\n"
-                  << "Город: " << current->contact.city << "\n"
-                  << "-----------------------------\n";
-        current = current->next.get();
+    for(const ListNode* current = head.get(); current; current = current->next.get()) {
+        if(!printNode(*current, report))
+            break;
     }
 }
 
-// Вывод списка в порядке ввода (не реализовано)
+// Вывод списка в порядке ввода
 void LinkedList::printInsertionOrder() const {
-    // Для сохранения порядка вставки требуется дополнительная структура данных.
-    // В текущей реализации список уже отсортирован, поэтому функция не реализована.
-    std::cout << "Функция вывода в порядке ввода не реализована.\n";
+    ReportWriter report(std::cout);
+    printInsertionOrder(report);
+}
+
+// Вывод списка в порядке ввода через общий вывод
+void LinkedList::printInsertionOrder(ReportWriter& report) const {
+    if(!firstInserted) {
+        report.heading("Линейный список пуст.\n");
+        return;
+    }
+    for(const ListNode* current = firstInserted; current; current = current->insertedNext) {
+        if(!printNode(*current, report))
+            break;
+    }
 }
 
-// Поиск по атрибуту
+// ID контактов в порядке ввода
+std::vector<int> LinkedList::insertionOrderIds() const {
+    std::vector<int> ids;
+    ids.reserve(nodes.size());
+    for(const ListNode* current = firstInserted; current; current = current->insertedNext) {
+        ids.push_back(current->id);
+    }
+    return ids;
+}
+
+// Поиск по основному атрибуту
 void LinkedList::search(const std::string& key) const {
-    bool found = false;
-    ListNode* current = head.get();
-    while(current) {
-        if(primaryAttribute == PrimarySortAttribute::NAME && current->contact.name == key) {
-            std::cout << "ID: " << current->contact.id << "\n"
-                      << "Имя: " << current->contact.name << "\n"
-                      << "Номер телефона: " << current->contact.phoneNumber << "\n"
-                      << "Город: " << current->contact.city << "\n"
-                      << "-----------------------------\n";
-            found = true;
-        }
-        else if(primaryAttribute == PrimarySortAttribute::CITY && current->contact.city == key) {
-            std::cout << "ID: " << current->contact.id << "\n"
-                      << "Имя: " << current->contact.name << "\n"
-                      << "Номер телефона: " << current->contact.phoneNumber << "\n"
-                      << "Город: " << current->contact.city << "\n"
-                      << "-----------------------------\n";
-            found = true;
-        }
-        current = current->next.get();
+    ReportWriter report(std::cout);
+    search(key, report);
+}
+
+// Поиск по основному атрибуту через общий вывод
+void LinkedList::search(const std::string& key, ReportWriter& report) const {
+    bool byName = primaryAttribute == PrimarySortAttribute::NAME;
+    std::vector<const ListNode*> found = collect(byName, key);
+    for(const ListNode* node : found) {
+        if(!printNode(*node, report))
+            break;
     }
-    if(!found) {
-        std::cout << "Контакт с " 
-                  << (primaryAttribute == PrimarySortAttribute::NAME ? "именем" : "городом") 
-                  << " \"" << key << "\" не найден.\n";
+    if(found.empty())
+        report.heading("Контакт с " + std::string(byName ? "именем" : "городом") + " \"" + key + "\" не найден.\n");
+}
+
+// Поиск по второстепенному атрибуту
+void LinkedList::searchSecondary(const std::string& key) const {
+    ReportWriter report(std::cout);
+    searchSecondary(key, report);
+}
+
+// Поиск по второстепенному атрибуту через общий вывод
+void LinkedList::searchSecondary(const std::string& key, ReportWriter& report) const {
+    bool byName = secondaryAttribute == SecondarySortAttribute::NAME;
+    std::vector<const ListNode*> found = collect(byName, key);
+    for(const ListNode* node : found) {
+        if(!printNode(*node, report))
+            break;
+    }
+    if(found.empty())
+        report.heading("Контакт с " + std::string(byName ? "именем" : "городом") + " \"" + key + "\" не найден.\n");
+}
+
+// ID контактов с заданным значением атрибута
+std::vector<int> LinkedList::searchIds(const std::string& key, bool secondary) const {
+    bool byName = secondary ? secondaryAttribute == SecondarySortAttribute::NAME
+                            : primaryAttribute == PrimarySortAttribute::NAME;
+    std::vector<int> ids;
+    for(const ListNode* node : collect(byName, key)) {
+        ids.push_back(node->id);
     }
+    return ids;
 }
 
 // Удаление по атрибуту
@@ -159,26 +548,14 @@ void LinkedList::remove(const std::string& key) {
         return;
     }
 
-    // Если первый элемент нужно удалить
-    if((primaryAttribute == PrimarySortAttribute::NAME && head->contact.name == key) ||
-       (primaryAttribute == PrimarySortAttribute::CITY && head->contact.city == key)) {
-        head = std::move(head->next);
+    // Поиск элемента для удаления через хэш-индекс (первый в порядке сортировки)
+    std::vector<const ListNode*> found = collect(primaryAttribute == PrimarySortAttribute::NAME, key);
+    if(!found.empty()) {
+        destroy(nodes.at(found.front()->id));
         std::cout << "Контакт успешно удален.\n";
         return;
     }
 
-    // Поиск элемента для удаления
-    ListNode* current = head.get();
-    while(current->next) {
-        if((primaryAttribute == PrimarySortAttribute::NAME && current->next->contact.name == key) ||
-           (primaryAttribute == PrimarySortAttribute::CITY && current->next->contact.city == key)) {
-            current->next = std::move(current->next->next);
-            std::cout << "Контакт успешно удален.\n";
-            return;
-        }
-        current = current->next.get();
-    }
-
     std::cout << "Контакт с " 
               << (primaryAttribute == PrimarySortAttribute::NAME ? "именем" : "городом") 
               << " \"" << key << "\" не найден.\n";
@@ -187,79 +564,115 @@ void LinkedList::remove(const std::string& key) {
 // Изменение атрибутов сортировки
 void LinkedList::changeSortAttributes(PrimarySortAttribute primaryAttr, SecondarySortAttribute secondaryAttr,
                                       SortOrder primaryOrd, SortOrder secondaryOrd) {
+    TRACE_SPAN("LinkedList::changeSortAttributes");
     primaryAttribute = primaryAttr;
     secondaryAttribute = secondaryAttr;
     primaryOrder = primaryOrd;
     secondaryOrder = secondaryOrd;
 
-    // Пересортировка списка
-    std::vector<Contact> contactList;
-    ListNode* current = head.get();
-    while(current) {
-        contactList.push_back(current->contact);
-        current = current->next.get();
+    // Пересортировка узлов за O(n log n) вместо повторных вставок
+    std::vector<std::unique_ptr<ListNode>> detached;
+    detached.reserve(nodes.size());
+    detachAll(detached);
+    relinkSorted(detached);
+}
+
+// Извлечение всех узлов из списка
+void LinkedList::detachAll(std::vector<std::unique_ptr<ListNode>>& detached) {
+    while(head) {
+        std::unique_ptr<ListNode> next = std::move(head->next);
+        detached.push_back(std::move(head));
+        head = std::move(next);
     }
+}
 
-    // Очистка списка
-    head.reset();
+// Сортировка узлов и сборка списка
+void LinkedList::relinkSorted(std::vector<std::unique_ptr<ListNode>>& detached) {
+    std::stable_sort(detached.begin(), detached.end(),
+                     [this](const std::unique_ptr<ListNode>& a, const std::unique_ptr<ListNode>& b) {
+                         return compare(*a, *b);
+                     });
 
-    // Вставка заново с новым порядком сортировки
-    for(const auto& contact : contactList) {
-        insert(contact);
+    // Сборка списка с конца
+    for(auto it = detached.rbegin(); it != detached.rend(); ++it) {
+        std::unique_ptr<ListNode> node = std::move(*it);
+        node->prev = nullptr;
+        if(head)
+            head->prev = node.get();
+        node->next = std::move(head);
+        head = std::move(node);
     }
 }
 
 // Сохранение списка в файл
 void LinkedList::saveToFile(const std::string& filename) const {
-    std::ofstream outFile(filename);
-    if(!outFile) {
-        std::cerr << "Не удалось открыть файл для записи: " << filename << "\n";
+    CsvWriter writer;
+    if(!writer.open(filename))
         return;
-    }
     ListNode* current = head.get();
     while(current) {
-        outFile << current->contact.id << "," 
-                << current->contact.name << "," 
-                << current->contact.phoneNumber << "," 
-                << current->contact.city << "\n";
+        std::size_t row = resolve(*current);
+        if(row != ContactStore::npos)
+            writer.writeContact((*store)[row]);
         current = current->next.get();
     }
-    outFile.close();
+    if(!writer.commit())
+        return;
     std::cout << "Линейный список успешно сохранён в файл " << filename << "\n";
 }
 
 // Загрузка списка из файла
-void LinkedList::loadFromFile(const std::string& filename) {
-    std::ifstream inFile(filename);
-    if(!inFile) {
+std::size_t LinkedList::loadFromFile(const std::string& filename) {
+    MappedFile file;
+    if(!file.open(filename)) {
         std::cerr << "Не удалось открыть файл для чтения: " << filename << "\n";
-        return;
+        return 0;
     }
 
-    std::string line;
-    while(std::getline(inFile, line)) {
-        Contact contact;
-        size_t pos1 = line.find(',');
-        size_t pos2 = line.find(',', pos1 + 1);
-        size_t pos3 = line.find(',', pos2 + 1);
+    std::size_t rejected = 0;
+    parseContactsCsv(file.view(),
+        [&](const CsvRecord& record) {
+            PackedPhone phone;
+            if(!PackedPhone::parse(record.phoneNumber, phone)) {
+                std::cerr << "Некорректный номер телефона в строке: " << record.line << "\n";
+                ++rejected;
+                return;
+            }
 
-        if(pos1 == std::string::npos || pos2 == std::string::npos || pos3 == std::string::npos) {
-            std::cerr << "Некорректный формат строки: " << line << "\n";
-            continue;
-        }
-
-        contact.id = std::stoi(line.substr(0, pos1));
-        contact.name = line.substr(pos1 + 1, pos2 - pos1 - 1);
-        contact.phoneNumber = line.substr(pos2 + 1, pos3 - pos2 - 1);
-        contact.city = line.substr(pos3 + 1);
+            // Обновление глобального счётчика, если необходимо
+            if(record.id >= global_id_counter)
+                global_id_counter = record.id + 1;
 
-        // Обновление глобального счётчика, если необходимо
-        if(contact.id >= global_id_counter)
-            global_id_counter = contact.id + 1;
+            // Контакт, которого ещё нет, добавляется в хранилище (строки упорядочены по ID)
+            if(store->rowOf(record.id) == ContactStore::npos)
+                store->push_back(record.id, record.name, phone, record.city);
 
-        insert(contact);
-    }
+            // Узел вставляется в позицию по атрибутам сортировки списка
+            insert(record.id);
+        },
+        [&](std::string_view line) {
+            std::cerr << "Некорректный формат строки: " << line << "\n";
+            ++rejected;
+        });
 
-    inFile.close();
     std::cout << "Линейный список успешно загружен из файла " << filename << "\n";
+    if(rejected > 0)
+        std::cerr << "Пропущено некорректных строк файла " << filename << ": " << rejected << "\n";
+    return rejected;
+}
+
+// Объём памяти списка
+MemoryUsage LinkedList::memoryUsage() const {
+    MemoryUsage usage;
+    usage.elements = nodes.size();
+    usage.addBlocks(nodes.size(), sizeof(ListNode), sizeof(ListNode));
+    usage.addHashTable(nodes, false);
+    for(const KeyIndex* index : { &nameIndex, &cityIndex }) {
+        usage.addHashTable(*index, true);
+        for(const KeyBucket& bucket : *index) {
+            usage.addString(bucket.first);
+            usage.addVector(bucket.second);
+        }
+    }
+    return usage;
 }
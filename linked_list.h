@@ -5,9 +5,14 @@
 
 #include "contact.h"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <fstream>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
 
 /**
  * @enum PrimarySortAttribute
@@ -36,19 +41,49 @@ enum class SortOrder {
     DESCENDING  ///< По убыванию
 };
 
+struct ListNode;
+
+/**
+ * @brief Хэш-индекс списка: значение атрибута -> узлы с этим значением.
+ */
+using KeyIndex = std::unordered_map<std::string, std::vector<ListNode*>>;
+
+/**
+ * @brief Элемент хэш-индекса (адрес элемента стабилен до его удаления).
+ */
+using KeyBucket = KeyIndex::value_type;
+
 /**
  * @struct ListNode
- * @brief Узел линейного списка, содержащий контакт и указатель на следующий узел.
+ * @brief Узел линейного списка, ссылающийся на контакт в общем хранилище.
+ *
+ * Узел хранит не копию контакта, а его ID и первые байты ключей сортировки,
+ * поэтому большинство сравнений при вставке не обращается к хранилищу.
+ * Через те же узлы проходят цепочка порядка вставки и ссылки на элементы
+ * хэш-индексов по имени и городу вместе с позицией узла в них, поэтому
+ * удаление из индекса не просматривает элемент.
  */
 struct ListNode {
-    Contact contact;                    ///< Объект контакта
+    int id;                             ///< ID контакта в общем хранилище
+    std::uint64_t namePrefix;           ///< Первые 8 байт имени (big-endian)
+    std::uint64_t cityPrefix;           ///< Первые 8 байт города (big-endian)
     std::unique_ptr<ListNode> next;     ///< Указатель на следующий узел
+    ListNode* prev;                     ///< Указатель на предыдущий узел
+    ListNode* insertedNext;             ///< Следующий узел в порядке вставки
+    ListNode* insertedPrev;             ///< Предыдущий узел в порядке вставки
+    KeyBucket* nameBucket;              ///< Элемент индекса по имени, содержащий узел
+    KeyBucket* cityBucket;              ///< Элемент индекса по городу, содержащий узел
+    std::size_t namePosition;           ///< Позиция узла в элементе индекса по имени
+    std::size_t cityPosition;           ///< Позиция узла в элементе индекса по городу
 
     /**
      * @brief Конструктор узла.
-     * @param contact Объект контакта для хранения в узле.
+     * @param id ID контакта в общем хранилище.
      */
-    ListNode(const Contact& contact) : contact(contact), next(nullptr) {}
+    explicit ListNode(int id)
+        : id(id), namePrefix(0), cityPrefix(0), next(nullptr), prev(nullptr),
+          insertedNext(nullptr), insertedPrev(nullptr), nameBucket(nullptr), cityBucket(nullptr),
+          namePosition(0), cityPosition(0) {}
 };
 
 /**
@@ -57,29 +92,130 @@ struct ListNode {
  */
 class LinkedList {
 private:
+    ContactStore* store;                           ///< Общее хранилище контактов
     std::unique_ptr<ListNode> head;                ///< Голова списка
+    std::unordered_map<int, ListNode*> nodes;      ///< Узлы списка по ID контакта
+    KeyIndex nameIndex;                            ///< Узлы по имени
+    KeyIndex cityIndex;                            ///< Узлы по городу
+    ListNode* firstInserted;                       ///< Первый узел в порядке вставки
+    ListNode* lastInserted;                        ///< Последний узел в порядке вставки
     PrimarySortAttribute primaryAttribute;         ///< Основной атрибут сортировки
     SecondarySortAttribute secondaryAttribute;     ///< Второстепенный атрибут сортировки
     SortOrder primaryOrder;                        ///< Порядок сортировки основного атрибута
     SortOrder secondaryOrder;                      ///< Порядок сортировки второстепенного атрибута
 
     /**
-     * @brief Сравнивает два контакта на основе текущих атрибутов и порядка сортировки.
-     * @param a Первый контакт для сравнения.
-     * @param b Второй контакт для сравнения.
+     * @brief Сравнивает два узла на основе текущих атрибутов и порядка сортировки.
+     * Сначала сравниваются кэшированные префиксы ключей, и только при их
+     * совпадении — полные строки из хранилища.
+     * @param a Первый узел для сравнения.
+     * @param b Второй узел для сравнения.
      * @return true, если a должен быть перед b, иначе false.
      */
-    bool compare(const Contact& a, const Contact& b) const;
+    bool compare(const ListNode& a, const ListNode& b) const;
+
+    /**
+     * @brief Возвращает строку хранилища, на которую ссылается узел.
+     * @param node Узел списка.
+     * @return Номер строки или ContactStore::npos, если контакта нет в хранилище.
+     */
+    std::size_t resolve(const ListNode& node) const;
+
+    /**
+     * @brief Обновляет кэшированные префиксы ключей узла.
+     * @param node Узел списка.
+     * @param contact Контакт, на который ссылается узел.
+     */
+    static void cachePrefixes(ListNode& node, const ContactView& contact);
+
+    /**
+     * @brief Упаковывает первые 8 байт строки в число так, что порядок чисел
+     * совпадает с лексикографическим порядком строк.
+     * @param key Строка ключа.
+     * @return Упакованный префикс.
+     */
+    static std::uint64_t keyPrefix(std::string_view key);
+
+    /**
+     * @brief Вставляет узел в отсортированную позицию.
+     * @param node Узел для вставки.
+     */
+    void link(std::unique_ptr<ListNode> node);
+
+    /**
+     * @brief Извлекает узел из списка.
+     * @param node Узел для извлечения.
+     * @return Владеющий указатель на извлечённый узел.
+     */
+    std::unique_ptr<ListNode> unlink(ListNode* node);
+
+    /**
+     * @brief Извлекает все узлы из списка, сохраняя их порядок.
+     * @param detached Вектор, в конец которого добавляются узлы.
+     */
+    void detachAll(std::vector<std::unique_ptr<ListNode>>& detached);
+
+    /**
+     * @brief Устойчиво сортирует узлы за O(n log n) и собирает из них список.
+     * Список перед вызовом должен быть пуст.
+     * @param detached Узлы списка.
+     */
+    void relinkSorted(std::vector<std::unique_ptr<ListNode>>& detached);
+
+    /**
+     * @brief Добавляет узел в хэш-индексы по текущим значениям имени и города.
+     * @param node Узел списка.
+     * @param contact Контакт, на который ссылается узел.
+     */
+    void indexNode(ListNode& node, const ContactView& contact);
+
+    /**
+     * @brief Удаляет узел из хэш-индексов.
+     * @param node Узел списка.
+     */
+    void unindexNode(ListNode& node);
+
+    /**
+     * @brief Исключает узел из цепочки порядка вставки.
+     * @param node Узел списка.
+     */
+    void unthread(ListNode& node);
+
+    /**
+     * @brief Полностью удаляет узел: из индексов, цепочки вставки и списка.
+     * @param node Узел для удаления.
+     */
+    void destroy(ListNode* node);
+
+    /**
+     * @brief Собирает узлы с заданным значением атрибута в порядке сортировки.
+     * Для основного атрибута узлы идут в списке подряд, поэтому обходится только
+     * их группа; для второстепенного сортируются только найденные узлы.
+     * Сложность O(k) (O(k log k) для второстепенного атрибута), k - число найденных.
+     * @param byName true - искать по имени, false - по городу.
+     * @param key Значение атрибута.
+     * @return Найденные узлы.
+     */
+    std::vector<const ListNode*> collect(bool byName, const std::string& key) const;
+
+    /**
+     * @brief Выводит контакт, на который ссылается узел.
+     * @param node Узел списка.
+     * @param report Вывод с форматом и страницей.
+     * @return false, если страница заполнена.
+     */
+    bool printNode(const ListNode& node, ReportWriter& report) const;
 
 public:
     /**
      * @brief Конструктор класса LinkedList.
+     * @param store Общее хранилище контактов, упорядоченное по ID.
      * @param primaryAttr Основной атрибут сортировки.
      * @param secondaryAttr Второстепенный атрибут сортировки.
      * @param primaryOrd Порядок сортировки основного атрибута.
      * @param secondaryOrd Порядок сортировки второстепенного атрибута.
      */
-    LinkedList(PrimarySortAttribute primaryAttr, SecondarySortAttribute secondaryAttr,
+    LinkedList(ContactStore& store, PrimarySortAttribute primaryAttr, SecondarySortAttribute secondaryAttr,
                SortOrder primaryOrd, SortOrder secondaryOrd);
 
     /**
@@ -106,34 +242,127 @@ public:
     ~LinkedList();
 
     /**
-     * @brief Вставляет новый контакт в список с учётом сортировки.
-     * @param contact Контакт для вставки.
+     * @brief Вставляет контакт из хранилища в список с учётом сортировки.
+     * @param id ID контакта в хранилище.
+     * @return true, если контакт вставлен; false, если его нет в хранилище или он уже в списке.
      */
-    void insert(const Contact& contact);
+    bool insert(int id);
+
+    /**
+     * @brief Вставляет несколько контактов одной сортировкой вместо вставки по одному.
+     * Результат совпадает с последовательными вызовами insert в том же порядке.
+     * @param ids ID контактов в хранилище в порядке вставки.
+     * @return Количество вставленных контактов.
+     */
+    size_t insertAll(const std::vector<int>& ids);
+
+    /**
+     * @brief Перемещает узел контакта на новое место после редактирования.
+     * Переставляется только один узел, остальной список не перестраивается.
+     * @param id ID изменённого контакта.
+     */
+    void update(int id);
+
+    /**
+     * @brief Перемещает узлы нескольких изменённых контактов одной сортировкой.
+     * Порядок вставки сохраняется; узлы удалённых из хранилища контактов удаляются.
+     * @param ids ID изменённых контактов.
+     */
+    void updateAll(const std::vector<int>& ids);
+
+    /**
+     * @brief Удаляет узел контакта из списка (хранилище не изменяется).
+     * @param id ID контакта.
+     */
+    void erase(int id);
 
     /**
      * @brief Выводит список контактов в порядке сортировки.
      */
     void printSorted() const;
 
+    /**
+     * @brief Выводит список контактов в порядке сортировки через общий вывод.
+     * @param report Вывод с форматом и страницей.
+     */
+    void printSorted(ReportWriter& report) const;
+
     /**
      * @brief Выводит список контактов в порядке их вставки.
-     * (Требует дополнительной реализации для сохранения порядка вставки)
      */
     void printInsertionOrder() const;
 
     /**
-     * @brief Ищет и выводит контакты с заданным значением атрибута.
+     * @brief Выводит список контактов в порядке их вставки через общий вывод.
+     * @param report Вывод с форматом и страницей.
+     */
+    void printInsertionOrder(ReportWriter& report) const;
+
+    /**
+     * @brief Ищет и выводит контакты с заданным значением основного атрибута.
      * @param key Значение атрибута для поиска.
      */
     void search(const std::string& key) const;
 
     /**
-     * @brief Удаляет контакт с заданным значением атрибута.
+     * @brief Ищет и выводит контакты с заданным значением основного атрибута через общий вывод.
+     * @param key Значение атрибута для поиска.
+     * @param report Вывод с форматом и страницей.
+     */
+    void search(const std::string& key, ReportWriter& report) const;
+
+    /**
+     * @brief Ищет и выводит контакты с заданным значением второстепенного атрибута.
+     * @param key Значение атрибута для поиска.
+     */
+    void searchSecondary(const std::string& key) const;
+
+    /**
+     * @brief Ищет и выводит контакты с заданным значением второстепенного атрибута через общий вывод.
+     * @param key Значение атрибута для поиска.
+     * @param report Вывод с форматом и страницей.
+     */
+    void searchSecondary(const std::string& key, ReportWriter& report) const;
+
+    /**
+     * @brief Возвращает ID контактов с заданным значением атрибута в порядке сортировки.
+     * @param key Значение атрибута для поиска.
+     * @param secondary true - искать по второстепенному атрибуту, false - по основному.
+     * @return Вектор ID найденных контактов.
+     */
+    std::vector<int> searchIds(const std::string& key, bool secondary = false) const;
+
+    /**
+     * @brief Возвращает ID контактов в порядке их вставки.
+     * @return Вектор ID контактов.
+     */
+    std::vector<int> insertionOrderIds() const;
+
+    /**
+     * @brief Удаляет контакт с заданным значением атрибута из списка.
+     * Хранилище не изменяется.
      * @param key Значение атрибута для удаления.
      */
     void remove(const std::string& key);
 
+    /**
+     * @brief Удаляет из списка все контакты, удовлетворяющие предикату.
+     * Предикат вычисляется один раз для каждого узла, поэтому вызывать метод
+     * нужно до удаления контактов из хранилища.
+     * @param predicate Условие удаления.
+     * @return Количество удалённых узлов.
+     */
+    size_t removeIf(const std::function<bool(const ContactView&)>& predicate);
+
+    /**
+     * @brief Удаляет из списка узлы контактов с заданными ID (хранилище не изменяется).
+     * Небольшие наборы удаляются поштучно, большие - одним проходом по списку
+     * и хэш-индексам.
+     * @param ids ID удаляемых контактов.
+     * @return Количество удалённых узлов.
+     */
+    size_t removeIds(const std::unordered_set<int>& ids);
+
     /**
      * @brief Изменяет атрибуты сортировки и пересортировывает список.
      * @param primaryAttr Новый основной атрибут сортировки.
@@ -152,9 +381,19 @@ public:
 
     /**
      * @brief Загружает список контактов из файла.
+     * Контакты, которых нет в хранилище, добавляются в него с сохранением
+     * порядка по ID; контакты, уже присутствующие в списке, пропускаются.
+     * Строки с ошибками формата или номера телефона пропускаются с сообщением.
      * @param filename Имя файла для загрузки.
+     * @return Количество пропущенных строк.
+     */
+    std::size_t loadFromFile(const std::string& filename);
+
+    /**
+     * @brief Возвращает объём памяти списка: узлы, таблицу узлов по ID и хэш-индексы.
+     * @return Объём памяти; элементы - узлы.
      */
-    void loadFromFile(const std::string& filename);
+    MemoryUsage memoryUsage() const;
 };
 
 #endif // LINKED_LIST_H
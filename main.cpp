@@ -3,87 +3,250 @@
 #include "contact.h"
 #include "binary_tree.h" // Подключение заголовочного файла бинарного дерева
 #include "linked_list.h" // Подключение заголовочного файла линейного списка
+#include "snapshot.h"
+#include "journal.h"
+#include "external_index.h"
+#include "contact_diff.h"
+#include "batch.h"
+#include "server.h"
+#include "stats.h"
+#include "trace.h"
+#include <filesystem>
+#include <fstream>
 #include <vector>
 #include <iostream>
 #include <limits>
+#include <cstdlib>
+#include <csignal>
+#include <unordered_set>
 
 /**
  * @brief Сохраняет контакты в файл.
- * @param contacts Вектор контактов.
+ * @param contacts Хранилище контактов.
  * @param filename Имя файла для сохранения.
  */
-void saveContactsToFile(const std::vector<Contact>& contacts, const std::string& filename);
+void saveContactsToFile(const ContactStore& contacts, const std::string& filename);
 
 /**
  * @brief Загружает контакты из файла.
- * @param contacts Вектор контактов для загрузки.
+ * @param contacts Хранилище контактов для загрузки.
  * @param filename Имя файла для загрузки.
+ * @return Количество пропущенных строк.
  */
-void loadContactsFromFile(std::vector<Contact>& contacts, const std::string& filename);
+std::size_t loadContactsFromFile(ContactStore& contacts, const std::string& filename);
 
 /**
  * @brief Выводит контакты по заданным индексам.
- * @param contacts Вектор контактов.
+ * @param contacts Хранилище контактов.
  * @param indexIndex Вектор индексов.
+ * @param report Вывод с форматом и страницей.
  */
-void printSortedByName(const std::vector<Contact>& contacts, const std::vector<Index>& nameIndex);
+void printSortedByName(const ContactStore& contacts, const std::vector<Index>& nameIndex, ReportWriter& report);
 
 /**
  * @brief Выводит контакты по заданным индексам.
- * @param contacts Вектор контактов.
- * @param cityIndex Вектор индексов.
+ * @param contacts Хранилище контактов.
+ * @param cityIndex Индекс по городу.
+ * @param report Вывод с форматом и страницей.
  */
-void printSortedByCity(const std::vector<Contact>& contacts, const std::vector<Index>& cityIndex);
+void printSortedByCity(const ContactStore& contacts, const CityIndex& cityIndex, ReportWriter& report);
 
 /**
  * @brief Выводит все контакты.
- * @param contacts Вектор контактов.
+ * @param contacts Хранилище контактов.
+ * @param report Вывод с форматом и страницей.
  */
-void printContacts(const std::vector<Contact>& contacts);
+void printContacts(const ContactStore& contacts, ReportWriter& report);
 
 /**
  * @brief Редактирует контакт.
- * @param contacts Вектор контактов.
+ * @param contacts Хранилище контактов.
  * @param indices Структура индекс-массивов.
+ * @return ID отредактированного контакта или -1.
  */
-void editContact(std::vector<Contact>& contacts, IndexArray& indices);
+int editContact(ContactStore& contacts, IndexArray& indices);
 
 /**
  * @brief Удаляет контакт.
- * @param contacts Вектор контактов.
+ * @param contacts Хранилище контактов.
  * @param indices Структура индекс-массивов.
+ * @return Вектор ID удалённых контактов.
  */
-void deleteContact(std::vector<Contact>& contacts, IndexArray& indices);
+std::vector<int> deleteContact(ContactStore& contacts, IndexArray& indices);
 
-int main() {
-    std::vector<Contact> contacts;
+// Сервер, останавливаемый по SIGINT и SIGTERM
+static ContactServer* activeServer = nullptr;
+
+/**
+ * @brief Обработчик сигнала остановки сервера.
+ * @param signal Номер сигнала.
+ */
+static void stopServer(int signal) {
+    (void)signal;
+    if(activeServer)
+        activeServer->stop();
+}
+
+int main(int argc, char* argv[]) {
+    // Трассировка фаз: main --trace <файл> [режим]; файл Chrome trace записывается при выходе
+    std::string traceFile;
+    if(argc > 2 && std::string(argv[1]) == "--trace") {
+        traceFile = argv[2];
+        argv[2] = argv[0];
+        argv += 2;
+        argc -= 2;
+    }
+    setTraceThreadName("main");
+    TraceSession trace(traceFile);
+
+    ContactStore contacts; // Колоночное хранилище контактов
     IndexArray indices;
+
+    // Пакетный режим: main --batch <файл контактов> [файл команд]
+    // Режим сервера: main --serve <файл контактов> <сокет>
+    // Команды читаются из файла, std::cin или сокета; меню и ввод контактов пропускаются
+    bool batchMode = argc > 1 && std::string(argv[1]) == "--batch";
+    bool serverMode = argc > 1 && std::string(argv[1]) == "--serve";
+    if(batchMode || serverMode) {
+        if(argc < 3 || (serverMode && argc < 4)) {
+            std::cerr << "Использование: " << argv[0] << " [--trace <файл>] --batch <файл контактов> [файл команд]\n"
+                      << "               " << argv[0] << " [--trace <файл>] --serve <файл контактов> <сокет>\n";
+            return 1;
+        }
+        // Без синхронизации с stdio std::cin читает блоками, и пакет виден через in_avail;
+        // без связи с std::cin std::cout сбрасывается только сессией
+        std::ios::sync_with_stdio(false);
+        std::cin.tie(nullptr);
+        const std::string batchFile = argv[2];
+        ThreadPool pool;
+        std::size_t rejectedRows = 0;
+        if(std::filesystem::exists(batchFile)) {
+            // Сообщение о загрузке уходит в std::cerr: в std::cout - только результаты команд
+            std::streambuf* output = std::cout.rdbuf(std::cerr.rdbuf());
+            rejectedRows = loadContactsFromFileParallel(contacts, batchFile, pool);
+            std::cout.rdbuf(output);
+        }
+        BatchSession session(contacts, indices, batchFile, rejectedRows);
+        if(serverMode) {
+            ContactServer server(session, pool);
+            if(!server.listen(argv[3]))
+                return 1;
+            // Индексы строятся один раз до первого запроса, а не при первом запросе клиента
+            session.prepare("find");
+            activeServer = &server;
+            std::signal(SIGINT, stopServer);
+            std::signal(SIGTERM, stopServer);
+            std::cerr << "Сервер ожидает соединений: " << argv[3] << "\n";
+            server.run();
+            activeServer = nullptr;
+            std::cerr << "Сервер остановлен, выполнено команд: " << server.requests() << "\n";
+            return 0;
+        }
+        if(argc > 3) {
+            std::ifstream script(argv[3]);
+            if(!script) {
+                std::cerr << "Не удалось открыть файл команд: " << argv[3] << "\n";
+                return 1;
+            }
+            session.run(script, std::cout, pool);
+        }
+        else {
+            session.run(std::cin, std::cout, pool);
+        }
+        return 0;
+    }
     BinaryTree tree; // Создание экземпляра бинарного дерева
 
-    // Создание экземпляра линейного списка
+    // Создание экземпляра линейного списка поверх общего хранилища контактов
     // Изначально сортировка по имени и городу по возрастанию
     PrimarySortAttribute primaryAttr = PrimarySortAttribute::NAME;
     SecondarySortAttribute secondaryAttr = SecondarySortAttribute::CITY;
     SortOrder primaryOrder = SortOrder::ASCENDING;
     SortOrder secondaryOrder = SortOrder::ASCENDING;
-    LinkedList sortedList(primaryAttr, secondaryAttr, primaryOrder, secondaryOrder);
+    LinkedList sortedList(contacts, primaryAttr, secondaryAttr, primaryOrder, secondaryOrder);
+
+    // Загрузка сохранённых контактов: снимок с готовыми индексами, если он не
+    // старше CSV, иначе разбор CSV
+    const std::string csvFile = "contacts.csv";
+    const std::string snapshotFile = "contacts.snapshot";
+    ThreadPool pool; // Загрузка и построение структур при запуске
+    bool indicesLoaded = isSnapshotCurrent(snapshotFile, csvFile) && loadSnapshot(snapshotFile, contacts, indices);
+
+    // Файлы, строки которых были пропущены при загрузке: перезапись удалила бы
+    // эти строки с диска, поэтому такие файлы не перезаписываются
+    std::vector<std::string> incompleteFiles;
+    auto isIncomplete = [&](const std::string& filename) {
+        for(const std::string& incomplete : incompleteFiles) {
+            std::error_code error;
+            if(incomplete == filename || std::filesystem::equivalent(incomplete, filename, error))
+                return true;
+        }
+        return false;
+    };
+    if(!indicesLoaded && std::filesystem::exists(csvFile) && loadContactsFromFileParallel(contacts, csvFile, pool) > 0)
+        incompleteFiles.push_back(csvFile);
+
+    // Применение изменений, сделанных после последнего снимка
+    Journal journal;
+    const std::uint64_t journalCompactionBytes = 4 << 20;
+    if(journal.open("contacts.journal") && journal.replay(contacts) > 0)
+        indicesLoaded = false;
+    std::size_t loadedContacts = contacts.size();
+
+    // Фиксация журнала после каждого изменяющего действия; выросший журнал
+    // переносится в новый снимок и очищается
+    auto commitJournal = [&]() {
+        journal.commit();
+        // Снимок новее CSV заменил бы его при следующем запуске, и пропущенные строки
+        // CSV были бы потеряны; пока CSV не исправлен, изменения остаются в журнале
+        if(journal.size() > journalCompactionBytes && !isIncomplete(csvFile) &&
+           saveSnapshot(snapshotFile, contacts, indices))
+            journal.reset();
+    };
 
     // Ввод данных контактов
     inputContacts(contacts);
+    // Новые контакты получают ID больше загруженных и находятся в конце хранилища
+    for(std::size_t row = loadedContacts; row < contacts.size(); ++row) {
+        journal.logInsert(contacts[row]);
+    }
 
-    // Построение и сортировка индекс-массивов
-    indices.buildIndices(contacts);
-    indices.sortIndices();
-
-    // Вставка данных в бинарное дерево по ключевому атрибуту (например, имя)
+    // Список не зависит от индексов и строится задачей пула одновременно с ними;
+    // ранги городов, которые читают обе ветви, вычисляются заранее
+    contacts.cityRanks();
+    std::vector<int> ids;
+    ids.reserve(contacts.size());
     for(const auto& contact : contacts) {
-        tree.insert(contact.name, contact.id);
+        ids.push_back(contact.id);
     }
+    TaskGroup listBuild(pool);
+    listBuild.run([&]() {
+        // Вставка данных в линейный список (сортированный) одной сортировкой
+        sortedList.insertAll(ids);
+    });
 
-    // Вставка данных в линейный список (сортированный)
-    for(const auto& contact : contacts) {
-        sortedList.insert(contact);
+    // Построение бинарного дерева по ключевому атрибуту (имя) из отсортированного индекса
+    auto buildTree = [&]() { tree.buildFromIndex(indices.nameIndexAsc); };
+    // Построение и сортировка индекс-массивов, если их нет в снимке или добавлены новые контакты;
+    // дерево строится, как только готов индекс по имени, одновременно с сортировкой остальных
+    if(!indicesLoaded || contacts.size() != loadedContacts) {
+        indices.buildIndices(contacts, pool);
+        indices.sortIndices(pool, buildTree);
+    } else {
+        buildTree();
     }
+    listBuild.wait();
+    commitJournal();
+
+    // Формат и страница вывода контактов (пункт 29)
+    ReportOptions reportOptions;
+
+    // Вывод найденных контактов или сообщения, что ничего не найдено
+    auto printFound = [&](const std::vector<int>& ids, const std::string& found, const std::string& notFound) {
+        ReportWriter report(std::cout, reportOptions);
+        report.heading(ids.empty() ? notFound : found);
+        report.write(contacts, ids);
+    };
 
     int choice;
     while(true) {
@@ -95,8 +258,8 @@ int main() {
                   << "5. Вывести контакты, отсортированные по городу (по убыванию)\n"
                   << "6. Поиск контакта по имени (итерационный)\n"
                   << "7. Поиск контакта по имени (рекурсивный)\n"
-                  << "8. Поиск контакта по городу (итерационный)\n"
-                  << "9. Поиск контакта по городу (рекурсивный)\n"
+                  << "8. Поиск контакта по городу (индекс по возрастанию)\n"
+                  << "9. Поиск контакта по городу (индекс по убыванию)\n"
                   << "10. Редактировать контакт\n"
                   << "11. Удалить контакт\n"
                   << "12. Вывести контакты из бинарного дерева по имени (по возрастанию)\n"
@@ -108,6 +271,17 @@ int main() {
                   << "18. Изменить атрибуты сортировки линейного списка\n"
                   << "19. Сохранить линейный список в файл\n"
                   << "20. Загрузить линейный список из файла\n"
+                  << "21. Поиск контактов в линейном списке по второстепенному атрибуту\n"
+                  << "22. Вывести контакты из линейного списка в порядке ввода\n"
+                  << "23. Удалить все контакты из города\n"
+                  << "24. Поиск контакта по номеру телефона\n"
+                  << "25. Поиск контактов по началу номера телефона\n"
+                  << "26. Построить индексы CSV-файла на диске\n"
+                  << "27. Поиск по индексу на диске\n"
+                  << "28. Сравнить контакты с файлом и синхронизировать\n"
+                  << "29. Настроить формат вывода и страницы\n"
+                  << "30. Статистика операций\n"
+                  << "31. Отчёт об использовании памяти\n"
                   << "0. Выход\n"
                   << "Выберите действие: ";
         std::cin >> choice;
@@ -115,166 +289,121 @@ int main() {
 
         if(choice == 0) {
             // Сохранение контактов перед выходом
-            saveContactsToFile(contacts, "contacts.csv");
+            if(isIncomplete(csvFile)) {
+                std::cerr << "Файл " << csvFile << " не перезаписан: при загрузке в нём были пропущены строки. "
+                          << "Изменения сохранены в журнале и будут применены при следующем запуске.\n";
+            }
+            else {
+                saveContactsToFile(contacts, csvFile);
+            }
             // Сохранение линейного списка
-            sortedList.saveToFile("linked_list.csv");
+            if(isIncomplete("linked_list.csv"))
+                std::cerr << "Файл linked_list.csv не перезаписан: при загрузке в нём были пропущены строки.\n";
+            else
+                sortedList.saveToFile("linked_list.csv");
+            // Снимок записывается после CSV, поэтому при следующем запуске он не старше;
+            // изменения журнала вошли в снимок
+            if(!isIncomplete(csvFile) && saveSnapshot(snapshotFile, contacts, indices))
+                journal.reset();
             break;
         }
 
         switch(choice) {
-            case 1:
-                printContacts(contacts);
+            case 1: {
+                ReportWriter report(std::cout, reportOptions);
+                printContacts(contacts, report);
                 break;
+            }
             case 2:
-                std::cout << "\nКонтакты, отсортированные по имени (по возрастанию):\n";
-                printSortedByName(contacts, indices.nameIndexAsc);
-                break;
-            case 3:
-                std::cout << "\nКонтакты, отсортированные по имени (по убыванию):\n";
-                printSortedByName(contacts, indices.nameIndexDesc);
+            case 3: {
+                ReportWriter report(std::cout, reportOptions);
+                report.heading(choice == 2 ? "\nКонтакты, отсортированные по имени (по возрастанию):\n"
+                                           : "\nКонтакты, отсортированные по имени (по убыванию):\n");
+                printSortedByName(contacts, choice == 2 ? indices.nameIndexAsc : indices.nameIndexDesc, report);
                 break;
+            }
             case 4:
-                std::cout << "\nКонтакты, отсортированные по городу (по возрастанию):\n";
-                printSortedByCity(contacts, indices.cityIndexAsc);
-                break;
-            case 5:
-                std::cout << "\nКонтакты, отсортированные по городу (по убыванию):\n";
-                printSortedByCity(contacts, indices.cityIndexDesc);
+            case 5: {
+                ReportWriter report(std::cout, reportOptions);
+                report.heading(choice == 4 ? "\nКонтакты, отсортированные по городу (по возрастанию):\n"
+                                           : "\nКонтакты, отсортированные по городу (по убыванию):\n");
+                printSortedByCity(contacts, choice == 4 ? indices.cityIndexAsc : indices.cityIndexDesc, report);
                 break;
+            }
             case 6: { // Поиск по имени (итерационный)
                 std::string key;
                 std::cout << "Введите имя для поиска (итерационный): ";
                 std::getline(std::cin, key);
                 std::vector<int> ids = binarySearchIterative(indices.nameIndexAsc, key);
-                if(!ids.empty()) {
-                    std::cout << "Найденные контакты с именем \"" << key << "\":\n";
-                    for(auto id : ids) {
-                        if(id - 1 < 0 || id - 1 >= contacts.size()) {
-                            std::cerr << "Ошибка: Некорректный ID " << id << "\n";
-                            continue;
-                        }
-                        const auto& contact = contacts[id - 1];
-                        std::cout << "ID: " << contact.id << "\n"
-                                  << "Имя: " << contact.name << "\n"
-                                  << "Номер телефона: " << contact.phoneNumber << "\n"
-                                  << "Город: " << contact.city << "\n"
-                                  << "-----------------------------\n";
-                    }
-                }
-                else {
-                    std::cout << "Контакт с именем \"" << key << "\" не найден.\n";
-                }
+                printFound(ids, "Найденные контакты с именем \"" + key + "\":\n",
+                           "Контакт с именем \"" + key + "\" не найден.\n");
                 break;
             }
             case 7: { // Поиск по имени (рекурсивный)
                 std::string key;
                 std::cout << "Введите имя для поиска (рекурсивный): ";
                 std::getline(std::cin, key);
-                std::vector<int> ids = binarySearchRecursive(indices.nameIndexAsc, key, 0, indices.nameIndexAsc.size() - 1);
-                if(!ids.empty()) {
-                    std::cout << "Найденные контакты с именем \"" << key << "\":\n";
-                    for(auto id : ids) {
-                        if(id - 1 < 0 || id - 1 >= contacts.size()) {
-                            std::cerr << "Ошибка: Некорректный ID " << id << "\n";
-                            continue;
-                        }
-                        const auto& contact = contacts[id - 1];
-                        std::cout << "ID: " << contact.id << "\n"
-                                  << "Имя: " << contact.name << "\n"
-                                  << "Номер телефона: " << contact.phoneNumber << "\n"
-                                  << "Город: " << contact.city << "\n"
-                                  << "-----------------------------\n";
-                    }
-                }
-                else {
-                    std::cout << "Контакт с именем \"" << key << "\" не найден.\n";
+                std::vector<int> ids;
+                {
+                    // Замер всего поиска, а не каждого уровня рекурсии
+                    STATS_TIMED(StatOperation::SEARCH);
+                    ids = binarySearchRecursive(indices.nameIndexAsc, key, 0, indices.nameIndexAsc.size() - 1);
+                    STATS_COUNT(StatCounter::FOUND, ids.size());
                 }
+                printFound(ids, "Найденные контакты с именем \"" + key + "\":\n",
+                           "Контакт с именем \"" + key + "\" не найден.\n");
                 break;
             }
-            case 8: { // Поиск по городу (итерационный)
+            case 8: { // Поиск по городу (прямое обращение к группе города)
                 std::string key;
-                std::cout << "Введите город для поиска (итерационный): ";
+                std::cout << "Введите город для поиска (индекс по возрастанию): ";
                 std::getline(std::cin, key);
-                std::vector<int> ids = binarySearchIterative(indices.cityIndexAsc, key);
-                if(!ids.empty()) {
-                    std::cout << "Найденные контакты в городе \"" << key << "\":\n";
-                    for(auto id : ids) {
-                        if(id - 1 < 0 || id - 1 >= contacts.size()) {
-                            std::cerr << "Ошибка: Некорректный ID " << id << "\n";
-                            continue;
-                        }
-                        const auto& contact = contacts[id - 1];
-                        std::cout << "ID: " << contact.id << "\n"
-                                  << "Имя: " << contact.name << "\n"
-                                  << "Номер телефона: " << contact.phoneNumber << "\n"
-                                  << "Город: " << contact.city << "\n"
-                                  << "-----------------------------\n";
-                    }
-                }
-                else {
-                    std::cout << "Контакт в городе \"" << key << "\" не найден.\n";
-                }
+                std::vector<int> ids = searchCity(indices.cityIndexAsc, contacts.findCity(key));
+                printFound(ids, "Найденные контакты в городе \"" + key + "\":\n",
+                           "Контакт в городе \"" + key + "\" не найден.\n");
                 break;
             }
-            case 9: { // Поиск по городу (рекурсивный)
+            case 9: { // Поиск по городу (прямое обращение к группе города)
                 std::string key;
-                std::cout << "Введите город для поиска (рекурсивный): ";
+                std::cout << "Введите город для поиска (индекс по убыванию): ";
                 std::getline(std::cin, key);
-                std::vector<int> ids = binarySearchRecursive(indices.cityIndexAsc, key, 0, indices.cityIndexAsc.size() - 1);
-                if(!ids.empty()) {
-                    std::cout << "Найденные контакты в городе \"" << key << "\":\n";
-                    for(auto id : ids) {
-                        if(id - 1 < 0 || id - 1 >= contacts.size()) {
-                            std::cerr << "Ошибка: Некорректный ID " << id << "\n";
-                            continue;
-                        }
-                        const auto& contact = contacts[id - 1];
-                        std::cout << "ID: " << contact.id << "\n"
-                                  << "Имя: " << contact.name << "\n"
-                                  << "Номер телефона: " << contact.phoneNumber << "\n"
-                                  << "Город: " << contact.city << "\n"
-                                  << "-----------------------------\n";
-                    }
-                }
-                else {
-                    std::cout << "Контакт в городе \"" << key << "\" не найден.\n";
-                }
+                std::vector<int> ids = searchCity(indices.cityIndexDesc, contacts.findCity(key));
+                printFound(ids, "Найденные контакты в городе \"" + key + "\":\n",
+                           "Контакт в городе \"" + key + "\" не найден.\n");
                 break;
             }
-            case 10:
-                editContact(contacts, indices);
-                // Перезапись бинарного дерева
-                tree = BinaryTree(); // Перемещающее присваивание
-                for(const auto& contact : contacts) {
-                    tree.insert(contact.name, contact.id);
-                }
-                // Перезапись линейного списка
-                sortedList = LinkedList(primaryAttr, secondaryAttr, primaryOrder, secondaryOrder); // Перемещающее присваивание
-                for(const auto& contact : contacts) {
-                    sortedList.insert(contact);
-                }
+            case 10: {
+                int editedId = editContact(contacts, indices);
+                if(editedId == -1)
+                    break;
+                // Перезапись бинарного дерева из перестроенного индекса
+                tree.buildFromIndex(indices.nameIndexAsc);
+                // Перестановка одного узла линейного списка
+                sortedList.update(editedId);
+                journal.logUpdate(contacts[contacts.rowOf(editedId)]);
+                commitJournal();
                 break;
-            case 11:
-                deleteContact(contacts, indices);
-                // Перезапись бинарного дерева
-                tree = BinaryTree(); // Перемещающее присваивание
-                for(const auto& contact : contacts) {
-                    tree.insert(contact.name, contact.id);
-                }
-                // Перезапись линейного списка
-                sortedList = LinkedList(primaryAttr, secondaryAttr, primaryOrder, secondaryOrder); // Перемещающее присваивание
-                for(const auto& contact : contacts) {
-                    sortedList.insert(contact);
+            }
+            case 11: {
+                std::vector<int> removedIds = deleteContact(contacts, indices);
+                if(removedIds.empty())
+                    break;
+                // Удаление записей из бинарного дерева и узлов линейного списка
+                std::unordered_set<int> removedSet(removedIds.begin(), removedIds.end());
+                tree.removeRecords(removedSet);
+                sortedList.removeIds(removedSet);
+                for(int id : removedIds) {
+                    journal.logDelete(id);
                 }
-                break;
-            case 12: { // Вывод контактов из бинарного дерева по имени (по возрастанию)
-                std::cout << "\nКонтакты из бинарного дерева по имени (по возрастанию):\n";
-                tree.inOrder(contacts, true);
+                commitJournal();
                 break;
             }
+            case 12: // Вывод контактов из бинарного дерева по имени (по возрастанию)
             case 13: { // Вывод контактов из бинарного дерева по имени (по убыванию)
-                std::cout << "\nКонтакты из бинарного дерева по имени (по убыванию):\n";
-                tree.inOrder(contacts, false);
+                ReportWriter report(std::cout, reportOptions);
+                report.heading(choice == 12 ? "\nКонтакты из бинарного дерева по имени (по возрастанию):\n"
+                                            : "\nКонтакты из бинарного дерева по имени (по убыванию):\n");
+                tree.inOrder(contacts, report, choice == 12);
                 break;
             }
             case 14: { // Поиск контактов в бинарном дереве по имени
@@ -282,29 +411,14 @@ int main() {
                 std::cout << "Введите имя для поиска в бинарном дереве: ";
                 std::getline(std::cin, key);
                 std::vector<int> ids = tree.search(key);
-                if(!ids.empty()) {
-                    std::cout << "Найденные контакты с именем \"" << key << "\":\n";
-                    for(auto id : ids) {
-                        if(id - 1 < 0 || id - 1 >= contacts.size()) {
-                            std::cerr << "Ошибка: Некорректный ID " << id << "\n";
-                            continue;
-                        }
-                        const auto& contact = contacts[id - 1];
-                        std::cout << "ID: " << contact.id << "\n"
-                                  << "Имя: " << contact.name << "\n"
-                                  << "Номер телефона: " << contact.phoneNumber << "\n"
-                                  << "Город: " << contact.city << "\n"
-                                  << "-----------------------------\n";
-                    }
-                }
-                else {
-                    std::cout << "Контакт с именем \"" << key << "\" не найден.\n";
-                }
+                printFound(ids, "Найденные контакты с именем \"" + key + "\":\n",
+                           "Контакт с именем \"" + key + "\" не найден.\n");
                 break;
             }
             case 15: { // Вывод контактов из линейного списка (сортированный)
-                std::cout << "\nКонтакты из линейного списка (сортированный):\n";
-                sortedList.printSorted();
+                ReportWriter report(std::cout, reportOptions);
+                report.heading("\nКонтакты из линейного списка (сортированный):\n");
+                sortedList.printSorted(report);
                 break;
             }
             case 16: { // Поиск контактов в линейном списке (сортированный)
@@ -313,7 +427,8 @@ int main() {
                           << (primaryAttr == PrimarySortAttribute::NAME ? "имя" : "город") 
                           << " для поиска в линейном списке (сортированный): ";
                 std::getline(std::cin, key);
-                sortedList.search(key);
+                ReportWriter report(std::cout, reportOptions);
+                sortedList.search(key, report);
                 break;
             }
             case 17: { // Удаление контакта из линейного списка (сортированный)
@@ -396,6 +511,10 @@ int main() {
                 }
 
                 sortedList.changeSortAttributes(newPrimaryAttr, newSecondaryAttr, newPrimaryOrder, newSecondaryOrder);
+                primaryAttr = newPrimaryAttr;
+                secondaryAttr = newSecondaryAttr;
+                primaryOrder = newPrimaryOrder;
+                secondaryOrder = newSecondaryOrder;
                 std::cout << "Атрибуты сортировки успешно изменены.\n";
                 break;
             }
@@ -403,6 +522,10 @@ int main() {
                 std::string filename;
                 std::cout << "Введите имя файла для сохранения линейного списка: ";
                 std::getline(std::cin, filename);
+                if(isIncomplete(filename)) {
+                    std::cout << "Файл не перезаписан: при загрузке в нём были пропущены строки.\n";
+                    break;
+                }
                 sortedList.saveToFile(filename);
                 break;
             }
@@ -410,7 +533,259 @@ int main() {
                 std::string filename;
                 std::cout << "Введите имя файла для загрузки линейного списка: ";
                 std::getline(std::cin, filename);
-                sortedList.loadFromFile(filename);
+                std::vector<int> idsBefore;
+                idsBefore.reserve(contacts.size());
+                for(const auto& contact : contacts) {
+                    idsBefore.push_back(contact.id);
+                }
+                if(sortedList.loadFromFile(filename) > 0)
+                    incompleteFiles.push_back(filename);
+                // Новые контакты из файла добавлены в общее хранилище; оба списка ID упорядочены
+                auto before = idsBefore.begin();
+                for(const auto& contact : contacts) {
+                    while(before != idsBefore.end() && *before < contact.id)
+                        ++before;
+                    if(before == idsBefore.end() || *before != contact.id)
+                        journal.logInsert(contact);
+                }
+                indices.buildIndices(contacts);
+                indices.sortIndices();
+                tree.buildFromIndex(indices.nameIndexAsc);
+                commitJournal();
+                break;
+            }
+            case 21: { // Поиск контактов в линейном списке по второстепенному атрибуту
+                std::string key;
+                std::cout << "Введите " 
+                          << (secondaryAttr == SecondarySortAttribute::NAME ? "имя" : "город") 
+                          << " для поиска в линейном списке (второстепенный атрибут): ";
+                std::getline(std::cin, key);
+                ReportWriter report(std::cout, reportOptions);
+                sortedList.searchSecondary(key, report);
+                break;
+            }
+            case 22: { // Вывод контактов из линейного списка в порядке ввода
+                ReportWriter report(std::cout, reportOptions);
+                report.heading("\nКонтакты из линейного списка (в порядке ввода):\n");
+                sortedList.printInsertionOrder(report);
+                break;
+            }
+            case 23: { // Пакетное удаление всех контактов из города
+                std::string city;
+                std::cout << "Введите город, контакты из которого нужно удалить: ";
+                std::getline(std::cin, city);
+                // Сравнение кодов городов вместо строк
+                std::uint32_t cityCode = contacts.findCity(city);
+                std::vector<int> removedIds;
+                if(cityCode != ContactStore::noCity)
+                    removedIds = contacts.removeIf([&](const ContactView& c) { return c.cityCode == cityCode; });
+                if(removedIds.empty()) {
+                    std::cout << "Контакт в городе \"" << city << "\" не найден.\n";
+                    break;
+                }
+                // Один проход по каждой структуре
+                std::unordered_set<int> removedSet(removedIds.begin(), removedIds.end());
+                indices.removeRecords(removedSet);
+                tree.removeRecords(removedSet);
+                sortedList.removeIds(removedSet);
+                // Все удаления фиксируются одной синхронизацией журнала
+                for(int id : removedIds) {
+                    journal.logDelete(id);
+                }
+                commitJournal();
+                std::cout << "Удалено контактов: " << removedIds.size() << "\n";
+                break;
+            }
+            case 24: // Поиск по номеру телефона
+            case 25: { // Поиск по префиксу номера телефона
+                std::string key;
+                std::cout << (choice == 24 ? "Введите номер телефона для поиска: "
+                                           : "Введите начальные цифры номера телефона: ");
+                std::getline(std::cin, key);
+                std::vector<int> ids;
+                if(choice == 24) {
+                    PackedPhone phone;
+                    if(!PackedPhone::parse(key, phone)) {
+                        std::cout << "Некорректный формат номера телефона.\n";
+                        break;
+                    }
+                    ids = searchPhone(indices.phoneIndex, phone);
+                }
+                else {
+                    ids = searchPhonePrefix(indices.phoneIndex, key);
+                }
+                printFound(ids, "Найденные контакты с номером \"" + key + (choice == 25 ? "...\":\n" : "\":\n"),
+                           "Контакт с номером \"" + key + "\" не найден.\n");
+                break;
+            }
+            case 26: { // Построение индексов CSV-файла во внешней памяти
+                std::string filename, budget, format;
+                std::cout << "Введите имя CSV-файла: ";
+                std::getline(std::cin, filename);
+                std::cout << "Введите объём памяти для сортировки, МБ: ";
+                std::getline(std::cin, budget);
+                std::size_t megabytes = budget.empty() ? 64 : std::strtoul(budget.c_str(), nullptr, 10);
+                if(megabytes == 0) {
+                    std::cout << "Некорректный объём памяти.\n";
+                    break;
+                }
+                std::cout << "Формат индекса (1 - таблица записей, 2 - сжатый): ";
+                std::getline(std::cin, format);
+                bool compressed = format == "2";
+                const std::pair<IndexKey, const char*> keys[] = {
+                    { IndexKey::NAME, ".name" }, { IndexKey::CITY, ".city" }, { IndexKey::PHONE, ".phone" }
+                };
+                for(const auto& key : keys) {
+                    std::string indexFile = filename + key.second + (compressed ? ".fci" : ".idx");
+                    if(!buildExternalIndex(filename, indexFile, key.first, megabytes << 20,
+                                           compressed ? IndexFormat::FRONT_CODED : IndexFormat::PLAIN))
+                        break;
+                }
+                break;
+            }
+            case 27: { // Поиск по индексу на диске
+                std::string filename, attribute, key;
+                std::cout << "Введите имя CSV-файла: ";
+                std::getline(std::cin, filename);
+                std::cout << "Атрибут поиска (1 - имя, 2 - город, 3 - телефон): ";
+                std::getline(std::cin, attribute);
+                const char* suffix = attribute == "1" ? ".name" : attribute == "2" ? ".city"
+                                   : attribute == "3" ? ".phone" : nullptr;
+                if(!suffix) {
+                    std::cout << "Неверный выбор атрибута.\n";
+                    break;
+                }
+                // Сжатый индекс предпочтительнее, если он построен
+                std::string base = filename + suffix;
+                bool compressed = std::filesystem::exists(base + ".fci");
+                DiskIndex index;
+                FrontCodedIndex compressedIndex;
+                MappedFile csv;
+                if(!(compressed ? compressedIndex.open(base + ".fci") : index.open(base + ".idx")) || !csv.open(filename)) {
+                    std::cout << "Индекс не найден. Постройте его пунктом 26.\n";
+                    break;
+                }
+                std::cout << "Введите значение для поиска: ";
+                std::getline(std::cin, key);
+                // Бинарный поиск по отображённому индексу; контакты читаются из CSV по смещениям строк
+                std::string_view text = csv.view();
+                ReportWriter report(std::cout, reportOptions);
+                auto printLine = [&](std::uint64_t offset) {
+                    if(offset >= text.size())
+                        return;
+                    std::string_view line = text.substr(offset);
+                    line = line.substr(0, line.find('\n'));
+                    parseContactsCsv(line, [&](const CsvRecord& record) {
+                        PackedPhone phone;
+                        PackedPhone::parse(record.phoneNumber, phone);
+                        report.write(ContactView{ record.id, record.name, phone, record.city, ContactStore::noCity });
+                    }, [](std::string_view) {});
+                };
+                std::size_t found = 0;
+                if(compressed) {
+                    found = compressedIndex.find(key, false, [&](std::string_view, int, std::uint64_t offset) { printLine(offset); });
+                }
+                else {
+                    auto range = index.equalRange(key);
+                    for(std::size_t i = range.first; i < range.second; ++i)
+                        printLine(index.lineOffset(i));
+                    found = range.second - range.first;
+                }
+                if(found == 0)
+                    report.heading("Контакт \"" + key + "\" не найден.\n");
+                break;
+            }
+            case 28: { // Сравнение двух наборов контактов и синхронизация
+                std::string firstFile, secondFile;
+                std::cout << "Введите имя первого файла (пусто - текущие контакты): ";
+                std::getline(std::cin, firstFile);
+                std::cout << "Введите имя второго файла: ";
+                std::getline(std::cin, secondFile);
+                if(secondFile.empty() || !std::filesystem::exists(secondFile) ||
+                   (!firstFile.empty() && !std::filesystem::exists(firstFile))) {
+                    std::cout << "Файл не найден.\n";
+                    break;
+                }
+                // Загрузка файлов для сравнения не сдвигает счётчик ID
+                int savedCounter = global_id_counter;
+                ContactStore first, second;
+                if(!firstFile.empty())
+                    loadContactsFromFile(first, firstFile);
+                loadContactsFromFile(second, secondFile);
+                global_id_counter = savedCounter;
+
+                const ContactStore& base = firstFile.empty() ? contacts : first;
+                ContactDiff diff = diffContacts(base, second);
+                printContactDiff(std::cout, base, second, diff);
+                std::cout << "Добавлено: " << diff.added.size() << ", удалено: " << diff.removed.size()
+                          << ", изменено: " << diff.changed.size() << "\n";
+                if(!firstFile.empty() || diff.empty())
+                    break;
+
+                std::string answer;
+                std::cout << "Применить изменения к текущим контактам? (1 - да, 0 - нет): ";
+                std::getline(std::cin, answer);
+                if(answer != "1")
+                    break;
+                std::vector<int> addedIds, changedIds;
+                std::unordered_set<int> removedIds;
+                for(std::size_t row : diff.added)
+                    addedIds.push_back(second.id(row));
+                for(std::size_t row : diff.removed) {
+                    journal.logDelete(contacts.id(row));
+                    removedIds.insert(contacts.id(row));
+                }
+                for(const auto& change : diff.changed)
+                    changedIds.push_back(contacts.id(change.first));
+                applyContactDiff(contacts, second, diff);
+                for(int id : changedIds)
+                    journal.logUpdate(contacts[contacts.rowOf(id)]);
+                for(int id : addedIds)
+                    journal.logInsert(contacts[contacts.rowOf(id)]);
+
+                // Индексы, дерево и список перестраиваются по одному разу на весь пакет
+                indices.buildIndices(contacts);
+                indices.sortIndices();
+                tree.buildFromIndex(indices.nameIndexAsc);
+                sortedList.removeIds(removedIds);
+                sortedList.updateAll(changedIds);
+                sortedList.insertAll(addedIds);
+                commitJournal();
+                std::cout << "Изменения применены.\n";
+                break;
+            }
+            case 29: { // Формат и страница вывода
+                std::string format, offset, limit;
+                std::cout << "Формат вывода (1 - текст, 2 - TSV, 3 - JSON Lines): ";
+                std::getline(std::cin, format);
+                std::cout << "Пропустить первых контактов (пусто - 0): ";
+                std::getline(std::cin, offset);
+                std::cout << "Контактов на странице (пусто или 0 - все): ";
+                std::getline(std::cin, limit);
+                reportOptions.format = format == "2" ? ReportFormat::TSV
+                                     : format == "3" ? ReportFormat::JSONL : ReportFormat::TEXT;
+                reportOptions.offset = std::strtoull(offset.c_str(), nullptr, 10);
+                reportOptions.limit = std::strtoull(limit.c_str(), nullptr, 10);
+                std::cout << "Настройки вывода сохранены.\n";
+                break;
+            }
+            case 30: { // Статистика операций
+                std::cout << "\nДлительность операций (мкс) и счётчики:\n";
+                operationStats().print(std::cout);
+                std::string answer;
+                std::cout << "Сбросить статистику? (y/n): ";
+                std::getline(std::cin, answer);
+                if(answer == "y" || answer == "Y") {
+                    operationStats().reset();
+                    std::cout << "Статистика сброшена.\n";
+                }
+                break;
+            }
+            case 31: { // Отчёт об использовании памяти
+                std::cout << "\nПамять структур данных:\n";
+                printMemoryReport({ { "контакты", contacts.memoryUsage() }, { "индексы", indices.memoryUsage() },
+                                    { "дерево", tree.memoryUsage() }, { "список", sortedList.memoryUsage() } },
+                                  std::cout);
                 break;
             }
             default:
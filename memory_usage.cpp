@@ -0,0 +1,85 @@
+// memory_usage.cpp
+
+#include "memory_usage.h"
+#include "report_writer.h"
+#include <iomanip>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// Учёт блока кучи
+void MemoryUsage::addBlock(std::size_t used, std::size_t requested) {
+    usedBytes += used;
+    heapBytes += heapBlockBytes(requested);
+}
+
+// Учёт одинаковых блоков кучи
+void MemoryUsage::addBlocks(std::size_t count, std::size_t used, std::size_t requested) {
+    usedBytes += count * used;
+    heapBytes += count * heapBlockBytes(requested);
+}
+
+// Учёт строки
+void MemoryUsage::addString(const std::string& text) {
+    // Строка во встроенном буфере указывает внутрь самого объекта
+    const char* data = text.data();
+    const char* object = reinterpret_cast<const char*>(&text);
+    if(data < object || data >= object + sizeof(text))
+        addBlock(text.size(), text.capacity() + 1);
+}
+
+// Размер блока распределителя
+std::size_t heapBlockBytes(std::size_t requested) {
+    const std::size_t mmapThreshold = 128 * 1024;
+    const std::size_t page = 4096;
+    if(requested == 0)
+        return 0;
+    if(requested + sizeof(std::size_t) >= mmapThreshold)
+        return (requested + 2 * sizeof(std::size_t) + page - 1) / page * page;
+    std::size_t chunk = (requested + sizeof(std::size_t) + 15) & ~static_cast<std::size_t>(15);
+    return chunk < 32 ? 32 : chunk;
+}
+
+// Куча процесса
+std::size_t processHeapBytes() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = ::mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+// Вывод отчёта о памяти
+void printMemoryReport(const std::vector<std::pair<std::string, MemoryUsage>>& structures, std::ostream& out) {
+    auto kilobytes = [](std::size_t bytes) { return static_cast<double>(bytes) / 1024.0; };
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1);
+    writeColumn(out, "структура", 16, true);
+    writeColumn(out, "элементов", 12, false);
+    for(const char* column : { "занято,КиБ", "куча,КиБ", "накладные,КиБ" })
+        writeColumn(out, column, 15, false);
+    writeColumn(out, "байт/элем", 12, false);
+    out << "\n";
+    MemoryUsage total;
+    auto line = [&](const std::string& name, const MemoryUsage& usage) {
+        writeColumn(out, name, 16, true);
+        out << std::right << std::setw(12) << usage.elements
+            << std::setw(15) << kilobytes(usage.usedBytes) << std::setw(15) << kilobytes(usage.heapBytes)
+            << std::setw(15) << kilobytes(usage.overheadBytes()) << std::setw(12)
+            << (usage.elements > 0 ? static_cast<double>(usage.heapBytes) / usage.elements : 0.0) << "\n";
+    };
+    for(const auto& structure : structures) {
+        line(structure.first, structure.second);
+        total += structure.second;
+    }
+    line("итого", total);
+    if(std::size_t heap = processHeapBytes()) {
+        // Значение под колонкой байт кучи
+        writeColumn(out, "куча процесса", 16, true);
+        out << std::right << std::setw(42) << kilobytes(heap) << "\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
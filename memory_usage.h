@@ -0,0 +1,127 @@
+// memory_usage.h
+
+#ifndef MEMORY_USAGE_H
+#define MEMORY_USAGE_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <utility>
+#include <ostream>
+#include <cstddef>
+
+/**
+ * @struct MemoryUsage
+ * @brief Объём памяти, занятой структурой данных.
+ *
+ * Байты в куче оцениваются по вместимости контейнеров и строк (строки в
+ * пределах встроенного буфера кучу не занимают) с учётом округления блоков
+ * распределителем glibc. Разница между ними и полезными байтами -
+ * накладные расходы структуры: незанятая вместимость, указатели узлов,
+ * таблицы корзин и заголовки блоков.
+ */
+struct MemoryUsage {
+    std::size_t elements = 0;   ///< Записей или узлов
+    std::size_t usedBytes = 0;  ///< Полезных байт: размеры элементов и длины строк
+    std::size_t heapBytes = 0;  ///< Байт, выделенных в куче
+
+    /**
+     * @brief Возвращает накладные расходы.
+     * @return heapBytes - usedBytes (0, если оценка кучи меньше).
+     */
+    std::size_t overheadBytes() const { return heapBytes > usedBytes ? heapBytes - usedBytes : 0; }
+
+    /**
+     * @brief Добавляет объём другой структуры.
+     * @param other Объём.
+     * @return Ссылка на себя.
+     */
+    MemoryUsage& operator+=(const MemoryUsage& other) {
+        elements += other.elements;
+        usedBytes += other.usedBytes;
+        heapBytes += other.heapBytes;
+        return *this;
+    }
+
+    /**
+     * @brief Учитывает блок кучи.
+     * @param used Полезных байт в блоке.
+     * @param requested Запрошенный размер блока.
+     */
+    void addBlock(std::size_t used, std::size_t requested);
+
+    /**
+     * @brief Учитывает одинаковые блоки кучи за O(1).
+     * @param count Количество блоков.
+     * @param used Полезных байт в каждом блоке.
+     * @param requested Запрошенный размер каждого блока.
+     */
+    void addBlocks(std::size_t count, std::size_t used, std::size_t requested);
+
+    /**
+     * @brief Учитывает символы строки, вынесенные в кучу.
+     * Объект строки и символы во встроенном буфере учитываются в содержащем её элементе.
+     * @param text Строка.
+     */
+    void addString(const std::string& text);
+
+    /**
+     * @brief Учитывает буфер вектора; элементы, владеющие памятью, учитываются отдельно.
+     * @param values Вектор.
+     */
+    template<typename T>
+    void addVector(const std::vector<T>& values) {
+        if(values.capacity() > 0)
+            addBlock(values.size() * sizeof(T), values.capacity() * sizeof(T));
+    }
+
+    /**
+     * @brief Учитывает блоки дека (libstdc++ хранит элементы блоками по 512 байт) и его карту.
+     * @param values Дек.
+     */
+    template<typename T>
+    void addDeque(const std::deque<T>& values) {
+        std::size_t perBlock = sizeof(T) < 512 ? 512 / sizeof(T) : 1;
+        std::size_t blocks = values.size() / perBlock + 1;
+        addBlocks(blocks, 0, perBlock * sizeof(T));
+        usedBytes += values.size() * sizeof(T);
+        addBlock(0, (blocks + 2) * sizeof(void*));
+    }
+
+    /**
+     * @brief Учитывает узлы и таблицу корзин хэш-таблицы libstdc++.
+     * Узел содержит указатель на следующий, значение и, для нетривиальных хэшей, сохранённый хэш.
+     * @param table Хэш-таблица.
+     * @param cachedHash Хранит ли узел хэш ключа.
+     */
+    template<typename Table>
+    void addHashTable(const Table& table, bool cachedHash) {
+        std::size_t node = sizeof(void*) + sizeof(typename Table::value_type) + (cachedHash ? sizeof(std::size_t) : 0);
+        addBlocks(table.size(), sizeof(typename Table::value_type), node);
+        if(table.bucket_count() > 1)
+            addBlock(0, table.bucket_count() * sizeof(void*));
+    }
+};
+
+/**
+ * @brief Возвращает размер блока, который распределитель glibc выделяет под запрос.
+ * Малые блоки - с заголовком и выравниванием по 16 байт, крупные (от 128 КБ) - страницами.
+ * @param requested Запрошенный размер.
+ * @return Размер блока в байтах.
+ */
+std::size_t heapBlockBytes(std::size_t requested);
+
+/**
+ * @brief Возвращает объём кучи процесса по данным распределителя.
+ * @return Занятые байты или 0, если распределитель их не сообщает.
+ */
+std::size_t processHeapBytes();
+
+/**
+ * @brief Выводит отчёт о памяти: по строке на структуру, итог и кучу процесса.
+ * @param structures Названия и объёмы структур.
+ * @param out Поток вывода.
+ */
+void printMemoryReport(const std::vector<std::pair<std::string, MemoryUsage>>& structures, std::ostream& out);
+
+#endif // MEMORY_USAGE_H
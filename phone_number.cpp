@@ -0,0 +1,90 @@
+// phone_number.cpp
+
+#include "phone_number.h"
+#include <cstring>
+
+namespace {
+    constexpr std::uint64_t asciiZeros = 0x3030303030303030ULL;  // '0' в каждом байте
+    constexpr std::uint64_t digitBias = 0x7676767676767676ULL;   // 0x80 - 10 в каждом байте
+    constexpr std::uint64_t highBits = 0x8080808080808080ULL;
+
+    // Проверка, что все 8 байт слова являются цифрами '0'-'9'
+    bool isDigitWord(std::uint64_t word) {
+        // После XOR цифры превращаются в значения 0-9, остальные символы - в 10-255
+        std::uint64_t values = word ^ asciiZeros;
+        // Прибавление 0x76 выставляет старший бит у значений >= 10; значения
+        // со старшим битом переносят его в соседний байт, но и так ошибочны
+        return (((values + digitBias) | values) & highBits) == 0;
+    }
+
+    // Загрузка до 16 символов в два слова, недостающие байты заполняются '0'
+    void loadBlock(std::string_view text, std::uint64_t& low, std::uint64_t& high) {
+        char block[16];
+        std::memset(block, '0', sizeof(block));
+        std::memcpy(block, text.data(), text.size());
+        std::memcpy(&low, block, 8);
+        std::memcpy(&high, block + 8, 8);
+    }
+
+    // Проверка строки длиной до 16 символов: только цифры
+    bool allDigits(std::string_view text) {
+        std::uint64_t low, high;
+        loadBlock(text, low, high);
+        return isDigitWord(low) && isDigitWord(high);
+    }
+
+    // Упаковка цифр в старшие полубайты, остальные полубайты заполняются fill
+    std::uint64_t packDigits(std::string_view digits, std::uint64_t fill) {
+        std::uint64_t packed = 0;
+        for(std::size_t i = 0; i < 16; ++i) {
+            std::uint64_t nibble = i < digits.size() ? static_cast<std::uint64_t>(digits[i] - '0') : fill;
+            packed = (packed << 4) | nibble;
+        }
+        return packed;
+    }
+}
+
+// Проверка формата номера телефона
+bool validatePhoneDigits(std::string_view text) {
+    if(text.size() < PackedPhone::minDigits || text.size() > PackedPhone::maxDigits)
+        return false;
+    return allDigits(text);
+}
+
+// Проверка и упаковка номера
+bool PackedPhone::parse(std::string_view text, PackedPhone& phone) {
+    if(!validatePhoneDigits(text))
+        return false;
+    // Младший полубайт (16-й) заменяется длиной номера
+    phone.bits = packDigits(text, 0) | text.size();
+    return true;
+}
+
+// Диапазон номеров с заданным префиксом
+bool PackedPhone::prefixRange(std::string_view prefix, PackedPhone& low, PackedPhone& high) {
+    if(prefix.size() > maxDigits || !allDigits(prefix))
+        return false;
+    low.bits = packDigits(prefix, 0);
+    high.bits = packDigits(prefix, 0xF);
+    return true;
+}
+
+// Запись цифр в буфер
+std::size_t PackedPhone::format(char* out) const {
+    std::size_t count = length();
+    for(std::size_t i = 0; i < count; ++i)
+        out[i] = static_cast<char>('0' + ((bits >> (60 - 4 * i)) & 0xF));
+    return count;
+}
+
+// Номер в виде строки
+std::string PackedPhone::str() const {
+    char buffer[maxDigits];
+    return std::string(buffer, format(buffer));
+}
+
+// Вывод номера в поток
+std::ostream& operator<<(std::ostream& os, PackedPhone phone) {
+    char buffer[PackedPhone::maxDigits];
+    return os.write(buffer, static_cast<std::streamsize>(phone.format(buffer)));
+}
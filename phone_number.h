@@ -0,0 +1,136 @@
+// phone_number.h
+
+#ifndef PHONE_NUMBER_H
+#define PHONE_NUMBER_H
+
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+/**
+ * @class PackedPhone
+ * @brief Номер телефона, упакованный в 64-битное целое.
+ *
+ * Цифры хранятся в двоично-десятичном виде (по 4 бита на цифру), начиная со
+ * старшего полубайта, а младший полубайт содержит количество цифр. Номер из
+ * 7-15 цифр занимает 8 байт вместо строки, а сравнение целых значений
+ * совпадает с лексикографическим сравнением исходных строк.
+ */
+class PackedPhone {
+private:
+    std::uint64_t bits; ///< Цифры в старших полубайтах и длина в младшем
+
+public:
+    static constexpr std::size_t minDigits = 7;  ///< Минимальное количество цифр
+    static constexpr std::size_t maxDigits = 15; ///< Максимальное количество цифр
+
+    /**
+     * @brief Конструктор пустого номера (0 цифр).
+     */
+    PackedPhone() : bits(0) {}
+
+    /**
+     * @brief Проверяет строку и упаковывает её в номер.
+     * @param text Строка из 7-15 цифр.
+     * @param phone Результат упаковки (не изменяется при ошибке).
+     * @return true, если строка является корректным номером.
+     */
+    static bool parse(std::string_view text, PackedPhone& phone);
+
+    /**
+     * @brief Вычисляет диапазон упакованных значений номеров, начинающихся с префикса.
+     * Оставшиеся полубайты нижней границы заполняются нулями, верхней - единицами,
+     * поэтому все такие номера лежат в отрезке [low, high] и только они.
+     * @param prefix Строка из 0-15 цифр.
+     * @param low Нижняя граница диапазона.
+     * @param high Верхняя граница диапазона.
+     * @return true, если префикс корректный.
+     */
+    static bool prefixRange(std::string_view prefix, PackedPhone& low, PackedPhone& high);
+
+    /**
+     * @brief Создаёт номер из упакованного значения.
+     * @param bits Упакованное значение.
+     * @return Номер телефона.
+     */
+    static PackedPhone fromBits(std::uint64_t bits) {
+        PackedPhone phone;
+        phone.bits = bits;
+        return phone;
+    }
+
+    /**
+     * @brief Возвращает упакованное значение.
+     * @return 64-битное представление номера.
+     */
+    std::uint64_t packed() const { return bits; }
+
+    /**
+     * @brief Возвращает количество цифр.
+     * @return Длина номера.
+     */
+    std::size_t length() const { return static_cast<std::size_t>(bits & 0xF); }
+
+    /**
+     * @brief Проверяет, пуст ли номер.
+     * @return true, если номер не содержит цифр.
+     */
+    bool empty() const { return length() == 0; }
+
+    /**
+     * @brief Записывает цифры номера в буфер.
+     * @param out Буфер не менее чем на maxDigits символов.
+     * @return Количество записанных символов.
+     */
+    std::size_t format(char* out) const;
+
+    /**
+     * @brief Возвращает номер в виде строки.
+     * @return Строка цифр.
+     */
+    std::string str() const;
+
+    bool operator==(PackedPhone other) const { return bits == other.bits; }
+    bool operator!=(PackedPhone other) const { return bits != other.bits; }
+    bool operator<(PackedPhone other) const { return bits < other.bits; }
+    bool operator>(PackedPhone other) const { return bits > other.bits; }
+    bool operator<=(PackedPhone other) const { return bits <= other.bits; }
+    bool operator>=(PackedPhone other) const { return bits >= other.bits; }
+};
+
+/**
+ * @brief Проверяет строку номера телефона: 7-15 символов, только цифры.
+ * Все символы проверяются одновременно как два 64-битных слова (SWAR).
+ * @param text Строка для проверки.
+ * @return true, если формат корректный.
+ */
+bool validatePhoneDigits(std::string_view text);
+
+/**
+ * @brief Выводит цифры номера в поток.
+ * @param os Поток вывода.
+ * @param phone Номер телефона.
+ * @return Поток вывода.
+ */
+std::ostream& operator<<(std::ostream& os, PackedPhone phone);
+
+namespace std {
+    /**
+     * @brief Хеш упакованного номера: перемешивание 64-битного значения.
+     */
+    template<>
+    struct hash<PackedPhone> {
+        std::size_t operator()(PackedPhone phone) const {
+            std::uint64_t x = phone.packed();
+            x ^= x >> 33;
+            x *= 0xff51afd7ed558ccdULL;
+            x ^= x >> 33;
+            return static_cast<std::size_t>(x);
+        }
+    };
+}
+
+#endif // PHONE_NUMBER_H
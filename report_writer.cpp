@@ -0,0 +1,177 @@
+// report_writer.cpp
+
+#include "report_writer.h"
+#include <iostream>
+#include <charconv>
+
+namespace {
+    // Добавление целого числа в десятичной записи
+    void appendInt(std::string& buffer, long long value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        buffer.append(digits, static_cast<std::size_t>(result.ptr - digits));
+    }
+
+    // Добавление номера телефона из упакованных цифр
+    void appendPhone(std::string& buffer, PackedPhone phone) {
+        char digits[PackedPhone::maxDigits];
+        buffer.append(digits, phone.format(digits));
+    }
+}
+
+// Конструктор
+ReportWriter::ReportWriter(std::ostream& out, const ReportOptions& options)
+    : out(out), options(options), skipped(0), written(0), truncated(false) {
+    buffer.reserve(bufferSize + 256);
+    if(options.format == ReportFormat::TSV)
+        buffer.append("id\tname\tphone\tcity\n");
+}
+
+// Деструктор
+ReportWriter::~ReportWriter() {
+    if(truncated && options.format == ReportFormat::TEXT) {
+        buffer.append("Показаны контакты ");
+        appendInt(buffer, static_cast<long long>(options.offset + 1));
+        buffer.append("-");
+        appendInt(buffer, static_cast<long long>(options.offset + written));
+        buffer.append("; остальные - на следующих страницах.\n");
+    }
+    flush();
+}
+
+// Экранирование строки
+void ReportWriter::appendEscaped(std::string_view text) {
+    if(options.format == ReportFormat::TEXT) {
+        buffer.append(text);
+        return;
+    }
+    // Обычные символы копируются отрезками, экранируются только служебные
+    static const char hex[] = "0123456789abcdef";
+    bool json = options.format == ReportFormat::JSONL;
+    std::size_t start = 0;
+    for(std::size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        bool special = c < 0x20 || c == '\\' || (json && c == '"');
+        if(!special)
+            continue;
+        buffer.append(text.data() + start, i - start);
+        start = i + 1;
+        buffer.push_back('\\');
+        switch(c) {
+            case '\t': buffer.push_back('t'); break;
+            case '\n': buffer.push_back('n'); break;
+            case '\r': buffer.push_back('r'); break;
+            case '\\': buffer.push_back('\\'); break;
+            case '"': buffer.push_back('"'); break;
+            default:
+                if(json) {
+                    buffer.append("u00");
+                    buffer.push_back(hex[c >> 4]);
+                    buffer.push_back(hex[c & 0xf]);
+                }
+                else {
+                    buffer.push_back('x');
+                    buffer.push_back(hex[c >> 4]);
+                    buffer.push_back(hex[c & 0xf]);
+                }
+        }
+    }
+    buffer.append(text.data() + start, text.size() - start);
+}
+
+// Вывод контакта
+bool ReportWriter::write(const ContactView& contact) {
+    if(full()) {
+        truncated = true;
+        return false;
+    }
+    if(skipped < options.offset) {
+        ++skipped;
+        return true;
+    }
+    switch(options.format) {
+        case ReportFormat::TEXT:
+            buffer.append("ID: ");
+            appendInt(buffer, contact.id);
+            buffer.append("\nИмя: ");
+            buffer.append(contact.name);
+            buffer.append("\nНомер телефона: ");
+            appendPhone(buffer, contact.phoneNumber);
+            buffer.append("\nГород: ");
+            buffer.append(contact.city);
+            buffer.append("\n-----------------------------\n");
+            break;
+        case ReportFormat::TSV:
+            appendInt(buffer, contact.id);
+            buffer.push_back('\t');
+            appendEscaped(contact.name);
+            buffer.push_back('\t');
+            appendPhone(buffer, contact.phoneNumber);
+            buffer.push_back('\t');
+            appendEscaped(contact.city);
+            buffer.push_back('\n');
+            break;
+        case ReportFormat::JSONL:
+            buffer.append("{\"id\":");
+            appendInt(buffer, contact.id);
+            buffer.append(",\"name\":\"");
+            appendEscaped(contact.name);
+            buffer.append("\",\"phone\":\"");
+            appendPhone(buffer, contact.phoneNumber);
+            buffer.append("\",\"city\":\"");
+            appendEscaped(contact.city);
+            buffer.append("\"}\n");
+            break;
+    }
+    ++written;
+    if(buffer.size() >= bufferSize)
+        flush();
+    return true;
+}
+
+// Вывод контакта по ID
+bool ReportWriter::write(const ContactStore& contacts, int id) {
+    std::size_t row = contacts.rowOf(id);
+    if(row == ContactStore::npos) {
+        std::cerr << "Ошибка: Контакт с ID " << id << " не найден.\n";
+        return !full();
+    }
+    return write(contacts[row]);
+}
+
+// Вывод контактов по списку ID
+void ReportWriter::write(const ContactStore& contacts, const std::vector<int>& ids) {
+    for(int id : ids) {
+        if(!write(contacts, id))
+            break;
+    }
+}
+
+// Поясняющий текст
+void ReportWriter::heading(std::string_view text) {
+    if(options.format == ReportFormat::TEXT)
+        buffer.append(text);
+}
+
+// Передача буфера в поток
+void ReportWriter::flush() {
+    if(buffer.empty())
+        return;
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+}
+
+// Вывод колонки таблицы
+void writeColumn(std::ostream& out, std::string_view text, std::size_t width, bool alignLeft) {
+    // Байты продолжения UTF-8 (10xxxxxx) не начинают новый символ
+    std::size_t length = 0;
+    for(char c : text) {
+        if((static_cast<unsigned char>(c) & 0xC0) != 0x80)
+            ++length;
+    }
+    std::string padding(length < width ? width - length : 0, ' ');
+    if(alignLeft)
+        out << text << padding;
+    else
+        out << padding << text;
+}
@@ -0,0 +1,136 @@
+// report_writer.h
+
+#ifndef REPORT_WRITER_H
+#define REPORT_WRITER_H
+
+#include "contact_store.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <ostream>
+#include <cstddef>
+
+/**
+ * @enum ReportFormat
+ * @brief Формат вывода контактов.
+ */
+enum class ReportFormat {
+    TEXT,   ///< Карточки "ID: ...", "Имя: ..." для чтения человеком
+    TSV,    ///< Строка заголовка и строки полей через табуляцию
+    JSONL   ///< Один JSON-объект на строку (JSON Lines)
+};
+
+/**
+ * @struct ReportOptions
+ * @brief Формат и страница вывода.
+ */
+struct ReportOptions {
+    ReportFormat format = ReportFormat::TEXT;   ///< Формат вывода
+    std::size_t offset = 0;                     ///< Сколько первых контактов пропустить
+    std::size_t limit = 0;                      ///< Наибольшее число выводимых контактов (0 - без ограничения)
+};
+
+/**
+ * @class ReportWriter
+ * @brief Общий буферизованный вывод контактов для всех функций печати.
+ *
+ * Контакты форматируются в буфер большого размера (числа - через
+ * std::to_chars) и передаются в поток крупными блоками вместо нескольких
+ * операторов << на каждое поле. Писатель отсчитывает страницу offset/limit:
+ * write возвращает false, когда страница заполнена, и обход можно прервать.
+ */
+class ReportWriter {
+private:
+    std::ostream& out;          ///< Поток вывода
+    ReportOptions options;      ///< Формат и страница
+    std::string buffer;         ///< Ещё не выведенные данные
+    std::size_t skipped;        ///< Пропущено контактов до начала страницы
+    std::size_t written;        ///< Выведено контактов
+    bool truncated;             ///< За страницей остались контакты
+
+    /**
+     * @brief Добавляет строку с экранированием для формата.
+     * @param text Строка.
+     */
+    void appendEscaped(std::string_view text);
+
+public:
+    /**
+     * @brief Размер буфера, при заполнении которого данные передаются в поток.
+     */
+    static constexpr std::size_t bufferSize = 1 << 20;
+
+    /**
+     * @brief Конструктор. Для TSV сразу выводит строку заголовка.
+     * @param out Поток вывода.
+     * @param options Формат и страница.
+     */
+    explicit ReportWriter(std::ostream& out, const ReportOptions& options = ReportOptions());
+
+    /**
+     * @brief Деструктор. Выводит остаток буфера.
+     */
+    ~ReportWriter();
+
+    ReportWriter(const ReportWriter&) = delete;
+    ReportWriter& operator=(const ReportWriter&) = delete;
+
+    /**
+     * @brief Выводит контакт, если он попадает в страницу.
+     * @param contact Контакт.
+     * @return false, если страница заполнена и дальнейшие контакты не выводятся.
+     */
+    bool write(const ContactView& contact);
+
+    /**
+     * @brief Выводит контакт по ID; отсутствующий ID сообщается в std::cerr.
+     * @param contacts Хранилище контактов.
+     * @param id ID контакта.
+     * @return false, если страница заполнена.
+     */
+    bool write(const ContactStore& contacts, int id);
+
+    /**
+     * @brief Выводит контакты по списку ID.
+     * @param contacts Хранилище контактов.
+     * @param ids ID контактов в порядке вывода.
+     */
+    void write(const ContactStore& contacts, const std::vector<int>& ids);
+
+    /**
+     * @brief Выводит поясняющий текст; в машиночитаемых форматах он опускается.
+     * @param text Текст.
+     */
+    void heading(std::string_view text);
+
+    /**
+     * @brief Проверяет, заполнена ли страница.
+     * @return true, если следующий контакт выведен не будет.
+     */
+    bool full() const { return options.limit != 0 && written >= options.limit; }
+
+    /**
+     * @brief Возвращает количество выведенных контактов.
+     * @return Количество контактов.
+     */
+    std::size_t count() const { return written; }
+
+    /**
+     * @brief Передаёт буфер в поток.
+     * Сам поток не сбрасывается: это решает вызывающий код (для std::cout -
+     * связь с std::cin, в пакетном режиме - один сброс на пакет команд).
+     */
+    void flush();
+};
+
+/**
+ * @brief Выводит текст колонкой таблицы. Ширина считается в символах UTF-8,
+ * а не в байтах, поэтому колонки с кириллицей выравниваются так же, как с латиницей.
+ * @param out Поток вывода.
+ * @param text Текст.
+ * @param width Ширина колонки в символах.
+ * @param alignLeft true - выравнивание по левому краю, иначе по правому.
+ */
+void writeColumn(std::ostream& out, std::string_view text, std::size_t width, bool alignLeft);
+
+#endif // REPORT_WRITER_H
@@ -0,0 +1,382 @@
+// server.cpp
+
+#include "server.h"
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include <chrono>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace {
+    // Адрес сокета Unix по пути
+    bool makeAddress(const std::string& path, sockaddr_un& address) {
+        if(path.empty() || path.size() >= sizeof(address.sun_path)) {
+            std::cerr << "Некорректный путь сокета: " << path << "\n";
+            return false;
+        }
+        address = sockaddr_un();
+        address.sun_family = AF_UNIX;
+        path.copy(address.sun_path, path.size());
+        return true;
+    }
+
+#if defined(MSG_NOSIGNAL)
+    const int sendFlags = MSG_NOSIGNAL;     // SIGPIPE при разрыве соединения не посылается
+#else
+    const int sendFlags = 0;                // SIGPIPE отключается на сокете (suppressSigpipe)
+#endif
+
+    // Установка флагов дескриптора: закрытие при exec и, если нужно, неблокирующий режим
+    bool setDescriptorFlags(int fd, bool nonblocking) {
+        if(::fcntl(fd, F_SETFD, FD_CLOEXEC) != 0)
+            return false;
+        if(!nonblocking)
+            return true;
+        int flags = ::fcntl(fd, F_GETFL);
+        return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    // Отключение SIGPIPE на сокете там, где у send нет флага MSG_NOSIGNAL (macOS)
+    void suppressSigpipe(int fd) {
+#if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+        int enabled = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &enabled, sizeof(enabled));
+#else
+        (void)fd;
+#endif
+    }
+
+    const int sendTimeoutMs = 5000;         // Наибольшее время отправки ответа клиенту, который не читает
+    const std::size_t maxLineBytes = 1 << 16;   // Наибольшая длина команды
+    const std::size_t flushBytes = 1 << 16;     // Объём ответов, после которого они отправляются клиенту
+
+    // Отправка всех данных; неблокирующий сокет ждёт готовности через poll не дольше
+    // sendTimeoutMs, чтобы клиент, переставший читать, не занимал поток пула
+    bool sendAll(int fd, const char* data, std::size_t size) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(sendTimeoutMs);
+        while(size > 0) {
+            ssize_t sent = ::send(fd, data, size, sendFlags);
+            if(sent > 0) {
+                data += sent;
+                size -= static_cast<std::size_t>(sent);
+            }
+            else if(sent < 0 && errno == EAGAIN) {
+                auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count();
+                pollfd waiting{ fd, POLLOUT, 0 };
+                if(left <= 0 || (::poll(&waiting, 1, static_cast<int>(left)) == 0))
+                    return false;
+            }
+            else if(sent < 0 && errno == EINTR) {
+                continue;
+            }
+            else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Проверка, завершает ли строка ответ сервера
+    bool isResponseEnd(std::string_view line) {
+        return line == "ok" || line.substr(0, 3) == "ok " || line.substr(0, 6) == "error:";
+    }
+}
+
+// Конструктор
+ContactServer::ContactServer(BatchSession& session, ThreadPool& pool)
+    : session(session), pool(pool), listenFd(-1), wakeFds{ -1, -1 }, stopping(false), handled(0) {
+    if(::pipe(wakeFds) != 0 || !setDescriptorFlags(wakeFds[0], true) || !setDescriptorFlags(wakeFds[1], true)) {
+        std::cerr << "Не удалось создать канал пробуждения сервера\n";
+        for(int& fd : wakeFds) {
+            if(fd >= 0)
+                ::close(fd);
+            fd = -1;
+        }
+    }
+}
+
+// Деструктор
+ContactServer::~ContactServer() {
+    if(listenFd >= 0) {
+        ::close(listenFd);
+        ::unlink(socketPath.c_str());
+    }
+    for(int fd : wakeFds) {
+        if(fd >= 0)
+            ::close(fd);
+    }
+}
+
+// Создание слушающего сокета
+bool ContactServer::listen(const std::string& path) {
+    sockaddr_un address;
+    if(!makeAddress(path, address) || wakeFds[0] < 0)
+        return false;
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if(listenFd < 0 || !setDescriptorFlags(listenFd, true)) {
+        std::cerr << "Не удалось создать сокет: " << path << "\n";
+        if(listenFd >= 0)
+            ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    ::unlink(path.c_str());
+    if(::bind(listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+       ::listen(listenFd, SOMAXCONN) != 0) {
+        std::cerr << "Не удалось открыть сокет для соединений: " << path << "\n";
+        ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    socketPath = path;
+    return true;
+}
+
+// Выполнение одной команды
+void ContactServer::handle(Connection& connection, const std::string& line, std::ostream& out) {
+    if(BatchSession::isQuery(line)) {
+        // Устаревшие индексы перестраиваются под исключительной блокировкой, после
+        // чего запрос выполняется параллельно с другими запросами
+        std::shared_lock<std::shared_mutex> reading(access);
+        while(!session.isPrepared(line)) {
+            reading.unlock();
+            {
+                std::unique_lock<std::shared_mutex> writing(access);
+                if(!session.isPrepared(line))
+                    session.prepare(line);
+            }
+            reading.lock();
+        }
+        session.query(line, connection.options, out);
+        return;
+    }
+    std::unique_lock<std::shared_mutex> writing(access);
+    if(!session.execute(line, connection.options, out)) {
+        // quit подтверждается, чтобы клиент не ждал ответа до закрытия соединения
+        out << "ok\n";
+        connection.closed = true;
+    }
+}
+
+// Обработка команд соединения
+void ContactServer::serve(Connection& connection) {
+    char chunk[1 << 16];
+    std::ostringstream out;
+    bool sendFailed = false;
+    // Отправка накопленных ответов
+    auto flush = [&]() {
+        std::string response = out.str();
+        out.str(std::string());
+        if(!sendAll(connection.fd, response.data(), response.size())) {
+            sendFailed = true;
+            connection.closed = true;
+        }
+    };
+    // Команда длиннее maxLineBytes отклоняется, соединение закрывается
+    auto rejectLine = [&]() {
+        out << "error: строка длиннее " << maxLineBytes << " байт\n";
+        connection.closed = true;
+    };
+
+    // Команды выполняются по мере чтения, ответы отправляются блоками не меньше flushBytes,
+    // поэтому длинный сценарий получает ответы до своего окончания
+    bool eof = false;
+    while(!connection.closed) {
+        ssize_t received = ::read(connection.fd, chunk, sizeof(chunk));
+        if(received < 0 && errno == EINTR)
+            continue;
+        if(received <= 0) {
+            // Конец данных или ошибка; EAGAIN - всё доступное прочитано
+            eof = received == 0 || errno != EAGAIN;
+            break;
+        }
+        connection.input.append(chunk, static_cast<std::size_t>(received));
+        std::size_t start = 0, end;
+        while(!connection.closed && (end = connection.input.find('\n', start)) != std::string::npos) {
+            if(end - start > maxLineBytes) {
+                rejectLine();
+                break;
+            }
+            std::string line = connection.input.substr(start, end - start);
+            start = end + 1;
+            handle(connection, line, out);
+            ++handled;
+            if(static_cast<std::size_t>(out.tellp()) >= flushBytes)
+                flush();
+        }
+        connection.input.erase(0, start);
+        if(!connection.closed && connection.input.size() > maxLineBytes)
+            rejectLine();
+    }
+    if(!sendFailed)
+        flush();
+    if(eof)
+        connection.closed = true;
+}
+
+// Возврат соединения потоку run
+void ContactServer::giveBack(Connection* connection) {
+    {
+        std::lock_guard<std::mutex> lock(returnedMutex);
+        returned.push_back(connection);
+    }
+    char signal = 1;
+    ssize_t ignored = ::write(wakeFds[1], &signal, 1);
+    (void)ignored;
+}
+
+// Цикл приёма соединений и команд
+void ContactServer::run() {
+    std::unordered_map<Connection*, std::unique_ptr<Connection>> connections;
+    std::vector<Connection*> idle;      // Соединения, ожидающие команд
+    std::vector<pollfd> waiting;
+    while(!stopping) {
+        waiting.clear();
+        waiting.push_back(pollfd{ listenFd, POLLIN, 0 });
+        waiting.push_back(pollfd{ wakeFds[0], POLLIN, 0 });
+        for(Connection* connection : idle)
+            waiting.push_back(pollfd{ connection->fd, POLLIN, 0 });
+        if(::poll(waiting.data(), waiting.size(), -1) < 0) {
+            if(errno == EINTR)
+                continue;
+            std::cerr << "Ошибка ожидания соединений сервера\n";
+            break;
+        }
+
+        // Соединения с пришедшими командами передаются пулу и не ожидаются, пока их обрабатывают
+        std::size_t kept = 0;
+        for(std::size_t i = 0; i < idle.size(); ++i) {
+            Connection* connection = idle[i];
+            if(waiting[i + 2].revents == 0) {
+                idle[kept++] = connection;
+                continue;
+            }
+            pool.submit([this, connection]() {
+                serve(*connection);
+                giveBack(connection);
+            });
+        }
+        idle.resize(kept);
+
+        if(waiting[1].revents != 0) {
+            char drain[256];
+            while(::read(wakeFds[0], drain, sizeof(drain)) > 0) {}
+            std::vector<Connection*> done;
+            {
+                std::lock_guard<std::mutex> lock(returnedMutex);
+                done.swap(returned);
+            }
+            for(Connection* connection : done) {
+                if(connection->closed) {
+                    ::close(connection->fd);
+                    connections.erase(connection);
+                }
+                else {
+                    idle.push_back(connection);
+                }
+            }
+        }
+
+        if(waiting[0].revents != 0) {
+            int fd;
+            while((fd = ::accept(listenFd, nullptr, nullptr)) >= 0) {
+                // Флаги слушающего сокета наследуются не на всех системах
+                if(!setDescriptorFlags(fd, true)) {
+                    ::close(fd);
+                    continue;
+                }
+                suppressSigpipe(fd);
+                auto connection = std::make_unique<Connection>();
+                connection->fd = fd;
+                idle.push_back(connection.get());
+                connections.emplace(connection.get(), std::move(connection));
+            }
+        }
+    }
+
+    // Начатые команды завершаются до закрытия соединений
+    pool.wait();
+    for(auto& entry : connections)
+        ::close(entry.second->fd);
+    std::lock_guard<std::mutex> lock(returnedMutex);
+    returned.clear();
+}
+
+// Запрос остановки
+void ContactServer::stop() {
+    stopping = true;
+    char signal = 0;
+    ssize_t ignored = ::write(wakeFds[1], &signal, 1);
+    (void)ignored;
+}
+
+// Конструктор клиента
+ServerClient::ServerClient() : fd(-1), scanned(0), lineStart(0) {}
+
+// Деструктор клиента
+ServerClient::~ServerClient() {
+    if(fd >= 0)
+        ::close(fd);
+}
+
+// Подключение к серверу
+bool ServerClient::connect(const std::string& path) {
+    sockaddr_un address;
+    if(!makeAddress(path, address))
+        return false;
+    fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd >= 0) {
+        setDescriptorFlags(fd, false);
+        suppressSigpipe(fd);
+    }
+    if(fd < 0 || ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        std::cerr << "Не удалось подключиться к серверу: " << path << "\n";
+        if(fd >= 0)
+            ::close(fd);
+        fd = -1;
+        return false;
+    }
+    return true;
+}
+
+// Отправка команды
+bool ServerClient::send(std::string_view line) {
+    std::string message(line);
+    message.push_back('\n');
+    return fd >= 0 && sendAll(fd, message.data(), message.size());
+}
+
+// Приём ответа
+bool ServerClient::receive(std::string& response) {
+    char chunk[1 << 16];
+    while(fd >= 0) {
+        // Строки просматриваются один раз, даже если ответ приходит частями
+        std::size_t end;
+        while((end = buffer.find('\n', scanned)) != std::string::npos) {
+            scanned = end + 1;
+            std::string_view line(buffer.data() + lineStart, end - lineStart);
+            lineStart = scanned;
+            if(isResponseEnd(line)) {
+                response.assign(buffer, 0, scanned);
+                buffer.erase(0, scanned);
+                scanned = lineStart = 0;
+                return true;
+            }
+        }
+        scanned = buffer.size();
+        ssize_t received = ::read(fd, chunk, sizeof(chunk));
+        if(received > 0)
+            buffer.append(chunk, static_cast<std::size_t>(received));
+        else if(received < 0 && errno == EINTR)
+            continue;
+        else
+            return false;
+    }
+    return false;
+}
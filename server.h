@@ -0,0 +1,179 @@
+// server.h
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "batch.h"
+#include "thread_pool.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @class ContactServer
+ * @brief Сервер запросов к контактам на локальном сокете Unix.
+ *
+ * Протокол строчный и совпадает с командами пакетного режима (BatchSession):
+ * клиент посылает команды по одной на строку, ответ на каждую заканчивается
+ * строкой "ok ..." или "error: ...". Команда format действует только на своё
+ * соединение, quit закрывает соединение.
+ *
+ * Поток run ждёт данных на сокетах через poll и передаёт соединение с
+ * пришедшими командами в пул потоков. Запросы выполняются параллельно под
+ * общей блокировкой, изменения - по одному под исключительной; индексы,
+ * устаревшие к моменту запроса, перестраиваются под исключительной
+ * блокировкой один раз. Соединение, клиент которого не принимает ответ
+ * дольше 5 с, закрывается, поэтому stop завершается за ограниченное время.
+ * Ответы отправляются по мере выполнения команд блоками от 64 КиБ; строка
+ * команды длиннее 64 КиБ отклоняется ответом "error: ..." с закрытием соединения.
+ */
+class ContactServer {
+private:
+    /**
+     * @struct Connection
+     * @brief Состояние соединения с клиентом.
+     */
+    struct Connection {
+        int fd;                     ///< Сокет клиента
+        std::string input;          ///< Принятые, но ещё не выполненные данные
+        ReportOptions options;      ///< Формат вывода соединения
+        bool closed = false;        ///< Клиент отключился или прислал quit
+    };
+
+    BatchSession& session;          ///< Сессия с контактами и индексами
+    ThreadPool& pool;               ///< Пул, выполняющий команды
+    std::shared_mutex access;       ///< Общая блокировка запросов, исключительная - изменений
+    std::string socketPath;         ///< Путь сокета
+    int listenFd;                   ///< Слушающий сокет
+    int wakeFds[2];                 ///< Канал пробуждения потока run
+    std::mutex returnedMutex;       ///< Защищает returned
+    std::vector<Connection*> returned; ///< Соединения, обработанные пулом
+    std::atomic<bool> stopping;     ///< Получен запрос остановки
+    std::atomic<std::size_t> handled; ///< Выполнено команд
+
+    /**
+     * @brief Читает доступные команды соединения, выполняет их и отправляет ответы.
+     * Выполняется в потоке пула.
+     * @param connection Соединение.
+     */
+    void serve(Connection& connection);
+
+    /**
+     * @brief Выполняет одну команду.
+     * @param connection Соединение, от которого пришла команда.
+     * @param line Строка команды.
+     * @param out Поток ответа.
+     */
+    void handle(Connection& connection, const std::string& line, std::ostream& out);
+
+    /**
+     * @brief Возвращает соединение потоку run после обработки.
+     * @param connection Соединение.
+     */
+    void giveBack(Connection* connection);
+
+public:
+    /**
+     * @brief Конструктор.
+     * @param session Сессия с загруженными контактами.
+     * @param pool Пул потоков для выполнения команд.
+     */
+    ContactServer(BatchSession& session, ThreadPool& pool);
+
+    /**
+     * @brief Деструктор. Закрывает сокеты и удаляет файл сокета.
+     */
+    ~ContactServer();
+
+    ContactServer(const ContactServer&) = delete;
+    ContactServer& operator=(const ContactServer&) = delete;
+
+    /**
+     * @brief Создаёт слушающий сокет. Существующий файл сокета заменяется.
+     * @param path Путь сокета.
+     * @return true, если сокет создан.
+     */
+    bool listen(const std::string& path);
+
+    /**
+     * @brief Принимает соединения и раздаёт команды пулу до вызова stop.
+     * Перед возвратом дожидается выполнения начатых команд.
+     */
+    void run();
+
+    /**
+     * @brief Просит run завершиться. Можно вызывать из обработчика сигнала.
+     */
+    void stop();
+
+    /**
+     * @brief Возвращает количество выполненных команд.
+     * @return Количество команд.
+     */
+    std::size_t requests() const { return handled.load(); }
+};
+
+/**
+ * @class ServerClient
+ * @brief Соединение клиента с ContactServer.
+ *
+ * Команды можно отправлять подряд, не дожидаясь ответов: ответы приходят
+ * в порядке команд.
+ */
+class ServerClient {
+private:
+    int fd;                 ///< Сокет
+    std::string buffer;     ///< Принятые, но ещё не возвращённые данные
+    std::size_t scanned;    ///< Длина начала буфера, уже просмотренного в поисках конца ответа
+    std::size_t lineStart;  ///< Начало непроверенной строки ответа
+
+public:
+    /**
+     * @brief Конструктор. Соединение не установлено.
+     */
+    ServerClient();
+
+    /**
+     * @brief Деструктор. Закрывает соединение.
+     */
+    ~ServerClient();
+
+    ServerClient(const ServerClient&) = delete;
+    ServerClient& operator=(const ServerClient&) = delete;
+
+    /**
+     * @brief Подключается к серверу.
+     * @param path Путь сокета.
+     * @return true, если соединение установлено.
+     */
+    bool connect(const std::string& path);
+
+    /**
+     * @brief Отправляет команду.
+     * @param line Строка команды без перевода строки.
+     * @return false при ошибке записи.
+     */
+    bool send(std::string_view line);
+
+    /**
+     * @brief Принимает ответ на очередную отправленную команду.
+     * @param response Ответ, включая завершающую строку "ok ..." или "error: ...".
+     * @return false, если соединение закрыто до конца ответа.
+     */
+    bool receive(std::string& response);
+
+    /**
+     * @brief Отправляет команду и принимает ответ.
+     * @param line Строка команды.
+     * @param response Ответ.
+     * @return false при ошибке соединения.
+     */
+    bool request(std::string_view line, std::string& response) { return send(line) && receive(response); }
+};
+
+#endif // SERVER_H
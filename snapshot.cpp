@@ -0,0 +1,343 @@
+// snapshot.cpp
+
+#include "snapshot.h"
+#include "csv_reader.h"
+#include "csv_writer.h"
+#include "trace.h"
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <filesystem>
+#include <type_traits>
+
+static_assert(sizeof(int) == 4, "Снимок хранит ID как 32-битные числа");
+static_assert(sizeof(PackedPhone) == 8 && std::is_trivially_copyable<PackedPhone>::value,
+              "Снимок копирует упакованные номера блоком");
+
+namespace {
+    const char snapshotMagic[8] = { 'C', 'O', 'N', 'T', 'S', 'N', 'A', 'P' };
+    constexpr std::uint32_t byteOrderMark = 0x01020304;
+
+    // Секции файла в порядке записи
+    enum Section {
+        Ids, NameEnds, NameChars, Phones, CityCodes, CityEnds, CityChars,
+        NameAsc, NameDesc,
+        CityAscRecords, CityAscStart, CityAscBuckets,
+        CityDescRecords, CityDescStart, CityDescBuckets,
+        PhoneKeys, PhoneRecords,
+        SectionCount
+    };
+
+    struct SectionEntry {
+        std::uint64_t offset;   // Смещение от начала файла, кратно 8
+        std::uint64_t size;     // Размер в байтах
+    };
+
+    struct SnapshotHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint64_t rows;
+        std::uint64_t cities;
+        std::int64_t nextId;
+        SectionEntry sections[SectionCount];
+    };
+
+    // Запись массива секцией с выравниванием по 8 байт
+    template<typename T>
+    void writeSection(std::ofstream& out, std::uint64_t& position, SectionEntry& entry, const T* data, std::size_t count) {
+        static const char zeros[8] = {};
+        std::uint64_t padding = (8 - position % 8) % 8;
+        out.write(zeros, static_cast<std::streamsize>(padding));
+        position += padding;
+        entry.offset = position;
+        entry.size = count * sizeof(T);
+        if(count > 0)
+            out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(entry.size));
+        position += entry.size;
+    }
+
+    template<typename T>
+    void writeSection(std::ofstream& out, std::uint64_t& position, SectionEntry& entry, const std::vector<T>& data) {
+        writeSection(out, position, entry, data.data(), data.size());
+    }
+
+    // Копирование секции одним блоком с проверкой границ и размера
+    template<typename T>
+    bool readSection(std::string_view file, const SectionEntry& entry, std::size_t count, std::vector<T>& data) {
+        if(entry.offset % 8 != 0 || entry.offset > file.size() || entry.size > file.size() - entry.offset ||
+           entry.size != count * sizeof(T))
+            return false;
+        data.resize(count);
+        if(count > 0)
+            std::memcpy(data.data(), file.data() + entry.offset, entry.size);
+        return true;
+    }
+
+    // Копирование секции символов
+    bool readChars(std::string_view file, const SectionEntry& entry, std::string& chars) {
+        if(entry.offset > file.size() || entry.size > file.size() - entry.offset)
+            return false;
+        chars.assign(file.data() + entry.offset, entry.size);
+        return true;
+    }
+
+    // Номера записей индекса по имени
+    std::vector<int> recordNumbersOf(const std::vector<Index>& index) {
+        std::vector<int> records;
+        records.reserve(index.size());
+        for(const Index& idx : index)
+            records.push_back(idx.recordNumber);
+        return records;
+    }
+
+    // Проверка концов строк таблицы: неубывание и совпадение с размером символов
+    bool validEnds(const std::vector<std::uint64_t>& ends, std::size_t chars) {
+        std::uint64_t previous = 0;
+        for(std::uint64_t end : ends) {
+            if(end < previous)
+                return false;
+            previous = end;
+        }
+        return previous == chars;
+    }
+
+    // Проверка групп индекса по городу
+    bool validCityIndex(const CityIndex& index, std::size_t rows, std::size_t cities) {
+        if(index.bucketStart.size() != cities + 1 || index.bucketStart.front() != 0 || index.bucketStart.back() != rows)
+            return false;
+        for(std::size_t b = 0; b < cities; ++b) {
+            if(index.bucketStart[b] > index.bucketStart[b + 1] || index.bucketOfCode[b] >= cities)
+                return false;
+        }
+        return true;
+    }
+}
+
+// Сохранение снимка
+bool saveSnapshot(const std::string& filename, const ContactStore& contacts, const IndexArray& indices) {
+    STATS_TIMED(StatOperation::FILE_WRITE);
+    TRACE_SPAN("saveSnapshot");
+    std::string temporary = filename + ".tmp";
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    if(!out) {
+        std::cerr << "Не удалось открыть файл для записи: " << temporary << "\n";
+        return false;
+    }
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, snapshotMagic, sizeof(snapshotMagic));
+    header.version = snapshotVersion;
+    header.byteOrder = byteOrderMark;
+    header.rows = contacts.size();
+    header.cities = contacts.cityCount();
+    header.nextId = global_id_counter;
+
+    // Место под заголовок; он перезаписывается после секций
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    std::uint64_t position = sizeof(header);
+    SectionEntry* sections = header.sections;
+
+    // Столбцы и таблица имён без устаревших строк арены
+    std::vector<int> ids;
+    std::vector<std::uint64_t> nameEnds;
+    std::vector<std::uint32_t> cityCodes;
+    std::string nameChars;
+    ids.reserve(contacts.size());
+    nameEnds.reserve(contacts.size());
+    cityCodes.reserve(contacts.size());
+    for(std::size_t row = 0; row < contacts.size(); ++row) {
+        ids.push_back(contacts.id(row));
+        nameChars.append(contacts.name(row));
+        nameEnds.push_back(nameChars.size());
+        cityCodes.push_back(contacts.cityCode(row));
+    }
+    writeSection(out, position, sections[Ids], ids);
+    writeSection(out, position, sections[NameEnds], nameEnds);
+    writeSection(out, position, sections[NameChars], nameChars.data(), nameChars.size());
+    std::vector<PackedPhone> phones;
+    phones.reserve(contacts.size());
+    for(std::size_t row = 0; row < contacts.size(); ++row)
+        phones.push_back(contacts.phoneNumber(row));
+    writeSection(out, position, sections[Phones], phones);
+    writeSection(out, position, sections[CityCodes], cityCodes);
+
+    std::vector<std::uint64_t> cityEnds;
+    std::string cityChars;
+    for(std::uint32_t code = 0; code < contacts.cityCount(); ++code) {
+        cityChars.append(contacts.cityName(code));
+        cityEnds.push_back(cityChars.size());
+    }
+    writeSection(out, position, sections[CityEnds], cityEnds);
+    writeSection(out, position, sections[CityChars], cityChars.data(), cityChars.size());
+
+    // Отсортированные индекс-массивы
+    writeSection(out, position, sections[NameAsc], recordNumbersOf(indices.nameIndexAsc));
+    writeSection(out, position, sections[NameDesc], recordNumbersOf(indices.nameIndexDesc));
+    const CityIndex* cityIndices[] = { &indices.cityIndexAsc, &indices.cityIndexDesc };
+    const Section citySections[] = { CityAscRecords, CityDescRecords };
+    for(int i = 0; i < 2; ++i) {
+        const CityIndex& index = *cityIndices[i];
+        std::vector<std::uint64_t> start(index.bucketStart.begin(), index.bucketStart.end());
+        writeSection(out, position, sections[citySections[i]], index.recordNumbers);
+        writeSection(out, position, sections[citySections[i] + 1], start);
+        writeSection(out, position, sections[citySections[i] + 2], index.bucketOfCode);
+    }
+    std::vector<PackedPhone> phoneKeys;
+    std::vector<int> phoneRecords;
+    phoneKeys.reserve(indices.phoneIndex.size());
+    phoneRecords.reserve(indices.phoneIndex.size());
+    for(const PhoneIndex& idx : indices.phoneIndex) {
+        phoneKeys.push_back(idx.phone);
+        phoneRecords.push_back(idx.recordNumber);
+    }
+    writeSection(out, position, sections[PhoneKeys], phoneKeys);
+    writeSection(out, position, sections[PhoneRecords], phoneRecords);
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    // Журнал очищается после записи снимка, поэтому снимок должен быть на диске до переименования
+    if(!out || !syncFile(temporary) || std::rename(temporary.c_str(), filename.c_str()) != 0) {
+        std::cerr << "Не удалось записать снимок: " << filename << "\n";
+        std::remove(temporary.c_str());
+        return false;
+    }
+    // Переименование сохраняется записью каталога
+    if(!syncParentDirectory(filename)) {
+        std::cerr << "Не удалось сохранить на диске каталог снимка: " << filename << "\n";
+        return false;
+    }
+    return true;
+}
+
+// Загрузка снимка
+bool loadSnapshot(const std::string& filename, ContactStore& contacts, IndexArray& indices) {
+    STATS_TIMED(StatOperation::FILE_READ);
+    TRACE_SPAN("loadSnapshot");
+    MappedFile file;
+    if(!file.open(filename))
+        return false;
+    std::string_view bytes = file.view();
+
+    SnapshotHeader header;
+    if(bytes.size() < sizeof(header)) {
+        std::cerr << "Повреждённый снимок: " << filename << "\n";
+        return false;
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if(std::memcmp(header.magic, snapshotMagic, sizeof(snapshotMagic)) != 0 ||
+       header.byteOrder != byteOrderMark || header.version != snapshotVersion) {
+        std::cerr << "Неподдерживаемый формат снимка: " << filename << "\n";
+        return false;
+    }
+
+    std::size_t rows = header.rows;
+    std::size_t cities = header.cities;
+    const SectionEntry* sections = header.sections;
+    ContactStore store;
+    IndexArray loaded;
+    std::vector<std::uint64_t> nameEnds, cityEnds, ascStart, descStart;
+    std::vector<int> nameAsc, nameDesc, phoneRecords;
+    std::vector<PackedPhone> phoneKeys;
+    std::string nameChars, cityChars;
+
+    bool valid = readSection(bytes, sections[Ids], rows, store.ids) &&
+                 readSection(bytes, sections[NameEnds], rows, nameEnds) &&
+                 readSection(bytes, sections[Phones], rows, store.phones) &&
+                 readSection(bytes, sections[CityCodes], rows, store.cityCodes) &&
+                 readSection(bytes, sections[CityEnds], cities, cityEnds) &&
+                 readSection(bytes, sections[NameAsc], rows, nameAsc) &&
+                 readSection(bytes, sections[NameDesc], rows, nameDesc) &&
+                 readSection(bytes, sections[CityAscRecords], rows, loaded.cityIndexAsc.recordNumbers) &&
+                 readSection(bytes, sections[CityAscStart], cities + 1, ascStart) &&
+                 readSection(bytes, sections[CityAscBuckets], cities, loaded.cityIndexAsc.bucketOfCode) &&
+                 readSection(bytes, sections[CityDescRecords], rows, loaded.cityIndexDesc.recordNumbers) &&
+                 readSection(bytes, sections[CityDescStart], cities + 1, descStart) &&
+                 readSection(bytes, sections[CityDescBuckets], cities, loaded.cityIndexDesc.bucketOfCode) &&
+                 readSection(bytes, sections[PhoneKeys], rows, phoneKeys) &&
+                 readSection(bytes, sections[PhoneRecords], rows, phoneRecords) &&
+                 readChars(bytes, sections[NameChars], nameChars) &&
+                 readChars(bytes, sections[CityChars], cityChars);
+    valid = valid && validEnds(nameEnds, nameChars.size()) && validEnds(cityEnds, cityChars.size());
+    for(std::size_t row = 0; valid && row < rows; ++row)
+        valid = store.cityCodes[row] < cities && (row == 0 || store.ids[row - 1] < store.ids[row]);
+    if(valid) {
+        loaded.cityIndexAsc.bucketStart.assign(ascStart.begin(), ascStart.end());
+        loaded.cityIndexDesc.bucketStart.assign(descStart.begin(), descStart.end());
+        valid = validCityIndex(loaded.cityIndexAsc, rows, cities) && validCityIndex(loaded.cityIndexDesc, rows, cities);
+    }
+    if(!valid) {
+        std::cerr << "Повреждённый снимок: " << filename << "\n";
+        return false;
+    }
+
+    // Столбец имён ссылается на арену, записанную одним блоком
+    store.nameArena = std::move(nameChars);
+    store.names.resize(rows);
+    for(std::size_t row = 0; row < rows; ++row) {
+        std::uint64_t begin = row == 0 ? 0 : nameEnds[row - 1];
+        store.names[row] = StringSpan{ begin, static_cast<std::uint32_t>(nameEnds[row] - begin) };
+    }
+    for(std::size_t code = 0; code < cities; ++code) {
+        std::uint64_t begin = code == 0 ? 0 : cityEnds[code - 1];
+        store.cityNames.emplace_back(cityChars, begin, cityEnds[code] - begin);
+        store.cityLookup.emplace(store.cityNames.back(), static_cast<std::uint32_t>(code));
+    }
+    // Группы индекса по возрастанию и есть ранги городов
+    store.cityRankCache = loaded.cityIndexAsc.bucketOfCode;
+    store.cityRanksValid = true;
+
+    // Номера записей индексов по городу и телефону должны указывать на контакты хранилища;
+    // индекс по телефону просматривается двоичным поиском и должен быть упорядочен
+    auto known = [&](int id) { return store.rowOf(id) != ContactStore::npos; };
+    valid = std::all_of(loaded.cityIndexAsc.recordNumbers.begin(), loaded.cityIndexAsc.recordNumbers.end(), known) &&
+            std::all_of(loaded.cityIndexDesc.recordNumbers.begin(), loaded.cityIndexDesc.recordNumbers.end(), known);
+    for(std::size_t i = 0; valid && i < rows; ++i) {
+        std::size_t row = store.rowOf(phoneRecords[i]);
+        valid = row != ContactStore::npos && store.phones[row] == phoneKeys[i] &&
+                (i == 0 || phoneKeys[i - 1] <= phoneKeys[i]);
+    }
+    if(!valid) {
+        std::cerr << "Повреждённый снимок: " << filename << "\n";
+        return false;
+    }
+
+    // Индексы по имени хранят ключи строками, их значения берутся из таблицы имён
+    const std::pair<const std::vector<int>*, std::vector<Index>*> nameIndices[] = {
+        { &nameAsc, &loaded.nameIndexAsc }, { &nameDesc, &loaded.nameIndexDesc }
+    };
+    for(const auto& pair : nameIndices) {
+        pair.second->reserve(rows);
+        for(int id : *pair.first) {
+            std::size_t row = store.rowOf(id);
+            if(row == ContactStore::npos) {
+                std::cerr << "Повреждённый снимок: " << filename << "\n";
+                return false;
+            }
+            pair.second->push_back(Index{ std::string(store.name(row)), id });
+        }
+    }
+    loaded.phoneIndex.reserve(rows);
+    for(std::size_t i = 0; i < rows; ++i)
+        loaded.phoneIndex.push_back(PhoneIndex{ phoneKeys[i], phoneRecords[i] });
+
+    contacts = std::move(store);
+    indices = std::move(loaded);
+    if(header.nextId > global_id_counter)
+        global_id_counter = static_cast<int>(header.nextId);
+    return true;
+}
+
+// Проверка актуальности снимка
+bool isSnapshotCurrent(const std::string& snapshotFile, const std::string& csvFile) {
+    std::error_code error;
+    auto snapshotTime = std::filesystem::last_write_time(snapshotFile, error);
+    if(error)
+        return false;
+    auto csvTime = std::filesystem::last_write_time(csvFile, error);
+    // Без CSV снимок - единственный источник данных
+    return error || snapshotTime >= csvTime;
+}
@@ -0,0 +1,55 @@
+// snapshot.h
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "contact.h"
+#include <string>
+
+/**
+ * @brief Версия формата бинарного снимка.
+ * Увеличивается при любом изменении раскладки файла; снимок другой версии
+ * не загружается.
+ */
+constexpr std::uint32_t snapshotVersion = 1;
+
+/**
+ * @brief Сохраняет хранилище и отсортированные индекс-массивы в бинарный снимок.
+ *
+ * Файл состоит из заголовка с таблицей секций и секций, выровненных по 8 байт:
+ * столбцы контактов, таблицы строк имён и городов (концы строк и символы),
+ * номера записей индексов по имени, по городу и по телефону. Порядок байтов
+ * - родной для машины; он проверяется при загрузке. Запись идёт во временный
+ * файл, который сбрасывается на диск и затем переименовывается; после
+ * переименования сбрасывается каталог.
+ * @param filename Имя файла снимка.
+ * @param contacts Хранилище контактов.
+ * @param indices Отсортированные индекс-массивы.
+ * @return true, если снимок записан и сохранён на диске; только после этого
+ * можно очищать журнал.
+ */
+bool saveSnapshot(const std::string& filename, const ContactStore& contacts, const IndexArray& indices);
+
+/**
+ * @brief Загружает хранилище и индекс-массивы из бинарного снимка.
+ *
+ * Файл отображается в память; каждый столбец и индекс копируется одним
+ * блоком, без разбора отдельных записей. Ключи индексов по имени берутся
+ * из загруженной таблицы имён. global_id_counter становится не меньше
+ * сохранённого значения.
+ * @param filename Имя файла снимка.
+ * @param contacts Хранилище контактов (заменяется).
+ * @param indices Индекс-массивы (заменяются).
+ * @return true, если снимок загружен; при ошибке хранилище и индексы не изменяются.
+ */
+bool loadSnapshot(const std::string& filename, ContactStore& contacts, IndexArray& indices);
+
+/**
+ * @brief Проверяет, что снимок существует и не старше CSV-файла.
+ * @param snapshotFile Имя файла снимка.
+ * @param csvFile Имя CSV-файла, рядом с которым записывается снимок.
+ * @return true, если снимок можно загрузить вместо CSV.
+ */
+bool isSnapshotCurrent(const std::string& snapshotFile, const std::string& csvFile);
+
+#endif // SNAPSHOT_H
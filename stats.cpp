@@ -0,0 +1,115 @@
+// stats.cpp
+
+#include "stats.h"
+#include "report_writer.h"
+#include <algorithm>
+#include <iomanip>
+
+namespace {
+    const char* operationNames[] = {
+        "поиск", "добавление", "изменение", "удаление", "построение индексов", "сортировка индексов",
+        "построение дерева", "чтение файла", "запись файла"
+    };
+    const char* counterNames[] = {
+        "найдено", "проиндексировано", "прочитано строк", "записано строк"
+    };
+    static_assert(sizeof(operationNames) / sizeof(operationNames[0]) == static_cast<std::size_t>(StatOperation::COUNT),
+                  "Нужно имя для каждой операции");
+    static_assert(sizeof(counterNames) / sizeof(counterNames[0]) == static_cast<std::size_t>(StatCounter::COUNT),
+                  "Нужно имя для каждого счётчика");
+}
+
+// Конструктор гистограммы
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+// Верхняя граница корзины
+std::uint64_t LatencyHistogram::bucketUpper(std::size_t bucket) {
+    if(bucket < 2 * subBuckets)
+        return bucket;
+    std::size_t shift = bucket / subBuckets - 1;
+    std::uint64_t lower = static_cast<std::uint64_t>(bucket % subBuckets + subBuckets) << shift;
+    return lower + ((std::uint64_t(1) << shift) - 1);
+}
+
+// Перцентиль
+std::uint64_t LatencyHistogram::percentile(double percent) const {
+    std::uint64_t total = count();
+    if(total == 0)
+        return 0;
+    // Ранг значения, не меньше которого percent процентов значений
+    std::uint64_t rank = static_cast<std::uint64_t>(percent / 100.0 * static_cast<double>(total) + 0.5);
+    if(rank == 0)
+        rank = 1;
+    std::uint64_t seen = 0;
+    for(std::size_t bucket = 0; bucket < bucketCount; ++bucket) {
+        seen += buckets[bucket].load(std::memory_order_relaxed);
+        if(seen >= rank)
+            return std::min(bucketUpper(bucket), max());
+    }
+    return max();
+}
+
+// Очистка гистограммы
+void LatencyHistogram::reset() {
+    for(auto& bucket : buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    recorded.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    maximum.store(0, std::memory_order_relaxed);
+}
+
+// Конструктор статистики
+OperationStats::OperationStats() {
+    for(auto& counter : counters)
+        counter.store(0, std::memory_order_relaxed);
+}
+
+// Обнуление статистики
+void OperationStats::reset() {
+    for(auto& histogram : histograms)
+        histogram.reset();
+    for(auto& counter : counters)
+        counter.store(0, std::memory_order_relaxed);
+}
+
+// Вывод статистики
+void OperationStats::print(std::ostream& out) const {
+#if CONTACT_STATS
+    auto micros = [](double nanoseconds) { return nanoseconds / 1000.0; };
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1);
+    writeColumn(out, "операция", 21, true);
+    for(const char* column : { "кол-во", "среднее,мкс", "p50,мкс", "p90,мкс", "p99,мкс", "p99.9,мкс", "макс,мкс" })
+        writeColumn(out, column, 12, false);
+    out << "\n";
+    for(std::size_t i = 0; i < static_cast<std::size_t>(StatOperation::COUNT); ++i) {
+        const LatencyHistogram& latency = histograms[i];
+        std::uint64_t count = latency.count();
+        if(count == 0)
+            continue;
+        writeColumn(out, operationNames[i], 21, true);
+        out << std::right << std::setw(12) << count
+            << std::setw(12) << micros(static_cast<double>(latency.total()) / count)
+            << std::setw(12) << micros(latency.percentile(50)) << std::setw(12) << micros(latency.percentile(90))
+            << std::setw(12) << micros(latency.percentile(99)) << std::setw(12) << micros(latency.percentile(99.9))
+            << std::setw(12) << micros(latency.max()) << "\n";
+    }
+    for(std::size_t i = 0; i < static_cast<std::size_t>(StatCounter::COUNT); ++i) {
+        writeColumn(out, counterNames[i], 21, true);
+        out << std::right << std::setw(12) << counters[i].load(std::memory_order_relaxed) << "\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+#else
+    out << "статистика отключена при сборке (CONTACT_STATS=0)\n";
+#endif
+}
+
+// Статистика процесса
+OperationStats& operationStats() {
+    static OperationStats stats;
+    return stats;
+}
@@ -0,0 +1,246 @@
+// stats.h
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Сбор статистики включён по умолчанию; сборка с -DCONTACT_STATS=0 убирает
+ * замеры из кода (макросы STATS_TIMED, STATS_COUNT и TRACE_SPAN становятся пустыми).
+ */
+#ifndef CONTACT_STATS
+#define CONTACT_STATS 1
+#endif
+
+/**
+ * @enum StatOperation
+ * @brief Замеряемые операции.
+ */
+enum class StatOperation {
+    SEARCH,         ///< Поиск по индексу или дереву
+    INSERT,         ///< Добавление контакта
+    EDIT,           ///< Изменение контакта
+    REMOVE,         ///< Удаление контакта
+    INDEX_BUILD,    ///< Заполнение индекс-массивов
+    INDEX_SORT,     ///< Сортировка индекс-массивов
+    TREE_BUILD,     ///< Построение бинарного дерева
+    FILE_READ,      ///< Чтение файла (CSV, снимок, журнал)
+    FILE_WRITE,     ///< Запись файла (CSV, снимок, журнал)
+    COUNT           ///< Количество операций
+};
+
+/**
+ * @enum StatCounter
+ * @brief Счётчики объёма работы.
+ */
+enum class StatCounter {
+    FOUND,          ///< Найдено записей
+    INDEXED,        ///< Записей занесено в индексы
+    ROWS_READ,      ///< Контактов прочитано из файлов
+    ROWS_WRITTEN,   ///< Контактов записано в файлы
+    COUNT           ///< Количество счётчиков
+};
+
+/**
+ * @class LatencyHistogram
+ * @brief Гистограмма длительностей в наносекундах в духе HdrHistogram.
+ *
+ * Значения до 32 хранятся точно, большие - в 16 корзинах на каждую степень
+ * двойки, поэтому относительная погрешность перцентилей не больше 1/16.
+ * Запись - несколько атомарных операций без блокировок; её можно вызывать
+ * из нескольких потоков одновременно.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int subBucketBits = 4;                        ///< Бит мантиссы в номере корзины
+    static constexpr std::size_t subBuckets = 1 << subBucketBits;  ///< Корзин на степень двойки
+    static constexpr std::size_t bucketCount = (64 - subBucketBits + 1) * subBuckets; ///< Всего корзин
+
+    /**
+     * @brief Конструктор пустой гистограммы.
+     */
+    LatencyHistogram();
+
+    /**
+     * @brief Добавляет значение.
+     * @param nanoseconds Длительность.
+     */
+    void record(std::uint64_t nanoseconds) {
+        buckets[bucketOf(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+        recorded.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+        std::uint64_t current = maximum.load(std::memory_order_relaxed);
+        while(nanoseconds > current &&
+              !maximum.compare_exchange_weak(current, nanoseconds, std::memory_order_relaxed)) {}
+    }
+
+    /**
+     * @brief Возвращает количество значений.
+     * @return Количество значений.
+     */
+    std::uint64_t count() const { return recorded.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Возвращает сумму значений.
+     * @return Сумма в наносекундах.
+     */
+    std::uint64_t total() const { return sum.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Возвращает наибольшее значение.
+     * @return Наибольшее значение в наносекундах.
+     */
+    std::uint64_t max() const { return maximum.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Возвращает перцентиль.
+     * @param percent Перцентиль от 0 до 100.
+     * @return Верхняя граница корзины, в которую попал перцентиль, но не больше max(); 0 для пустой гистограммы.
+     */
+    std::uint64_t percentile(double percent) const;
+
+    /**
+     * @brief Очищает гистограмму.
+     */
+    void reset();
+
+    /**
+     * @brief Возвращает номер корзины значения.
+     * @param value Значение.
+     * @return Номер корзины.
+     */
+    static std::size_t bucketOf(std::uint64_t value) {
+        if(value < 2 * subBuckets)
+            return static_cast<std::size_t>(value);
+        int magnitude = 63 - __builtin_clzll(value);
+        int shift = magnitude - subBucketBits;
+        return static_cast<std::size_t>(shift + 1) * subBuckets + ((value >> shift) - subBuckets);
+    }
+
+    /**
+     * @brief Возвращает наибольшее значение корзины.
+     * @param bucket Номер корзины.
+     * @return Верхняя граница корзины.
+     */
+    static std::uint64_t bucketUpper(std::size_t bucket);
+
+private:
+    std::atomic<std::uint64_t> buckets[bucketCount];    ///< Количество значений в корзинах
+    std::atomic<std::uint64_t> recorded;                ///< Количество значений
+    std::atomic<std::uint64_t> sum;                     ///< Сумма значений
+    std::atomic<std::uint64_t> maximum;                 ///< Наибольшее значение
+};
+
+/**
+ * @class OperationStats
+ * @brief Гистограммы длительностей операций и счётчики процесса.
+ */
+class OperationStats {
+private:
+    LatencyHistogram histograms[static_cast<std::size_t>(StatOperation::COUNT)];     ///< По операциям
+    std::atomic<std::uint64_t> counters[static_cast<std::size_t>(StatCounter::COUNT)]; ///< Счётчики
+
+public:
+    /**
+     * @brief Конструктор с нулевыми значениями.
+     */
+    OperationStats();
+
+    /**
+     * @brief Возвращает гистограмму операции.
+     * @param operation Операция.
+     * @return Гистограмма.
+     */
+    LatencyHistogram& histogram(StatOperation operation) { return histograms[static_cast<std::size_t>(operation)]; }
+
+    /**
+     * @brief Возвращает гистограмму операции.
+     * @param operation Операция.
+     * @return Гистограмма.
+     */
+    const LatencyHistogram& histogram(StatOperation operation) const {
+        return histograms[static_cast<std::size_t>(operation)];
+    }
+
+    /**
+     * @brief Увеличивает счётчик.
+     * @param counter Счётчик.
+     * @param amount Приращение.
+     */
+    void add(StatCounter counter, std::uint64_t amount) {
+        counters[static_cast<std::size_t>(counter)].fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Возвращает значение счётчика.
+     * @param counter Счётчик.
+     * @return Значение.
+     */
+    std::uint64_t value(StatCounter counter) const {
+        return counters[static_cast<std::size_t>(counter)].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Обнуляет гистограммы и счётчики.
+     */
+    void reset();
+
+    /**
+     * @brief Выводит таблицу операций (количество, среднее, перцентили, максимум в микросекундах) и счётчики.
+     * Операции без замеров пропускаются.
+     * @param out Поток вывода.
+     */
+    void print(std::ostream& out) const;
+};
+
+/**
+ * @brief Возвращает статистику процесса.
+ * @return Общий объект статистики.
+ */
+OperationStats& operationStats();
+
+/**
+ * @class ScopedTimer
+ * @brief Замеряет время жизни объекта и добавляет его в гистограмму операции.
+ */
+class ScopedTimer {
+private:
+    StatOperation operation;                            ///< Замеряемая операция
+    std::chrono::steady_clock::time_point start;        ///< Начало замера
+
+public:
+    /**
+     * @brief Конструктор. Начинает замер.
+     * @param operation Операция.
+     */
+    explicit ScopedTimer(StatOperation operation) : operation(operation), start(std::chrono::steady_clock::now()) {}
+
+    /**
+     * @brief Деструктор. Записывает длительность.
+     */
+    ~ScopedTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        operationStats().histogram(operation).record(
+            static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+#if CONTACT_STATS
+/// Замеряет время до конца текущего блока
+#define STATS_TIMED(operation) ScopedTimer statsTimer(operation)
+/// Увеличивает счётчик
+#define STATS_COUNT(counter, amount) operationStats().add(counter, amount)
+#else
+#define STATS_TIMED(operation) ((void)0)
+#define STATS_COUNT(counter, amount) ((void)0)
+#endif
+
+#endif // STATS_H
@@ -3,8 +3,28 @@
 #include "contact.h"
 #include "binary_tree.h"
 #include "linked_list.h"
+#include "csv_reader.h"
+#include "csv_writer.h"
+#include "external_index.h"
+#include "contact_diff.h"
+#include "batch.h"
+#include "server.h"
+#include "snapshot.h"
+#include "journal.h"
+#include "stats.h"
+#include "trace.h"
+#include "memory_usage.h"
 #include <iostream>
 #include <cassert>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <filesystem>
+#include <thread>
+#include <atomic>
+#include <numeric>
+#include <set>
+#include <chrono>
 
 /**
  * @brief Функция для тестирования вставки и балансировки AVL-дерева.
@@ -12,7 +32,7 @@
 void testAVLInsertion() {
     std::cout << "=== Тестирование вставки и балансировки AVL-дерева ===\n";
     BinaryTree tree;
-    std::vector<Contact> contacts;
+    ContactStore contacts;
 
     // Вставка контактов
     contacts.push_back(Contact{1, "Елена", "1111111111", "Москва"});
@@ -64,7 +84,7 @@ void testAVLInsertion() {
 void testAVLDeletion() {
     std::cout << "=== Тестирование удаления и балансировки AVL-дерева ===\n";
     BinaryTree tree;
-    std::vector<Contact> contacts;
+    ContactStore contacts;
 
     // Вставка контактов
     contacts.push_back(Contact{1, "Елена", "1111111111", "Москва"});
@@ -110,21 +130,24 @@ void testAVLDeletion() {
  */
 void testLinkedList() {
     std::cout << "=== Тестирование линейного списка ===\n";
+    // Общее хранилище контактов, на которое ссылается список
+    ContactStore contacts;
+    contacts.push_back(Contact{1, "Борис", "1111111111", "Москва"});
+    contacts.push_back(Contact{2, "Алексей", "2222222222", "Санкт-Петербург"});
+    contacts.push_back(Contact{3, "Виктория", "3333333333", "Новосибирск"});
+    contacts.push_back(Contact{4, "Галина", "4444444444", "Екатеринбург"});
+    contacts.push_back(Contact{5, "Дмитрий", "5555555555", "Нижний Новгород"});
+
     // Создание линейного списка с сортировкой по имени (по возрастанию) и городу (по убыванию)
-    LinkedList list(PrimarySortAttribute::NAME, SecondarySortAttribute::CITY, SortOrder::ASCENDING, SortOrder::DESCENDING);
+    LinkedList list(contacts, PrimarySortAttribute::NAME, SecondarySortAttribute::CITY, SortOrder::ASCENDING, SortOrder::DESCENDING);
 
     // Вставка контактов
-    Contact c1{1, "Борис", "1111111111", "Москва"};
-    Contact c2{2, "Алексей", "2222222222", "Санкт-Петербург"};
-    Contact c3{3, "Виктория", "3333333333", "Новосибирск"};
-    Contact c4{4, "Галина", "4444444444", "Екатеринбург"};
-    Contact c5{5, "Дмитрий", "5555555555", "Нижний Новгород"};
-
-    list.insert(c1);
-    list.insert(c2);
-    list.insert(c3);
-    list.insert(c4);
-    list.insert(c5);
+    for(const auto& contact : contacts) {
+        assert(list.insert(contact.id));
+    }
+    // Повторная вставка и несуществующий ID игнорируются
+    assert(!list.insert(1));
+    assert(!list.insert(42));
 
     // Вывод отсортированного списка
     std::cout << "\nЛинейный список (отсортированный):\n";
@@ -138,6 +161,16 @@ void testLinkedList() {
     std::cout << "\nПоиск контакта с именем 'Петр':\n";
     list.search("Петр");
 
+    // Поиск по основному и второстепенному атрибутам через хэш-индекс
+    assert(list.searchIds("Алексей") == std::vector<int>{2});
+    assert(list.searchIds("Петр").empty());
+    assert(list.searchIds("Новосибирск", true) == std::vector<int>{3});
+    std::cout << "\nПоиск контакта в городе 'Новосибирск':\n";
+    list.searchSecondary("Новосибирск");
+
+    // Порядок вставки не зависит от сортировки
+    assert((list.insertionOrderIds() == std::vector<int>{1, 2, 3, 4, 5}));
+
     // Удаление существующего контакта
     std::cout << "\nУдаление контакта с именем 'Галина':\n";
     list.remove("Галина");
@@ -158,12 +191,1355 @@ void testLinkedList() {
     std::cout << "\nЛинейный список после изменения сортировки:\n";
     list.printSorted();
 
+    // Вывод списка в порядке ввода
+    std::cout << "\nЛинейный список в порядке ввода:\n";
+    list.printInsertionOrder();
+    assert((list.insertionOrderIds() == std::vector<int>{1, 2, 3, 5}));
+
     std::cout << "=== Тестирование линейного списка завершено ===\n\n";
 }
 
+/**
+ * @brief Функция для тестирования перестановки узла после редактирования контакта.
+ */
+void testLinkedListUpdate() {
+    std::cout << "=== Тестирование обновления узла линейного списка ===\n";
+    ContactStore contacts;
+    contacts.push_back(Contact{1, "Борис", "1111111111", "Москва"});
+    contacts.push_back(Contact{2, "Алексей", "2222222222", "Казань"});
+    contacts.push_back(Contact{3, "Виктория", "3333333333", "Новосибирск"});
+
+    contacts.push_back(Contact{4, "Борис", "4444444444", "Казань"});
+
+    LinkedList list(contacts, PrimarySortAttribute::NAME, SecondarySortAttribute::CITY, SortOrder::ASCENDING, SortOrder::ASCENDING);
+    for(const auto& contact : contacts) {
+        list.insert(contact.id);
+    }
+
+    // Одинаковые основные ключи идут подряд и упорядочены по второстепенному
+    assert((list.searchIds("Борис") == std::vector<int>{4, 1}));
+    assert((list.searchIds("Казань", true) == std::vector<int>{2, 4}));
+
+    // Редактирование контакта в хранилище и перестановка одного узла
+    contacts.setName(contacts.rowOf(2), "Яна");
+    contacts.setCity(contacts.rowOf(2), "Москва");
+    list.update(2);
+    assert(list.searchIds("Алексей").empty());
+    assert(list.searchIds("Яна") == std::vector<int>{2});
+    assert(list.searchIds("Казань", true) == std::vector<int>{4});
+    assert((list.insertionOrderIds() == std::vector<int>{1, 2, 3, 4}));
+    std::cout << "\nСписок после переименования 'Алексей' -> 'Яна':\n";
+    list.printSorted();
+
+    // Удаление контакта из хранилища и из списка
+    list.erase(1);
+    contacts.removeIf([](const ContactView& c) { return c.id == 1; });
+    assert(list.searchIds("Борис") == std::vector<int>{4});
+    assert((list.insertionOrderIds() == std::vector<int>{2, 3, 4}));
+    assert(contacts.rowOf(1) == ContactStore::npos);
+    assert(contacts.rowOf(3) != ContactStore::npos && contacts.name(contacts.rowOf(3)) == "Виктория");
+    std::cout << "\nСписок после удаления 'Борис':\n";
+    list.printSorted();
+
+    // Один большой элемент индекса по городу: удаления из середины переносят последний узел
+    ContactStore cityStore;
+    LinkedList cityList(cityStore, PrimarySortAttribute::NAME, SecondarySortAttribute::CITY,
+                        SortOrder::ASCENDING, SortOrder::ASCENDING);
+    std::vector<int> cityIds;
+    for(int id = 1; id <= 200; ++id) {
+        cityStore.push_back(Contact{id, "Имя" + std::to_string(id % 7), "1234567", "Омск"});
+        cityIds.push_back(id);
+    }
+    cityList.insertAll(cityIds);
+    std::set<int> expected(cityIds.begin(), cityIds.end());
+    auto cityMatches = [&]() {
+        std::vector<int> found = cityList.searchIds("Омск", true);
+        return std::set<int>(found.begin(), found.end()) == expected && found.size() == expected.size();
+    };
+    for(int id : { 5, 200, 1, 100, 37 }) {
+        cityList.erase(id);
+        expected.erase(id);
+        assert(cityMatches());
+    }
+    for(int id : { 2, 150, 199 }) {
+        cityStore.setCity(cityStore.rowOf(id), "Тверь");
+        cityList.update(id);
+        expected.erase(id);
+        assert(cityMatches());
+        assert(cityList.searchIds("Тверь", true).size() == static_cast<std::size_t>(id == 2 ? 1 : id == 150 ? 2 : 3));
+    }
+    // Крупное удаление сдвигает узлы; последующие одиночные удаления опираются на новые позиции
+    std::unordered_set<int> many;
+    for(int id = 10; id < 190; id += 2)
+        many.insert(id);
+    cityList.removeIds(many);
+    for(int id : many)
+        expected.erase(id);
+    assert(cityMatches());
+    for(int id : { 3, 189, 101 }) {
+        cityList.erase(id);
+        expected.erase(id);
+        assert(cityMatches());
+    }
+
+    std::cout << "=== Тестирование обновления узла завершено ===\n\n";
+}
+
+/**
+ * @brief Функция для тестирования пакетного удаления из всех структур.
+ */
+void testBatchRemoval() {
+    std::cout << "=== Тестирование пакетного удаления ===\n";
+    const char* cities[] = { "Москва", "Казань", "Омск", "Тверь" };
+    ContactStore contacts;
+    for(int i = 1; i <= 1000; ++i) {
+        contacts.push_back(Contact{i, "Имя" + std::to_string(i % 37), "1000000" + std::to_string(i), cities[i % 4]});
+    }
+
+    IndexArray indices;
+    indices.buildIndices(contacts);
+    indices.sortIndices();
+    BinaryTree tree;
+    LinkedList list(contacts, PrimarySortAttribute::CITY, SecondarySortAttribute::NAME, SortOrder::ASCENDING, SortOrder::ASCENDING);
+    for(const auto& contact : contacts) {
+        tree.insert(contact.name, contact.id);
+        list.insert(contact.id);
+    }
+
+    // Удаление всех контактов из Казани
+    size_t listRemoved = list.removeIf([](const ContactView& c) { return c.city == "Казань"; });
+    std::vector<int> removedIds = contacts.removeIf([](const ContactView& c) { return c.city == "Казань"; });
+    std::unordered_set<int> removedSet(removedIds.begin(), removedIds.end());
+    indices.removeRecords(removedSet);
+    size_t treeRemoved = tree.removeRecords(removedSet);
+
+    assert(removedIds.size() == 250);
+    assert(listRemoved == 250);
+    assert(treeRemoved == 250);
+    assert(contacts.size() == 750);
+    assert(indices.nameIndexAsc.size() == 750 && indices.cityIndexDesc.recordNumbers.size() == 750);
+    assert(searchCity(indices.cityIndexAsc, contacts.findCity("Казань")).empty());
+    assert(searchCity(indices.cityIndexAsc, contacts.findCity("Омск")).size() == 250);
+    assert(searchCity(indices.cityIndexDesc, contacts.findCity("Омск")).size() == 250);
+    assert(list.searchIds("Казань").empty());
+    assert(list.searchIds("Москва").size() == 250);
+    assert(list.insertionOrderIds().size() == 750);
+    for(int id : tree.search("Имя1")) {
+        assert(removedSet.count(id) == 0);
+    }
+
+    // Небольшой набор ID удаляется поштучно
+    assert(list.removeIds({ 4, 8, 12345 }) == 2);
+    assert(tree.removeRecords({ 4, 8 }) == 2);
+    assert(list.insertionOrderIds().size() == 748);
+
+    std::cout << "Удалено контактов из Казани: " << removedIds.size() << "\n";
+    std::cout << "=== Тестирование пакетного удаления завершено ===\n\n";
+}
+
+/**
+ * @brief Функция для тестирования колоночного хранилища контактов.
+ */
+void testContactStore() {
+    std::cout << "=== Тестирование колоночного хранилища ===\n";
+    ContactStore store;
+    store.push_back(Contact{1, "Анна", "1111111", "Москва"});
+    store.push_back(Contact{3, "Борис", "3333333", "Казань"});
+    // ID меньше последнего вставляется с сохранением порядка
+    store.push_back(Contact{2, "Вера", "2222222", "Омск"});
+
+    assert(store.size() == 3);
+    assert(store.id(0) == 1 && store.id(1) == 2 && store.id(2) == 3);
+    assert(store.rowOf(2) == 1 && store.rowOf(7) == ContactStore::npos);
+    assert(store.findName("Борис") == 2);
+    assert(store.findName("Петр") == ContactStore::npos);
+    Contact copy = store.at(1);
+    assert(copy.name == "Вера" && copy.phoneNumber == "2222222" && copy.city == "Омск");
+
+    // Многократное редактирование не оставляет устаревших строк навсегда
+    for(int i = 0; i < 2000; ++i) {
+        store.setName(0, "Анна" + std::to_string(i));
+    }
+    assert(store.name(0) == "Анна1999");
+    assert(store.name(2) == "Борис" && store.city(2) == "Казань");
+
+    // Присваивание строки из того же столбца
+    store.setName(1, store.name(2));
+    assert(store.name(1) == "Борис");
+
+    std::vector<int> removed = store.removeIf([](const ContactView& c) { return c.name == "Борис"; });
+    assert((removed == std::vector<int>{2, 3}));
+    assert(store.size() == 1 && store.phoneNumber(0).str() == "1111111");
+
+    std::cout << "=== Тестирование колоночного хранилища завершено ===\n\n";
+}
+
+/**
+ * @brief Функция для тестирования словарного кодирования городов и индексов по городу.
+ */
+void testCityDictionary() {
+    std::cout << "=== Тестирование словаря городов ===\n";
+    ContactStore contacts;
+    contacts.push_back(Contact{1, "Анна", "1111111", "Тверь"});
+    contacts.push_back(Contact{2, "Борис", "2222222", "Казань"});
+    contacts.push_back(Contact{3, "Вера", "3333333", "Омск"});
+    contacts.push_back(Contact{4, "Глеб", "4444444", "Казань"});
+    contacts.push_back(Contact{5, "Дина", "5555555", "Тверь"});
+
+    // Каждый город хранится в словаре один раз
+    assert(contacts.cityCount() == 3);
+    assert(contacts.cityCode(1) == contacts.cityCode(3));
+    assert(contacts.findCity("Новгород") == ContactStore::noCity);
+    const std::vector<std::uint32_t>& ranks = contacts.cityRanks();
+    assert(ranks[contacts.findCity("Казань")] == 0);
+    assert(ranks[contacts.findCity("Омск")] == 1);
+    assert(ranks[contacts.findCity("Тверь")] == 2);
+
+    IndexArray indices;
+    indices.buildIndices(contacts);
+    indices.sortIndices();
+    assert((indices.cityIndexAsc.recordNumbers == std::vector<int>{2, 4, 3, 1, 5}));
+    assert((indices.cityIndexDesc.recordNumbers == std::vector<int>{1, 5, 3, 2, 4}));
+    assert((searchCity(indices.cityIndexAsc, contacts.findCity("Казань")) == std::vector<int>{2, 4}));
+    assert((searchCity(indices.cityIndexDesc, contacts.findCity("Тверь")) == std::vector<int>{1, 5}));
+    assert(searchCity(indices.cityIndexAsc, ContactStore::noCity).empty());
+
+    // Новый город меняет ранги, индекс строится заново
+    contacts.setCity(contacts.rowOf(3), "Архангельск");
+    indices.buildIndices(contacts);
+    assert((indices.cityIndexAsc.recordNumbers == std::vector<int>{3, 2, 4, 1, 5}));
+    assert(searchCity(indices.cityIndexAsc, contacts.findCity("Омск")).empty());
+
+    // Удаление записей сохраняет границы групп
+    indices.removeRecords({ 2, 5 });
+    assert((searchCity(indices.cityIndexAsc, contacts.findCity("Казань")) == std::vector<int>{4}));
+    assert((searchCity(indices.cityIndexDesc, contacts.findCity("Тверь")) == std::vector<int>{1}));
+    assert((searchCity(indices.cityIndexDesc, contacts.findCity("Архангельск")) == std::vector<int>{3}));
+
+    std::cout << "=== Тестирование словаря городов завершено ===\n\n";
+}
+
+/**
+ * @brief Функция для тестирования упакованных номеров телефонов.
+ */
+void testPackedPhone() {
+    std::cout << "=== Тестирование упакованных номеров телефонов ===\n";
+    // Проверка формата
+    assert(validatePhoneDigits("1234567"));
+    assert(validatePhoneDigits("123456789012345"));
+    assert(!validatePhoneDigits("123456"));
+    assert(!validatePhoneDigits("1234567890123456"));
+    assert(!validatePhoneDigits("12345a7"));
+    assert(!validatePhoneDigits("1234567/"));
+    assert(!validatePhoneDigits("12345678901234:"));
+    assert(!validatePhoneDigits("123 4567"));
+    assert(!validatePhoneDigits("П234567"));
+
+    // Упаковка и распаковка
+    PackedPhone phone;
+    assert(phone.empty());
+    assert(!PackedPhone::parse("12-34567", phone) && phone.empty());
+    assert(PackedPhone::parse("098765432109876", phone));
+    assert(phone.length() == 15 && phone.str() == "098765432109876");
+    std::ostringstream out;
+    out << phone;
+    assert(out.str() == "098765432109876");
+
+    // Порядок целых значений совпадает с порядком строк
+    std::vector<std::string> numbers = { "1000000", "10000000", "0999999", "1000001", "99999999", "100000000000000", "1234567" };
+    for(const std::string& a : numbers) {
+        for(const std::string& b : numbers) {
+            PackedPhone pa, pb;
+            assert(PackedPhone::parse(a, pa) && PackedPhone::parse(b, pb));
+            assert((pa < pb) == (a < b) && (pa == pb) == (a == b));
+            assert(pa != pb || std::hash<PackedPhone>()(pa) == std::hash<PackedPhone>()(pb));
+        }
+    }
+
+    // Столбец телефонов в хранилище
+    ContactStore store;
+    store.push_back(Contact{1, "Анна", "1111111", "Москва"});
+    store.push_back(Contact{2, "Борис", "2222222", "Казань"});
+    store.push_back(Contact{3, "Вера", "нет", "Омск"});
+    PackedPhone key;
+    assert(PackedPhone::parse("2222222", key) && store.findPhone(key) == 1);
+    assert(store[2].phoneNumber.empty() && store.at(2).phoneNumber.empty());
+    PackedPhone updated;
+    assert(PackedPhone::parse("3333333", updated));
+    store.setPhoneNumber(2, updated);
+    assert(store.findPhone(updated) == 2 && store.at(2).phoneNumber == "3333333");
+
+    std::cout << "=== Тестирование упакованных номеров телефонов завершено ===\n\n";
+}
+
+/**
+ * @brief Функция для тестирования индекса по номеру телефона.
+ */
+void testPhoneIndex() {
+    std::cout << "=== Тестирование индекса по номеру телефона ===\n";
+    ContactStore contacts;
+    contacts.push_back(Contact{1, "Анна", "74951234567", "Москва"});
+    contacts.push_back(Contact{2, "Борис", "78121234567", "Санкт-Петербург"});
+    contacts.push_back(Contact{3, "Вера", "7495765", "Москва"});
+    contacts.push_back(Contact{4, "Глеб", "74951234567", "Москва"});
+    contacts.push_back(Contact{5, "Дина", "749", "Москва"}); // некорректный номер хранится пустым
+    contacts.push_back(Contact{6, "Егор", "749599999999999", "Москва"});
+
+    IndexArray indices;
+    indices.buildIndices(contacts);
+    indices.sortIndices();
+
+    // Точный поиск
+    PackedPhone phone;
+    assert(PackedPhone::parse("74951234567", phone));
+    assert((searchPhone(indices.phoneIndex, phone) == std::vector<int>{1, 4}));
+    assert(PackedPhone::parse("7495123456", phone));
+    assert(searchPhone(indices.phoneIndex, phone).empty());
+
+    // Поиск по префиксу: результат упорядочен по номеру
+    assert((searchPhonePrefix(indices.phoneIndex, "7495") == std::vector<int>{1, 4, 3, 6}));
+    assert((searchPhonePrefix(indices.phoneIndex, "7812") == std::vector<int>{2}));
+    assert((searchPhonePrefix(indices.phoneIndex, "749599999999999") == std::vector<int>{6}));
+    assert(searchPhonePrefix(indices.phoneIndex, "7496").empty());
+    assert(searchPhonePrefix(indices.phoneIndex, "74a").empty());
+    assert(searchPhonePrefix(indices.phoneIndex, "").size() == 6);
+
+    // Удаление записей из индекса
+    indices.removeRecords({ 1, 6 });
+    assert((searchPhonePrefix(indices.phoneIndex, "7495") == std::vector<int>{4, 3}));
+
+    std::cout << "=== Тестирование индекса по номеру телефона завершено ===\n\n";
+}
+
+/**
+ * @brief Функция для тестирования загрузки CSV через отображение файла в память.
+ */
+void testCsvLoader() {
+    std::cout << "=== Тестирование загрузки CSV ===\n";
+    // Поиск разделителей на границах 16-байтных блоков
+    std::string text(40, 'x');
+    assert(findDelimiter(text.data(), text.data() + text.size()) == text.data() + text.size());
+    for(std::size_t pos : { 0, 15, 16, 17, 31, 39 }) {
+        std::string probe = text;
+        probe[pos] = pos % 2 ? ',' : '\n';
+        assert(findDelimiter(probe.data(), probe.data() + probe.size()) == probe.data() + pos);
+    }
+
+    const std::string filename = "test_contacts.csv";
+    {
+        std::ofstream out(filename, std::ios::binary);
+        out << "3,Вера,3333333,Омск\r\n"
+            << "1,Анна Каренина-Вронская,1111111,Ростов-на-Дону, Россия\n"
+            << "\n"
+            << "строка без запятых\n"
+            << "x2,Ошибка,2222222,Тверь\n"
+            << "4,Глеб,12-3456,Тверь\n"
+            << "5,Дина,5555555,";
+    }
+    ContactStore contacts;
+    global_id_counter = 1;
+    assert(loadContactsFromFile(contacts, filename) == 3);
+    assert(contacts.size() == 3);
+    assert(contacts.at(0).name == "Анна Каренина-Вронская" && contacts.at(0).city == "Ростов-на-Дону, Россия");
+    assert(contacts.at(1).id == 3 && contacts.at(1).city == "Омск" && contacts.at(1).phoneNumber == "3333333");
+    assert(contacts.at(2).id == 5 && contacts.at(2).city.empty());
+    assert(global_id_counter == 6);
+
+    // Загрузка линейного списка использует тот же разбор
+    ContactStore listStore;
+    LinkedList list(listStore, PrimarySortAttribute::NAME, SecondarySortAttribute::CITY,
+                    SortOrder::ASCENDING, SortOrder::ASCENDING);
+    assert(list.loadFromFile(filename) == 3);
+    assert(listStore.size() == 3);
+    assert((list.insertionOrderIds() == std::vector<int>{3, 1, 5}));
+
+    // Файл с пропущенными строками не перезаписывается командой save, другой файл - можно
+    IndexArray indices;
+    BatchSession session(contacts, indices, filename, 3);
+    std::istringstream in("save\nsave " + filename + "\nsave test_contacts_copy.csv\n");
+    std::ostringstream out;
+    session.run(in, out);
+    assert(out.str() == "error: файл " + filename + " не перезаписан: при загрузке пропущено строк: 3\n"
+                        "error: файл " + filename + " не перезаписан: при загрузке пропущено строк: 3\n"
+                        "ok 3\n");
+    assert(std::filesystem::file_size(filename) > std::filesystem::file_size("test_contacts_copy.csv"));
+    std::remove("test_contacts_copy.csv");
+    std::remove(filename.c_str());
+
+    // Отсутствующий файл
+    assert(loadContactsFromFile(contacts, "missing_contacts.csv") == 0);
+    assert(contacts.size() == 3);
+
+    std::cout << "=== Тестирование загрузки CSV завершено ===\n\n";
+}
+
+/**
+ * @brief Функция для тестирования параллельной загрузки CSV.
+ */
+void testParallelLoader() {
+    std::cout << "=== Тестирование параллельной загрузки CSV ===\n";
+    ThreadPool pool(4);
+    std::vector<int> squares(100, 0);
+    pool.parallelFor(squares.size(), [&](std::size_t i) { squares[i] = static_cast<int>(i * i); });
+    assert(squares[0] == 0 && squares[99] == 99 * 99);
+
+    // Файл из многих частей; ID идут не по порядку, есть ошибочные строки
+    const std::string filename = "test_parallel.csv";
+    const char* cities[] = { "Москва", "Казань", "Омск", "Тверь", "Ростов-на-Дону" };
+    {
+        std::ofstream out(filename, std::ios::binary);
+        for(int i = 1; i <= 20000; ++i) {
+            int id = i % 1000 == 0 ? 30000 - i : i;
+            if(i % 4999 == 0)
+                out << "плохая строка " << i << "\n";
+            out << id << ",Имя" << i % 101 << "," << 1000000 + i << "," << cities[i % 5] << "\n";
+        }
+    }
+    ContactStore serial;
+    global_id_counter = 1;
+    std::size_t serialRejected = loadContactsFromFile(serial, filename);
+    int serialCounter = global_id_counter;
+
+    ContactStore parallel;
+    global_id_counter = 1;
+    std::size_t parallelRejected = loadContactsFromFileParallel(parallel, filename, pool);
+    std::remove(filename.c_str());
+
+    assert(global_id_counter == serialCounter && serialCounter == 29001);
+    assert(serialRejected == 4 && parallelRejected == 4);
+    assert(parallel.size() == serial.size() && parallel.size() == 20000);
+    for(std::size_t row = 0; row < serial.size(); ++row) {
+        assert(parallel.id(row) == serial.id(row));
+        assert(parallel.name(row) == serial.name(row));
+        assert(parallel.phoneNumber(row) == serial.phoneNumber(row));
+        assert(parallel.city(row) == serial.city(row));
+    }
+    assert(parallel.cityCount() == 5);
+
+    std::cout << "=== Тестирование параллельной загрузки CSV завершено ===\n\n";
+}
+
+/**
+ * @brief Функция для тестирования бинарного снимка.
+ */
+void testSnapshot() {
+    std::cout << "=== Тестирование бинарного снимка ===\n";
+    const char* cities[] = { "Москва", "Казань", "Омск" };
+    ContactStore contacts;
+    for(int i = 1; i <= 300; ++i)
+        contacts.push_back(Contact{i, "Имя" + std::to_string(i % 17), std::to_string(7000000 + i * 13), cities[i % 3]});
+    contacts.setName(contacts.rowOf(5), "Переименованный");
+    contacts.removeIf([](const ContactView& c) { return c.id % 10 == 0; });
+    IndexArray indices;
+    indices.buildIndices(contacts);
+    indices.sortIndices();
+
+    const std::string filename = "test_contacts.snapshot";
+    global_id_counter = 301;
+    assert(saveSnapshot(filename, contacts, indices));
+
+    ContactStore loaded;
+    IndexArray loadedIndices;
+    global_id_counter = 1;
+    assert(loadSnapshot(filename, loaded, loadedIndices));
+    assert(global_id_counter == 301);
+    assert(loaded.size() == contacts.size() && loaded.size() == 270);
+    for(std::size_t row = 0; row < contacts.size(); ++row) {
+        assert(loaded.id(row) == contacts.id(row) && loaded.name(row) == contacts.name(row));
+        assert(loaded.phoneNumber(row) == contacts.phoneNumber(row) && loaded.city(row) == contacts.city(row));
+    }
+    for(std::size_t i = 0; i < indices.nameIndexAsc.size(); ++i) {
+        assert(loadedIndices.nameIndexAsc[i].recordNumber == indices.nameIndexAsc[i].recordNumber);
+        assert(loadedIndices.nameIndexAsc[i].key == indices.nameIndexAsc[i].key);
+        assert(loadedIndices.nameIndexDesc[i].key == indices.nameIndexDesc[i].key);
+        assert(loadedIndices.phoneIndex[i].phone == indices.phoneIndex[i].phone);
+    }
+    assert(loadedIndices.cityIndexDesc.recordNumbers == indices.cityIndexDesc.recordNumbers);
+    assert(searchCity(loadedIndices.cityIndexAsc, loaded.findCity("Омск")) ==
+           searchCity(indices.cityIndexAsc, contacts.findCity("Омск")));
+    assert(binarySearchIterative(loadedIndices.nameIndexAsc, "Переименованный") == std::vector<int>{5});
+    assert(loaded.cityRanks() == contacts.cityRanks());
+
+    // Загруженное хранилище продолжает работать как обычно
+    loaded.push_back(Contact{400, "Новый", "1234567", "Тверь"});
+    assert(loaded.findCity("Тверь") == 3 && loaded.findCity("Казань") == contacts.findCity("Казань"));
+
+    // Усечённый файл отклоняется, хранилище не меняется
+    std::filesystem::resize_file(filename, std::filesystem::file_size(filename) - 8);
+    assert(!loadSnapshot(filename, loaded, loadedIndices));
+    assert(loaded.size() == 271);
+
+    // Индексы с номерами несуществующих записей и неупорядоченный индекс по телефону отклоняются
+    for(int corruption = 0; corruption < 4; ++corruption) {
+        IndexArray broken = indices;
+        if(corruption == 0)
+            broken.cityIndexAsc.recordNumbers[0] = 9999;
+        else if(corruption == 1)
+            broken.cityIndexDesc.recordNumbers.back() = 10;
+        else if(corruption == 2)
+            broken.phoneIndex[3].recordNumber = 9999;
+        else
+            std::swap(broken.phoneIndex[0], broken.phoneIndex[1]);
+        assert(saveSnapshot(filename, contacts, broken));
+        assert(!loadSnapshot(filename, loaded, loadedIndices));
+        assert(loaded.size() == 271);
+    }
+    std::remove(filename.c_str());
+    assert(!loadSnapshot(filename, loaded, loadedIndices));
+
+    std::cout << "=== Тестирование бинарного снимка завершено ===\n\n";
+}
+
+/**
+ * @brief Функция для тестирования построения дерева и списка из готовых данных.
+ */
+void testBulkBuild() {
+    std::cout << "=== Тестирование пакетного построения дерева и списка ===\n";
+    ContactStore contacts;
+    const char* names[] = { "Вера", "Анна", "Борис", "Анна", "Глеб", "Вера", "Анна" };
+    const char* cities[] = { "Омск", "Тверь", "Казань", "Казань", "Омск", "Москва", "Тверь" };
+    for(int i = 0; i < 7; ++i)
+        contacts.push_back(Contact{i + 1, names[i], std::to_string(1000000 + i), cities[i]});
+    IndexArray indices;
+    indices.buildIndices(contacts);
+    indices.sortIndices();
+
+    BinaryTree tree;
+    tree.buildFromIndex(indices.nameIndexAsc);
+    assert((tree.search("Анна") == std::vector<int>{2, 4, 7}));
+    assert((tree.search("Глеб") == std::vector<int>{5}));
+    assert(tree.search("Дина").empty());
+
+    // Пакетная вставка даёт тот же порядок, что и вставка по одному
+    LinkedList one(contacts, PrimarySortAttribute::NAME, SecondarySortAttribute::CITY,
+                   SortOrder::ASCENDING, SortOrder::DESCENDING);
+    LinkedList bulk(contacts, PrimarySortAttribute::NAME, SecondarySortAttribute::CITY,
+                    SortOrder::ASCENDING, SortOrder::DESCENDING);
+    one.insert(3);
+    bulk.insert(3);
+    std::vector<int> ids = { 6, 1, 2, 7, 4, 5, 3 };
+    for(int id : ids)
+        one.insert(id);
+    assert(bulk.insertAll(ids) == 6);
+    assert(bulk.searchIds("Анна") == one.searchIds("Анна"));
+    assert((bulk.searchIds("Анна") == std::vector<int>{2, 7, 4}));
+    assert(bulk.insertionOrderIds() == one.insertionOrderIds());
+
+    std::cout << "=== Тестирование пакетного построения дерева и списка завершено ===\n\n";
+}
+
+/**
+ * @brief Функция для тестирования журнала изменений.
+ */
+void testJournal() {
+    std::cout << "=== Тестирование журнала изменений ===\n";
+    const std::string filename = "test_contacts.journal";
+    std::remove(filename.c_str());
+
+    // Изменения поверх базового состояния (как после загрузки снимка)
+    ContactStore contacts;
+    contacts.push_back(Contact{1, "Анна", "1111111", "Москва"});
+    contacts.push_back(Contact{2, "Борис", "2222222", "Казань"});
+    {
+        Journal journal;
+        assert(journal.open(filename));
+        assert(journal.replay(contacts) == 0);
+        contacts.push_back(Contact{3, "Вера", "3333333", "Омск"});
+        journal.logInsert(contacts[2]);
+        contacts.setCity(0, "Тверь");
+        journal.logUpdate(contacts[0]);
+        journal.logDelete(2);
+        contacts.push_back(Contact{4, "Глеб", "4444444", "Омск"});
+        journal.logInsert(contacts[3]);
+        assert(journal.commit());
+        journal.logDelete(4); // Не зафиксировано до закрытия: пишется деструктором
+    }
+
+    auto replayed = [&]() {
+        ContactStore base;
+        base.push_back(Contact{1, "Анна", "1111111", "Москва"});
+        base.push_back(Contact{2, "Борис", "2222222", "Казань"});
+        Journal journal;
+        assert(journal.open(filename));
+        journal.replay(base);
+        return base;
+    };
+    global_id_counter = 1;
+    ContactStore restored = replayed();
+    assert(restored.size() == 2 && restored.id(0) == 1 && restored.id(1) == 3);
+    assert(restored.city(0) == "Тверь" && restored.name(1) == "Вера");
+    assert(global_id_counter == 5);
+
+    // Повторное применение поверх уже применённого состояния ничего не меняет
+    {
+        Journal journal;
+        assert(journal.open(filename));
+        assert(journal.replay(restored) == 5);
+        assert(restored.size() == 2 && restored.city(0) == "Тверь");
+    }
+
+    // Оборванная последняя запись отбрасывается, журнал продолжается после целых записей
+    std::uintmax_t intact = std::filesystem::file_size(filename);
+    {
+        std::ofstream out(filename, std::ios::binary | std::ios::app);
+        const char torn[] = "\x20\x00\x00\x00\x01\x02\x03\x04\x01";
+        out.write(torn, sizeof(torn) - 1);
+    }
+    {
+        Journal journal;
+        assert(journal.open(filename));
+        ContactStore base;
+        assert(journal.replay(base) == 5);
+        assert(std::filesystem::file_size(filename) == intact);
+        journal.logInsert(ContactView{ 7, "Дина", PackedPhone(), "Омск", 0 });
+        assert(journal.commit());
+    }
+    assert(replayed().size() == 3);
+
+    // После снимка журнал очищается
+    {
+        Journal journal;
+        assert(journal.open(filename));
+        assert(journal.reset());
+        ContactStore base;
+        assert(journal.replay(base) == 0 && journal.size() == 16);
+    }
+    std::remove(filename.c_str());
+
+    std::cout << "=== Тестирование журнала изменений завершено ===\n\n";
+}
+
 /**
  * @brief Главная функция для запуска всех тестов.
  */
+void testCsvWriter() {
+    std::cout << "=== Тестирование записи CSV ===\n";
+    const std::string filename = "test_writer.csv";
+    auto readAll = [](const std::string& name) {
+        std::ifstream in(name, std::ios::binary);
+        std::stringstream content;
+        content << in.rdbuf();
+        return content.str();
+    };
+
+    ContactStore contacts;
+    contacts.push_back(Contact{1, "Анна", "1111111", "Москва"});
+    contacts.push_back(Contact{2, "Борис", "222222222222222", "Ростов-на-Дону, Россия"});
+    saveContactsToFile(contacts, filename);
+    assert(readAll(filename) == "1,Анна,1111111,Москва\n2,Борис,222222222222222,Ростов-на-Дону, Россия\n");
+    assert(!std::filesystem::exists(filename + ".tmp"));
+
+    // Отменённая запись не затрагивает прежний файл
+    {
+        CsvWriter writer;
+        assert(writer.open(filename));
+        writer.write("обрывок");
+        assert(std::filesystem::exists(filename + ".tmp"));
+    }
+    assert(!std::filesystem::exists(filename + ".tmp"));
+    assert(readAll(filename) == "1,Анна,1111111,Москва\n2,Борис,222222222222222,Ростов-на-Дону, Россия\n");
+
+    // Файл больше буфера записывается несколькими блоками и читается обратно
+    ContactStore large;
+    for(int id = 1; id <= 60000; ++id)
+        large.push_back(Contact{id, "Имя" + std::to_string(id), std::to_string(1000000 + id), "Казань"});
+    saveContactsToFile(large, filename);
+    assert(std::filesystem::file_size(filename) > CsvWriter::bufferSize);
+    ContactStore loaded;
+    loadContactsFromFile(loaded, filename);
+    assert(loaded.size() == large.size());
+    assert(loaded.at(59999).id == 60000 && loaded.at(59999).name == "Имя60000" && loaded.at(59999).phoneNumber == "1060000");
+
+    // Линейный список пишется в своём порядке
+    LinkedList list(contacts, PrimarySortAttribute::NAME, SecondarySortAttribute::CITY,
+                    SortOrder::DESCENDING, SortOrder::ASCENDING);
+    list.insertAll({ 1, 2 });
+    list.saveToFile(filename);
+    assert(readAll(filename) == "2,Борис,222222222222222,Ростов-на-Дону, Россия\n1,Анна,1111111,Москва\n");
+
+    // Перезаписанный файл сохраняет права доступа
+    namespace fs = std::filesystem;
+    fs::permissions(filename, fs::perms::owner_read | fs::perms::owner_write);
+    saveContactsToFile(contacts, filename);
+    assert(fs::status(filename).permissions() == (fs::perms::owner_read | fs::perms::owner_write));
+    std::remove(filename.c_str());
+
+    std::cout << "=== Тестирование записи CSV завершено ===\n\n";
+}
+
+void testExternalIndex() {
+    std::cout << "=== Тестирование индекса во внешней памяти ===\n";
+    const std::string csvFile = "test_external.csv";
+    const std::string indexFile = "test_external.idx";
+    const char* cities[] = { "Москва", "Омск", "Казань", "Тверь" };
+    {
+        std::ofstream out(csvFile, std::ios::binary);
+        for(int id = 1; id <= 5000; ++id)
+            out << id << ",Имя" << id % 97 << "," << 9000000 + (id * 7919) % 5000 << "," << cities[id % 4] << "\n";
+        out << "5001,Ошибка,12-34,Омск\n";
+    }
+    ContactStore contacts;
+    loadContactsFromFile(contacts, csvFile);
+    IndexArray indices;
+    indices.buildIndices(contacts);
+    indices.sortIndices();
+
+    // Малый объём памяти: десятки отрезков и многопутевое слияние
+    assert(buildExternalIndex(csvFile, indexFile, IndexKey::NAME, 4096));
+    assert(!std::filesystem::exists(indexFile + ".run0") && !std::filesystem::exists(indexFile + ".tmp"));
+    DiskIndex names;
+    assert(names.open(indexFile));
+    assert(names.size() == 5000 && names.key() == IndexKey::NAME);
+    for(std::size_t i = 0; i < names.size(); ++i) {
+        assert(names.keyAt(i) == indices.nameIndexAsc[i].key);
+        // Равные ключи упорядочены по ID
+        assert(i == 0 || names.keyAt(i - 1) != names.keyAt(i) || names.recordNumber(i - 1) < names.recordNumber(i));
+    }
+    std::vector<int> expected = binarySearchIterative(indices.nameIndexAsc, "Имя42");
+    std::sort(expected.begin(), expected.end());
+    assert(names.search("Имя42") == expected);
+    assert(expected.size() == 52);
+    assert(names.search("Нет").empty());
+
+    // Смещение строки указывает на контакт в CSV-файле
+    MappedFile csv;
+    assert(csv.open(csvFile));
+    auto found = names.equalRange("Имя5");
+    assert(found.second > found.first);
+    std::string_view line = csv.view().substr(names.lineOffset(found.first));
+    assert(line.substr(0, line.find(',')) == std::to_string(names.recordNumber(found.first)));
+
+    // Индекс по телефону с поиском по префиксу
+    assert(buildExternalIndex(csvFile, indexFile, IndexKey::PHONE, 1 << 20));
+    DiskIndex phones;
+    assert(phones.open(indexFile));
+    auto range = phones.prefixRange("900012");
+    std::vector<int> byPrefix;
+    for(std::size_t i = range.first; i < range.second; ++i)
+        byPrefix.push_back(phones.recordNumber(i));
+    assert(byPrefix == searchPhonePrefix(indices.phoneIndex, "900012"));
+    assert(byPrefix.size() == 10);
+
+    // Сжатый индекс с фронтальным кодированием отвечает так же, как несжатый
+    const std::string compressedFile = "test_external.fci";
+    for(IndexKey key : { IndexKey::NAME, IndexKey::CITY, IndexKey::PHONE }) {
+        assert(buildExternalIndex(csvFile, indexFile, key, 4096));
+        assert(buildExternalIndex(csvFile, compressedFile, key, 4096, IndexFormat::FRONT_CODED));
+        DiskIndex plain;
+        FrontCodedIndex compressed;
+        assert(plain.open(indexFile) && compressed.open(compressedFile));
+        assert(compressed.size() == plain.size() && compressed.key() == key);
+        assert(std::filesystem::file_size(compressedFile) * 3 < std::filesystem::file_size(indexFile));
+        // Первый и последний ключи, ключи на границах блоков, отсутствующие ключи
+        std::vector<std::string> probes = { "", "Я", "0", std::string(plain.keyAt(0)), std::string(plain.keyAt(plain.size() - 1)) };
+        for(std::size_t i = 63; i < plain.size(); i += 640)
+            probes.push_back(std::string(plain.keyAt(i)));
+        for(const std::string& probe : probes) {
+            assert(compressed.search(probe) == plain.search(probe));
+            for(std::size_t cut = 0; cut <= probe.size(); cut += 3) {
+                std::string prefix = probe.substr(0, cut);
+                auto range = plain.prefixRange(prefix);
+                std::size_t position = range.first;
+                std::size_t found = compressed.find(prefix, true, [&](std::string_view k, int id, std::uint64_t line) {
+                    assert(k == plain.keyAt(position) && id == plain.recordNumber(position) && line == plain.lineOffset(position));
+                    ++position;
+                });
+                assert(found == range.second - range.first);
+            }
+        }
+    }
+    std::remove(compressedFile.c_str());
+
+    // Повреждённый файл не открывается
+    {
+        std::ofstream out(indexFile, std::ios::binary);
+        out << "не индекс";
+    }
+    assert(!phones.open(indexFile));
+    FrontCodedIndex damaged;
+    assert(!damaged.open(indexFile));
+    std::remove(indexFile.c_str());
+    std::remove(csvFile.c_str());
+
+    std::cout << "=== Тестирование индекса во внешней памяти завершено ===\n\n";
+}
+
+void testContactDiff() {
+    std::cout << "=== Тестирование сравнения и синхронизации ===\n";
+    ContactStore base, other;
+    base.push_back(Contact{1, "Анна", "1111111", "Москва"});
+    base.push_back(Contact{2, "Борис", "2222222", "Омск"});
+    base.push_back(Contact{4, "Глеб", "4444444", "Тверь"});
+    base.push_back(Contact{6, "Егор", "6666666", "Казань"});
+    // Словарь городов второго хранилища заполняется в другом порядке
+    other.push_back(Contact{2, "Борис", "2222222", "Омск"});
+    other.push_back(Contact{3, "Вера", "3333333", "Омск"});
+    other.push_back(Contact{4, "Глеб", "4444444", "Москва"});
+    other.push_back(Contact{6, "Егор", "6666666", "Казань"});
+    other.push_back(Contact{7, "Жанна", "7777777", "Тверь"});
+
+    ContactDiff diff = diffContacts(base, other);
+    assert((diff.added == std::vector<std::size_t>{1, 4}));
+    assert((diff.removed == std::vector<std::size_t>{0}));
+    assert(diff.changed.size() == 1 && diff.changed[0].first == 2 && diff.changed[0].second == 2);
+    std::ostringstream out;
+    printContactDiff(out, base, other, diff);
+    assert(out.str() == "+ 3,Вера,3333333,Омск\n+ 7,Жанна,7777777,Тверь\n- 1,Анна,1111111,Москва\n"
+                        "~ 4: Глеб,4444444,Тверь -> Глеб,4444444,Москва\n");
+    assert(diffContacts(other, other).empty());
+
+    // Применение: хранилища совпадают, новые ID учтены счётчиком
+    global_id_counter = 1;
+    LinkedList list(base, PrimarySortAttribute::CITY, SecondarySortAttribute::NAME,
+                    SortOrder::ASCENDING, SortOrder::ASCENDING);
+    list.insertAll({ 1, 2, 4, 6 });
+    applyContactDiff(base, other, diff);
+    assert(diffContacts(base, other).empty());
+    assert(base.size() == 5 && base.id(1) == 3 && global_id_counter == 8);
+    list.removeIds({ 1 });
+    list.updateAll({ 4 });
+    list.insertAll({ 3, 7 });
+    assert((list.insertionOrderIds() == std::vector<int>{2, 4, 6, 3, 7}));
+    std::vector<int> sortedIds;
+    for(const char* city : { "Казань", "Москва", "Омск", "Тверь" }) {
+        std::vector<int> found = list.searchIds(city);
+        sortedIds.insert(sortedIds.end(), found.begin(), found.end());
+    }
+    assert((sortedIds == std::vector<int>{6, 4, 2, 3, 7}));
+
+    // Слияние пакета с пересекающимися ID одним проходом
+    ContactStore batch;
+    batch.push_back(Contact{5, "Дина", "5555555", "Сочи"});
+    batch.push_back(Contact{8, "Зоя", "8888888", "Омск"});
+    base.appendBatch(batch);
+    assert(base.size() == 7 && base.id(3) == 5 && base.at(3).city == "Сочи" && base.at(6).name == "Зоя");
+    assert(base.rowOf(7) == 5 && base.at(5).name == "Жанна");
+
+    std::cout << "=== Тестирование сравнения и синхронизации завершено ===\n\n";
+}
+
+void testReportWriter() {
+    std::cout << "=== Тестирование вывода отчётов ===\n";
+    ContactStore contacts;
+    contacts.push_back(Contact{1, "Анна", "1111111", "Москва"});
+    contacts.push_back(Contact{2, "Борис \"Бо\"\tБ", "2222222", "Омск\\Север"});
+    contacts.push_back(Contact{3, "Вера", "3333333", "Тверь"});
+
+    // Текстовый формат совпадает с прежними карточками
+    {
+        std::ostringstream out;
+        {
+            ReportWriter report(out);
+            report.heading("Контакты:\n");
+            assert(report.write(contacts, 1));
+        }
+        assert(out.str() == "Контакты:\nID: 1\nИмя: Анна\nНомер телефона: 1111111\nГород: Москва\n"
+                            "-----------------------------\n");
+    }
+
+    // TSV и JSON Lines: заголовки пропускаются, служебные символы экранируются
+    {
+        std::ostringstream out;
+        {
+            ReportOptions options;
+            options.format = ReportFormat::TSV;
+            ReportWriter report(out, options);
+            report.heading("не выводится\n");
+            printContacts(contacts, report);
+        }
+        assert(out.str() == "id\tname\tphone\tcity\n1\tАнна\t1111111\tМосква\n"
+                            "2\tБорис \"Бо\"\\tБ\t2222222\tОмск\\\\Север\n3\tВера\t3333333\tТверь\n");
+    }
+    {
+        std::ostringstream out;
+        {
+            ReportOptions options;
+            options.format = ReportFormat::JSONL;
+            ReportWriter report(out, options);
+            report.write(contacts, std::vector<int>{2});
+        }
+        assert(out.str() == "{\"id\":2,\"name\":\"Борис \\\"Бо\\\"\\tБ\",\"phone\":\"2222222\",\"city\":\"Омск\\\\Север\"}\n");
+    }
+
+    // Страница: пропуск первых контактов, ограничение и досрочное завершение обхода
+    {
+        std::ostringstream out;
+        ReportOptions options;
+        options.format = ReportFormat::JSONL;
+        options.offset = 1;
+        options.limit = 1;
+        {
+            ReportWriter report(out, options);
+            BinaryTree tree;
+            for(std::size_t row = 0; row < contacts.size(); ++row)
+                tree.insert(std::string(contacts.name(row)), contacts.id(row));
+            tree.inOrder(contacts, report, false);
+            assert(report.count() == 1 && report.full());
+        }
+        assert(out.str().find("\"id\":2") != std::string::npos && out.str().find("\"id\":3") == std::string::npos);
+
+        std::ostringstream text;
+        options.format = ReportFormat::TEXT;
+        {
+            ReportWriter report(text, options);
+            LinkedList list(contacts, PrimarySortAttribute::NAME, SecondarySortAttribute::CITY,
+                            SortOrder::ASCENDING, SortOrder::ASCENDING);
+            list.insertAll({ 3, 1, 2 });
+            list.printInsertionOrder(report);
+        }
+        assert(text.str().find("ID: 1\n") != std::string::npos && text.str().find("ID: 3\n") == std::string::npos);
+        assert(text.str().find("Показаны контакты 2-2") != std::string::npos);
+    }
+
+    std::cout << "=== Тестирование вывода отчётов завершено ===\n\n";
+}
+
+void testBatchMode() {
+    std::cout << "=== Тестирование пакетного режима ===\n";
+    ContactStore contacts;
+    contacts.push_back(Contact{1, "Анна", "1111111", "Москва"});
+    contacts.push_back(Contact{2, "Борис", "2222222", "Омск"});
+    contacts.push_back(Contact{3, "Вера", "3333333", "Москва"});
+    global_id_counter = 4;
+    IndexArray indices;
+    BatchSession session(contacts, indices, "batch_test.csv");
+
+    std::istringstream in(
+        "# поиск до изменений строит индексы\n"
+        "format tsv\n"
+        "find city Москва\n"
+        "insert Галина,4444444,Тверь\n"
+        "edit 2 ,5555555,\n"
+        "edit 9 Имя,,\n"
+        "delete 1\n"
+        "delete 1\n"
+        "delete 3\n"
+        "find phone 5555555\n"
+        "find name Анна\n"
+        "list name desc limit 1\n"
+        "insert ,123,Город\n"
+        "unknown\n"
+        "quit\n"
+        "find name Галина\n");
+    std::ostringstream out;
+    std::size_t executed = session.run(in, out);
+    assert(executed == 15);
+    assert(out.str() == "ok\n"
+                        "id\tname\tphone\tcity\n1\tАнна\t1111111\tМосква\n3\tВера\t3333333\tМосква\nok 2\n"
+                        "ok 4\n"
+                        "ok 2\n"
+                        "error: контакт с ID 9 не найден\n"
+                        "ok 1\n"
+                        "error: контакт с ID 1 не найден\n"
+                        "ok 3\n"
+                        "id\tname\tphone\tcity\n2\tБорис\t5555555\tОмск\nok 1\n"
+                        "id\tname\tphone\tcity\nok 0\n"
+                        "id\tname\tphone\tcity\n4\tГалина\t4444444\tТверь\nok 1\n"
+                        "error: некорректные поля контакта\n"
+                        "error: неизвестная команда \"unknown\"\n");
+
+    // Удаления выполнены одним проходом, индексы согласованы с хранилищем
+    assert(contacts.size() == 2 && contacts.rowOf(1) == ContactStore::npos && contacts.rowOf(3) == ContactStore::npos);
+    assert(indices.nameIndexAsc.size() == 2 && indices.phoneIndex.size() == 2);
+
+    // Сохранение и повторная загрузка
+    std::istringstream save("delete 4\nsave\n");
+    std::ostringstream saved;
+    session.run(save, saved);
+    assert(saved.str() == "ok 4\nok 1\n");
+    ContactStore loaded;
+    loadContactsFromFile(loaded, "batch_test.csv");
+    assert(loaded.size() == 1 && loaded.name(0) == "Борис");
+    std::remove("batch_test.csv");
+
+    std::cout << "=== Тестирование пакетного режима завершено ===\n\n";
+}
+
+void testServer() {
+    std::cout << "=== Тестирование сервера запросов ===\n";
+    ContactStore contacts;
+    const char* cities[] = { "Москва", "Омск", "Тверь" };
+    for(int i = 1; i <= 300; ++i)
+        contacts.push_back(Contact{i, "Имя" + std::to_string(i % 10), std::to_string(1000000 + i), cities[i % 3]});
+    global_id_counter = 301;
+    IndexArray indices;
+    BatchSession session(contacts, indices, "server_test.csv");
+    ThreadPool pool(4);
+    ContactServer server(session, pool);
+    const std::string socketPath = "server_test.sock";
+    assert(server.listen(socketPath));
+    std::thread dispatcher([&]() { server.run(); });
+
+    // Параллельные запросы из нескольких соединений, одно из них добавляет контакты
+    const int clients = 4, requests = 200;
+    std::atomic<int> failures(0);
+    std::vector<std::thread> threads;
+    for(int t = 0; t < clients; ++t) {
+        threads.emplace_back([&, t]() {
+            ServerClient client;
+            if(!client.connect(socketPath)) {
+                ++failures;
+                return;
+            }
+            std::string response;
+            if(!client.request("format tsv", response) || response != "ok\n")
+                ++failures;
+            // Команды отправляются окнами, не дожидаясь ответов
+            for(int i = 0; i < requests; i += 10) {
+                for(int j = i; j < i + 10; ++j) {
+                    if(t == 0)
+                        client.send("insert Новый,2" + std::to_string(j) + "000000,Казань");
+                    else
+                        client.send("find name Имя" + std::to_string(j % 10));
+                }
+                for(int j = i; j < i + 10; ++j) {
+                    if(!client.receive(response))
+                        ++failures;
+                    else if(t != 0 && response.size() - response.rfind("ok 30\n") != 6)
+                        ++failures;
+                    else if(t == 0 && response.compare(0, 3, "ok ") != 0)
+                        ++failures;
+                }
+            }
+            if(!client.request("quit", response) || response != "ok\n")
+                ++failures;
+        });
+    }
+    for(auto& thread : threads)
+        thread.join();
+    assert(failures == 0);
+
+    // После всех изменений запросы видят добавленные контакты
+    {
+        ServerClient client;
+        assert(client.connect(socketPath));
+        std::string response;
+        assert(client.request("find city Казань", response));
+        assert(response.size() > 5 && response.compare(response.size() - 7, 7, "ok 200\n") == 0);
+        assert(client.request("tree Новый", response) && response.find("ok 200\n") != std::string::npos);
+        assert(client.request("unknown", response) && response.compare(0, 6, "error:") == 0);
+    }
+    assert(server.requests() == clients * (requests + 2) + 3);
+
+    // Строка длиннее предела отклоняется, соединение закрывается
+    {
+        ServerClient client;
+        assert(client.connect(socketPath));
+        std::string response;
+        assert(client.request(std::string(100000, 'x'), response) && response.compare(0, 6, "error:") == 0);
+        assert(!client.request("find city Казань", response));
+    }
+
+    // Клиент, который не читает ответы, не задерживает остановку дольше времени ожидания отправки
+    ServerClient stalled;
+    assert(stalled.connect(socketPath));
+    for(int i = 0; i < 100; ++i)
+        assert(stalled.send("list name"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    auto stopStart = std::chrono::steady_clock::now();
+    server.stop();
+    dispatcher.join();
+    assert(std::chrono::steady_clock::now() - stopStart < std::chrono::seconds(30));
+    assert(contacts.size() == 500);
+    std::filesystem::remove(socketPath);
+
+    std::cout << "=== Тестирование сервера запросов завершено ===\n\n";
+}
+
+/**
+ * @brief Тестирование гистограмм длительностей и статистики операций.
+ */
+void testOperationStats() {
+    std::cout << "=== Тестирование статистики операций ===\n";
+    // Корзины идут подряд, значение попадает в свою корзину, погрешность границы не больше 1/16
+    for(std::uint64_t value : { 0ull, 1ull, 31ull, 32ull, 33ull, 1000ull, 123456789ull, ~0ull }) {
+        std::size_t bucket = LatencyHistogram::bucketOf(value);
+        assert(bucket < LatencyHistogram::bucketCount);
+        std::uint64_t upper = LatencyHistogram::bucketUpper(bucket);
+        assert(upper >= value && upper - value <= value / 16);
+        assert(bucket == 0 || LatencyHistogram::bucketUpper(bucket - 1) < value);
+    }
+
+    LatencyHistogram histogram;
+    for(std::uint64_t value = 1; value <= 1000; ++value)
+        histogram.record(value * 1000);
+    assert(histogram.count() == 1000 && histogram.max() == 1000000);
+    assert(histogram.total() == 500500000);
+    std::uint64_t median = histogram.percentile(50);
+    assert(median >= 500000 && median <= 500000 + 500000 / 16);
+    assert(histogram.percentile(100) == 1000000);
+    histogram.reset();
+    assert(histogram.count() == 0 && histogram.percentile(99) == 0);
+
+#if CONTACT_STATS
+    // Пакетный режим замеряет поиск и изменения и выводит их командой stats
+    operationStats().reset();
+    ContactStore contacts;
+    contacts.push_back(Contact{1, "Анна", "1111111", "Москва"});
+    global_id_counter = 2;
+    IndexArray indices;
+    BatchSession session(contacts, indices, "stats_test.csv");
+    std::istringstream in("find name Анна\ninsert Борис,2222222,Омск\nstats\n");
+    std::ostringstream out;
+    session.run(in, out);
+    const OperationStats& stats = operationStats();
+    assert(stats.histogram(StatOperation::SEARCH).count() >= 1);
+    assert(stats.histogram(StatOperation::INSERT).count() == 1);
+    assert(stats.histogram(StatOperation::INDEX_SORT).count() == 1);
+    assert(stats.value(StatCounter::FOUND) >= 1);
+    assert(out.str().find("\nпоиск ") != std::string::npos);
+    assert(out.str().find("\nдобавление ") != std::string::npos);
+    assert(out.str().compare(out.str().size() - 3, 3, "ok\n") == 0);
+
+    std::istringstream reset("stats reset\nstats bad\n");
+    out.str("");
+    session.run(reset, out);
+    assert(out.str().compare(0, 3, "ok\n") == 0 && out.str().find("error:") != std::string::npos);
+    assert(stats.histogram(StatOperation::SEARCH).count() == 0);
+#endif
+
+    std::cout << "=== Тестирование статистики операций завершено ===\n\n";
+}
+
+/**
+ * @brief Тестирование отчёта о памяти структур данных.
+ */
+void testMemoryUsage() {
+    std::cout << "=== Тестирование отчёта о памяти ===\n";
+    assert(heapBlockBytes(0) == 0 && heapBlockBytes(1) == 32 && heapBlockBytes(24) == 32 && heapBlockBytes(25) == 48);
+    assert(heapBlockBytes(1 << 20) % 4096 == 0 && heapBlockBytes(1 << 20) > (1 << 20));
+
+    // Короткие строки во встроенном буфере кучу не занимают
+    MemoryUsage strings;
+    strings.addString("Анна");
+    assert(strings.heapBytes == 0 && strings.usedBytes == 0);
+    strings.addString(std::string(100, 'x'));
+    assert(strings.usedBytes == 100 && strings.heapBytes >= 101);
+
+    // Одинаковые блоки учитываются одним вызовом так же, как по одному
+    MemoryUsage single, counted;
+    for(int i = 0; i < 1000; ++i)
+        single.addBlock(40, 56);
+    counted.addBlocks(1000, 40, 56);
+    assert(counted.usedBytes == single.usedBytes && counted.heapBytes == single.heapBytes);
+
+    ContactStore contacts;
+    for(int id = 1; id <= 100; ++id)
+        contacts.push_back(Contact{id, "Контакт с длинным именем " + std::to_string(id % 10), "1234567",
+                                   id % 2 ? "Москва" : "Омск"});
+    IndexArray indices;
+    indices.buildIndices(contacts);
+    indices.sortIndices();
+    BinaryTree tree;
+    tree.buildFromIndex(indices.nameIndexAsc);
+    LinkedList list(contacts, PrimarySortAttribute::NAME, SecondarySortAttribute::CITY,
+                    SortOrder::ASCENDING, SortOrder::ASCENDING);
+    std::vector<int> ids;
+    for(const auto& contact : contacts)
+        ids.push_back(contact.id);
+    list.insertAll(ids);
+
+    MemoryUsage store = contacts.memoryUsage();
+    MemoryUsage index = indices.memoryUsage();
+    MemoryUsage nodes = tree.memoryUsage();
+    MemoryUsage listNodes = list.memoryUsage();
+    assert(store.elements == 100 && index.elements == 500 && nodes.elements == 10 && listNodes.elements == 100);
+    for(const MemoryUsage& usage : { store, index, nodes, listNodes })
+        assert(usage.usedBytes > 0 && usage.heapBytes >= usage.usedBytes);
+    // Ключи индексов по имени длиннее встроенного буфера и лежат в куче
+    assert(index.usedBytes >= 200 * (sizeof(Index) + std::string("Контакт с длинным именем 1").size()));
+
+    std::ostringstream report;
+    printMemoryReport({ { "контакты", store }, { "дерево", nodes } }, report);
+    assert(report.str().find("\nконтакты ") != std::string::npos && report.str().find("\nитого ") != std::string::npos);
+
+    std::cout << "=== Тестирование отчёта о памяти завершено ===\n\n";
+}
+
+/**
+ * @brief Тестирование трассировки фаз и экспорта в формат Chrome trace.
+ */
+void testTrace() {
+    std::cout << "=== Тестирование трассировки ===\n";
+    // До включения интервалы не записываются
+    { TraceSpan ignored("до включения"); }
+    startTracing();
+    assert(tracingEnabled());
+
+    // Больше событий, чем помещается в один блок буфера
+    for(std::size_t i = 0; i < TraceBuffer::blockEvents + 10; ++i) {
+        TraceSpan span("span");
+    }
+    ContactStore contacts;
+    for(int id = 1; id <= 1000; ++id)
+        contacts.push_back(Contact{id, "Имя" + std::to_string(id % 37), "1234567", "Город"});
+    {
+        ThreadPool pool(2);
+        // parallelFor может выполнить задачи в ожидающем потоке; submit и wait - только в рабочих
+        for(int i = 0; i < 4; ++i)
+            pool.submit([]() { TraceSpan span("worker \"task\""); });
+        pool.wait();
+        IndexArray indices;
+        indices.buildIndices(contacts);
+        indices.sortIndices();
+    }
+
+    const std::string traceFile = "trace_test.json";
+    long long events = writeChromeTrace(traceFile);
+    // Интервалы построения индексов задаёт макрос TRACE_SPAN, который без CONTACT_STATS пуст
+    std::size_t macroSpans = CONTACT_STATS ? 5 : 0;
+    assert(events >= static_cast<long long>(TraceBuffer::blockEvents + 10 + 4 + macroSpans));
+    std::ifstream in(traceFile);
+    std::stringstream content;
+    content << in.rdbuf();
+    std::string json = content.str();
+    assert(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0) == 0);
+    assert(json.compare(json.size() - 4, 4, "\n]}\n") == 0);
+    assert(json.find("\"args\":{\"name\":\"pool worker\"}") != std::string::npos);
+    assert(json.find("\"name\":\"worker \\\"task\\\"\"") != std::string::npos);
+#if CONTACT_STATS
+    assert(json.find("\"name\":\"IndexArray::sortIndices\",\"cat\":\"contacts\",\"ph\":\"X\"") != std::string::npos);
+    assert(json.find("\"name\":\"sort name asc\"") != std::string::npos);
+#endif
+    assert(json.find("до включения") == std::string::npos);
+    std::remove(traceFile.c_str());
+
+    std::cout << "=== Тестирование трассировки завершено ===\n\n";
+}
+
+/**
+ * @brief Тестирование параллельного построения индексов: результат совпадает с последовательным.
+ */
+void testParallelIndices() {
+    std::cout << "=== Тестирование параллельного построения индексов ===\n";
+    ContactStore contacts;
+    const char* cities[] = { "Москва", "Омск", "Тверь", "Казань", "Сочи" };
+    for(int id = 1; id <= 30000; ++id) {
+        // Много равных имён и номеров: порядок внутри групп задаётся номером записи
+        contacts.push_back(Contact{id, "Имя" + std::to_string((id * 7919) % 1013), std::to_string(1000000 + id % 977),
+                                   cities[(id * 31) % 5]});
+    }
+    IndexArray sequential;
+    sequential.buildIndices(contacts);
+    sequential.sortIndices();
+
+    auto sameNames = [](const std::vector<Index>& a, const std::vector<Index>& b) {
+        if(a.size() != b.size())
+            return false;
+        for(std::size_t i = 0; i < a.size(); ++i) {
+            if(a[i].key != b[i].key || a[i].recordNumber != b[i].recordNumber)
+                return false;
+        }
+        return true;
+    };
+    for(std::size_t threads : { 1, 3, 4 }) {
+        ThreadPool pool(threads);
+        IndexArray parallel;
+        parallel.buildIndices(contacts, pool);
+        // Обработчик видит уже отсортированный индекс по имени и вызывается один раз
+        int hookCalls = 0;
+        parallel.sortIndices(pool, [&]() {
+            assert(sameNames(parallel.nameIndexAsc, sequential.nameIndexAsc));
+            ++hookCalls;
+        });
+        assert(hookCalls == 1);
+        assert(sameNames(parallel.nameIndexAsc, sequential.nameIndexAsc));
+        assert(sameNames(parallel.nameIndexDesc, sequential.nameIndexDesc));
+        assert(parallel.phoneIndex.size() == sequential.phoneIndex.size());
+        for(std::size_t i = 0; i < parallel.phoneIndex.size(); ++i) {
+            assert(parallel.phoneIndex[i].phone == sequential.phoneIndex[i].phone);
+            assert(parallel.phoneIndex[i].recordNumber == sequential.phoneIndex[i].recordNumber);
+        }
+        for(auto index : { std::make_pair(&parallel.cityIndexAsc, &sequential.cityIndexAsc),
+                           std::make_pair(&parallel.cityIndexDesc, &sequential.cityIndexDesc) }) {
+            assert(index.first->recordNumbers == index.second->recordNumbers);
+            assert(index.first->bucketStart == index.second->bucketStart);
+            assert(index.first->bucketOfCode == index.second->bucketOfCode);
+        }
+    }
+    // Равные ключи идут по возрастанию номера записи в обоих направлениях
+    for(std::size_t i = 1; i < sequential.nameIndexDesc.size(); ++i) {
+        const Index& a = sequential.nameIndexDesc[i - 1];
+        const Index& b = sequential.nameIndexDesc[i];
+        assert(a.key > b.key || (a.key == b.key && a.recordNumber < b.recordNumber));
+    }
+
+    std::cout << "=== Тестирование параллельного построения индексов завершено ===\n\n";
+}
+
+/**
+ * @brief Тестирование планировщика с перехватом задач: вложенные группы и параллельный пакет запросов.
+ */
+void testWorkStealing() {
+    std::cout << "=== Тестирование планировщика задач ===\n";
+    ThreadPool pool(2);
+
+    // Вложенный parallelFor изнутри задач пула: ожидание выполняет задачи, а не блокирует поток
+    std::atomic<int> inner(0);
+    pool.parallelFor(8, [&](std::size_t) {
+        pool.parallelFor(100, [&](std::size_t) { inner.fetch_add(1); });
+    });
+    assert(inner.load() == 800);
+
+    // Рекурсивное разбиение fork/join
+    std::vector<long long> values(100000);
+    std::iota(values.begin(), values.end(), 1);
+    std::function<long long(std::size_t, std::size_t)> sum = [&](std::size_t from, std::size_t to) {
+        if(to - from <= 1000)
+            return std::accumulate(values.begin() + from, values.begin() + to, 0LL);
+        std::size_t middle = from + (to - from) / 2;
+        long long left = 0, right = 0;
+        parallelInvoke(pool, [&]() { left = sum(from, middle); }, [&]() { right = sum(middle, to); });
+        return left + right;
+    };
+    assert(sum(0, values.size()) == 100000LL * 100001 / 2);
+
+    // Группа ждёт только своих задач; wait пула - всех
+    std::atomic<int> submitted(0);
+    {
+        TaskGroup group(pool);
+        for(int i = 0; i < 50; ++i)
+            group.run([&]() { pool.submit([&]() { submitted.fetch_add(1); }); });
+    }
+    pool.wait();
+    assert(submitted.load() == 50);
+
+    // Пакет с параллельными запросами выводит то же, что последовательный
+    auto fill = [](ContactStore& contacts) {
+        const char* cities[] = { "Москва", "Омск", "Тверь" };
+        for(int id = 1; id <= 3000; ++id)
+            contacts.push_back(Contact{id, "Имя" + std::to_string(id % 211), std::to_string(2000000 + id), cities[id % 3]});
+    };
+    std::string script = "format tsv\n";
+    for(int i = 0; i < 200; ++i) {
+        script += "find name Имя" + std::to_string(i % 230) + "\n";
+        script += "tree Имя" + std::to_string(i * 7 % 211) + "\n";
+        script += "find phone " + std::to_string(2000000 + i * 13) + "\n";
+        if(i % 50 == 10)
+            script += "delete " + std::to_string(i + 1) + "\ninsert Имя5,7777777,Сочи\nlist city desc limit 3\n";
+        if(i % 50 == 30)
+            script += "find city Сочи\nlist name offset 5 limit 2\nfind prefix 20001\n";
+    }
+    ContactStore serialContacts, parallelContacts;
+    fill(serialContacts);
+    fill(parallelContacts);
+    IndexArray serialIndices, parallelIndices;
+    BatchSession serial(serialContacts, serialIndices, "serial_test.csv");
+    BatchSession parallel(parallelContacts, parallelIndices, "parallel_test.csv");
+    std::istringstream serialIn(script), parallelIn(script);
+    std::ostringstream serialOut, parallelOut;
+    global_id_counter = 3001;
+    std::size_t serialExecuted = serial.run(serialIn, serialOut);
+    global_id_counter = 3001;
+    std::size_t parallelExecuted = parallel.run(parallelIn, parallelOut, pool);
+    assert(serialExecuted == parallelExecuted);
+    assert(serialOut.str() == parallelOut.str());
+    assert(serialOut.str().find("Сочи") != std::string::npos);
+
+    std::cout << "=== Тестирование планировщика задач завершено ===\n\n";
+}
+
 int main() {
     // Тестирование AVL-дерева
     testAVLInsertion();
@@ -171,6 +1547,32 @@ int main() {
 
     // Тестирование линейного списка
     testLinkedList();
+    testLinkedListUpdate();
+
+    // Тестирование пакетного удаления
+    testBatchRemoval();
+
+    // Тестирование колоночного хранилища
+    testContactStore();
+    testCityDictionary();
+    testPackedPhone();
+    testPhoneIndex();
+    testCsvLoader();
+    testCsvWriter();
+    testParallelLoader();
+    testSnapshot();
+    testBulkBuild();
+    testParallelIndices();
+    testWorkStealing();
+    testJournal();
+    testExternalIndex();
+    testContactDiff();
+    testReportWriter();
+    testBatchMode();
+    testServer();
+    testOperationStats();
+    testMemoryUsage();
+    testTrace();
 
     return 0;
 }
@@ -0,0 +1,160 @@
+// thread_pool.cpp
+
+#include "thread_pool.h"
+#include "trace.h"
+#include <chrono>
+
+namespace {
+    thread_local ThreadPool* currentPool = nullptr;    // Пул, которому принадлежит текущий поток
+    thread_local std::size_t currentQueue = 0;         // Очередь текущего потока в этом пуле
+}
+
+// Конструктор
+ThreadPool::ThreadPool(std::size_t threads) : queued(0), unfinished(0), nextQueue(0), stopping(false) {
+    if(threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if(threads == 0)
+        threads = 1;
+    queues.reserve(threads);
+    for(std::size_t i = 0; i < threads; ++i)
+        queues.push_back(std::make_unique<WorkerQueue>());
+    workers.reserve(threads);
+    for(std::size_t i = 0; i < threads; ++i)
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+// Деструктор
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    available.notify_all();
+    for(std::thread& worker : workers)
+        worker.join();
+}
+
+// Цикл рабочего потока
+void ThreadPool::workerLoop(std::size_t index) {
+    setTraceThreadName("pool worker");
+    currentPool = this;
+    currentQueue = index;
+    std::function<void()> task;
+    while(true) {
+        if(take(task)) {
+            execute(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        available.wait(lock, [this] { return stopping || queued.load() > 0; });
+        if(stopping && queued.load() == 0)
+            return; // Остановка после опустошения очередей
+    }
+}
+
+// Извлечение задачи
+bool ThreadPool::take(std::function<void()>& task) {
+    if(queued.load() == 0)
+        return false;
+    std::size_t count = queues.size();
+    std::size_t own = currentPool == this ? currentQueue : count;
+    if(own < count) {
+        WorkerQueue& queue = *queues[own];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(!queue.tasks.empty()) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+    // Перехват из начала чужих очередей: там самые ранние и обычно самые крупные задачи
+    std::size_t start = own < count ? own + 1 : nextQueue.load(std::memory_order_relaxed);
+    for(std::size_t i = 0; i < count; ++i) {
+        WorkerQueue& queue = *queues[(start + i) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Выполнение задачи
+void ThreadPool::execute(std::function<void()>& task) {
+    task();
+    task = nullptr;
+    if(unfinished.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        idle.notify_all();
+    }
+}
+
+// Постановка задачи в очередь
+void ThreadPool::submit(std::function<void()> task) {
+    std::size_t index = currentPool == this ? currentQueue : nextQueue.fetch_add(1) % queues.size();
+    unfinished.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    queued.fetch_add(1);
+    // Захват мьютекса исключает пропуск сигнала потоком, который проверил очереди и засыпает
+    { std::lock_guard<std::mutex> lock(sleepMutex); }
+    available.notify_one();
+}
+
+// Выполнение одной задачи из очередей
+bool ThreadPool::runPending() {
+    std::function<void()> task;
+    if(!take(task))
+        return false;
+    execute(task);
+    return true;
+}
+
+// Ожидание всех задач
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    idle.wait(lock, [this] { return unfinished.load() == 0; });
+}
+
+// Параллельный цикл
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& body) {
+    if(count == 0)
+        return;
+    // Группа ждёт только этих задач: другие задачи пула не задерживают возврат
+    TaskGroup group(*this);
+    for(std::size_t i = 0; i < count; ++i)
+        group.run([&body, i] { body(i); });
+    group.wait();
+}
+
+// Постановка задачи группы
+void TaskGroup::run(std::function<void()> task) {
+    remaining.fetch_add(1);
+    pool.submit([this, task = std::move(task)]() {
+        task();
+        // Счётчик уменьшается под мьютексом: ожидающий не вернётся, пока сигнал не отправлен
+        std::lock_guard<std::mutex> lock(mutex);
+        if(remaining.fetch_sub(1) == 1)
+            done.notify_all();
+    });
+}
+
+// Ожидание задач группы
+void TaskGroup::wait() {
+    while(remaining.load() > 0) {
+        if(pool.runPending())
+            continue;
+        // Задачи группы выполняются другими потоками; они могут поставить новые задачи,
+        // поэтому очереди проверяются снова через короткий интервал
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait_for(lock, std::chrono::microseconds(200), [this] { return remaining.load() == 0; });
+    }
+    // Последняя задача могла ещё не отпустить мьютекс
+    std::lock_guard<std::mutex> lock(mutex);
+}
@@ -0,0 +1,175 @@
+// thread_pool.h
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <cstddef>
+
+/**
+ * @class ThreadPool
+ * @brief Пул рабочих потоков с планировщиком, перехватывающим задачи (work stealing).
+ *
+ * У каждого потока своя очередь: задачи, поставленные из задачи пула,
+ * попадают в очередь текущего потока и извлекаются им с конца (последняя
+ * поставленная - первой), а простаивающие потоки забирают задачи из начала
+ * чужих очередей. Задачи, поставленные извне пула, распределяются по
+ * очередям по кругу. Ожидание группы задач (TaskGroup, parallelFor)
+ * выполняет задачи пула, а не блокирует поток, поэтому группы можно
+ * запускать и ожидать изнутри задач того же пула.
+ *
+ * Потоки создаются один раз в конструкторе и завершаются в деструкторе
+ * после выполнения всех поставленных задач.
+ */
+class ThreadPool {
+private:
+    /**
+     * @struct WorkerQueue
+     * @brief Очередь задач одного рабочего потока.
+     */
+    struct WorkerQueue {
+        std::mutex mutex;                           ///< Защищает очередь
+        std::deque<std::function<void()>> tasks;    ///< Задачи: владелец берёт с конца, остальные - с начала
+    };
+
+    std::vector<std::thread> workers;                   ///< Рабочие потоки
+    std::vector<std::unique_ptr<WorkerQueue>> queues;   ///< Очереди потоков (по одной на поток)
+    std::atomic<std::size_t> queued;                    ///< Задач в очередях
+    std::atomic<std::size_t> unfinished;                ///< Поставленных и ещё не выполненных задач
+    std::atomic<std::size_t> nextQueue;                 ///< Очередь для следующей задачи извне пула
+    std::mutex sleepMutex;                              ///< Защищает ожидание потоков
+    std::condition_variable available;                  ///< Сигнал о новой задаче или остановке
+    std::condition_variable idle;                       ///< Сигнал о завершении всех задач
+    bool stopping;                                      ///< Признак остановки пула
+
+    /**
+     * @brief Цикл рабочего потока: выполняет задачи своей очереди и перехватывает чужие.
+     * @param index Номер потока и его очереди.
+     */
+    void workerLoop(std::size_t index);
+
+    /**
+     * @brief Извлекает задачу: с конца очереди текущего потока пула, иначе из начала остальных.
+     * @param task Извлечённая задача.
+     * @return true, если задача найдена.
+     */
+    bool take(std::function<void()>& task);
+
+    /**
+     * @brief Выполняет задачу и учитывает её завершение.
+     * @param task Задача.
+     */
+    void execute(std::function<void()>& task);
+
+public:
+    /**
+     * @brief Конструктор. Запускает рабочие потоки.
+     * @param threads Количество потоков; 0 означает число аппаратных потоков.
+     */
+    explicit ThreadPool(std::size_t threads = 0);
+
+    /**
+     * @brief Деструктор. Дожидается выполнения очереди и останавливает потоки.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Возвращает количество рабочих потоков.
+     * @return Размер пула.
+     */
+    std::size_t size() const { return workers.size(); }
+
+    /**
+     * @brief Ставит задачу в очередь.
+     * @param task Задача.
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Выполняет одну задачу из очередей пула в текущем потоке.
+     * @return false, если очереди пусты.
+     */
+    bool runPending();
+
+    /**
+     * @brief Дожидается выполнения всех поставленных задач.
+     * Не должна вызываться из задачи этого же пула.
+     */
+    void wait();
+
+    /**
+     * @brief Выполняет body(i) для i из [0, count) на потоках пула и дожидается
+     * только этих задач. Может вызываться из задач этого же пула.
+     * @param count Количество итераций.
+     * @param body Тело итерации.
+     */
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)>& body);
+};
+
+/**
+ * @class TaskGroup
+ * @brief Группа задач пула с ожиданием их завершения (fork/join).
+ *
+ * Ожидающий поток выполняет задачи пула, пока в очередях есть работа, и
+ * засыпает, только когда задачи группы уже выполняются другими потоками.
+ * Деструктор дожидается задач группы.
+ */
+class TaskGroup {
+private:
+    ThreadPool& pool;                       ///< Пул, выполняющий задачи
+    std::atomic<std::size_t> remaining;     ///< Невыполненных задач группы
+    std::mutex mutex;                       ///< Защищает ожидание
+    std::condition_variable done;           ///< Сигнал о завершении последней задачи
+
+public:
+    /**
+     * @brief Конструктор пустой группы.
+     * @param pool Пул потоков.
+     */
+    explicit TaskGroup(ThreadPool& pool) : pool(pool), remaining(0) {}
+
+    /**
+     * @brief Деструктор. Дожидается задач группы.
+     */
+    ~TaskGroup() { wait(); }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    /**
+     * @brief Ставит задачу группы в очередь пула.
+     * @param task Задача.
+     */
+    void run(std::function<void()> task);
+
+    /**
+     * @brief Дожидается задач группы, выполняя тем временем задачи пула.
+     */
+    void wait();
+};
+
+/**
+ * @brief Выполняет две функции параллельно: вторую - задачей пула, первую - в текущем потоке.
+ * @param pool Пул потоков.
+ * @param first Функция, выполняемая текущим потоком.
+ * @param second Функция, выполняемая задачей пула.
+ */
+template<typename First, typename Second>
+void parallelInvoke(ThreadPool& pool, First&& first, Second&& second) {
+    TaskGroup group(pool);
+    group.run([&second]() { second(); });
+    first();
+    group.wait();
+}
+
+#endif // THREAD_POOL_H
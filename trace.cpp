@@ -0,0 +1,168 @@
+// trace.cpp
+
+#include "trace.h"
+#include "csv_writer.h"
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> traceActive(false);
+
+namespace {
+    std::atomic<std::int64_t> traceEpoch(0);   // Начало отсчёта, нс steady_clock
+    std::mutex registryMutex;                  // Защищает список буферов
+
+    // Буферы всех потоков; живут до конца процесса, чтобы события завершённых потоков попали в экспорт
+    std::vector<std::unique_ptr<TraceBuffer>>& registry() {
+        static std::vector<std::unique_ptr<TraceBuffer>> buffers;
+        return buffers;
+    }
+
+    thread_local TraceBuffer* currentBuffer = nullptr;
+    thread_local const char* currentName = nullptr;
+
+    // Наносекунды steady_clock
+    std::int64_t nanoseconds(std::chrono::steady_clock::time_point point) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(point.time_since_epoch()).count();
+    }
+
+    // Буфер текущего потока, создаваемый при первом интервале
+    TraceBuffer& threadBuffer() {
+        if(!currentBuffer) {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            auto& buffers = registry();
+            int thread = static_cast<int>(buffers.size()) + 1;
+            std::string name = currentName ? currentName : "thread " + std::to_string(thread);
+            buffers.push_back(std::make_unique<TraceBuffer>(thread, std::move(name)));
+            currentBuffer = buffers.back().get();
+        }
+        return *currentBuffer;
+    }
+
+    // Время в микросекундах с долями: формат ts и dur
+    void writeMicroseconds(CsvWriter& writer, std::uint64_t ns) {
+        writer.writeInt(static_cast<long long>(ns / 1000));
+        std::uint64_t fraction = ns % 1000;
+        writer.write('.');
+        writer.write(static_cast<char>('0' + fraction / 100));
+        writer.write(static_cast<char>('0' + fraction / 10 % 10));
+        writer.write(static_cast<char>('0' + fraction % 10));
+    }
+
+    // Строка JSON с экранированием
+    void writeJsonString(CsvWriter& writer, std::string_view text) {
+        writer.write('"');
+        for(char c : text) {
+            if(c == '"' || c == '\\')
+                writer.write('\\');
+            if(static_cast<unsigned char>(c) >= 0x20)
+                writer.write(c);
+        }
+        writer.write('"');
+    }
+}
+
+// Конструктор буфера
+TraceBuffer::TraceBuffer(int thread, std::string name)
+    : head(new Block), tail(head), threadNumber(thread), threadName(std::move(name)) {}
+
+// Деструктор буфера
+TraceBuffer::~TraceBuffer() {
+    for(Block* block = head; block != nullptr; ) {
+        Block* next = block->next.load(std::memory_order_relaxed);
+        delete block;
+        block = next;
+    }
+}
+
+// Добавление события
+void TraceBuffer::append(const TraceEvent& event) {
+    std::size_t used = tail->used.load(std::memory_order_relaxed);
+    if(used == blockEvents) {
+        Block* block = new Block;
+        tail->next.store(block, std::memory_order_release);
+        tail = block;
+        used = 0;
+    }
+    tail->events[used] = event;
+    // Событие становится видимым экспорту только после записи
+    tail->used.store(used + 1, std::memory_order_release);
+}
+
+// Включение трассировки
+void startTracing() {
+    if(traceActive.load())
+        return;
+    traceEpoch.store(nanoseconds(std::chrono::steady_clock::now()));
+    traceActive.store(true);
+}
+
+// Название потока
+void setTraceThreadName(const char* name) {
+    currentName = name;
+}
+
+// Запись интервала
+void recordTraceEvent(const char* name, std::chrono::steady_clock::time_point start,
+                      std::chrono::steady_clock::time_point end) {
+    std::int64_t epoch = traceEpoch.load(std::memory_order_relaxed);
+    std::int64_t begin = nanoseconds(start) - epoch;
+    TraceEvent event{ name, static_cast<std::uint64_t>(begin > 0 ? begin : 0),
+                      static_cast<std::uint64_t>(nanoseconds(end) - nanoseconds(start)) };
+    threadBuffer().append(event);
+}
+
+// Экспорт в формате Chrome trace
+long long writeChromeTrace(const std::string& filename) {
+    CsvWriter writer;
+    if(!writer.open(filename))
+        return -1;
+    long long events = 0;
+    writer.write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+                 "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"contact_manager\"}}");
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for(const auto& buffer : registry()) {
+        writer.write(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":");
+        writer.writeInt(buffer->thread());
+        writer.write(",\"args\":{\"name\":");
+        writeJsonString(writer, buffer->name());
+        writer.write("}}");
+        for(const TraceBuffer::Block* block = buffer->first(); block != nullptr;
+            block = block->next.load(std::memory_order_acquire)) {
+            std::size_t used = block->used.load(std::memory_order_acquire);
+            for(std::size_t i = 0; i < used; ++i) {
+                const TraceEvent& event = block->events[i];
+                writer.write(",\n{\"name\":");
+                writeJsonString(writer, event.name);
+                writer.write(",\"cat\":\"contacts\",\"ph\":\"X\",\"pid\":1,\"tid\":");
+                writer.writeInt(buffer->thread());
+                writer.write(",\"ts\":");
+                writeMicroseconds(writer, event.start);
+                writer.write(",\"dur\":");
+                writeMicroseconds(writer, event.duration);
+                writer.write('}');
+                ++events;
+            }
+        }
+    }
+    writer.write("\n]}\n");
+    if(!writer.commit())
+        return -1;
+    return events;
+}
+
+// Включение трассировки на время сессии
+TraceSession::TraceSession(const std::string& filename) : filename(filename) {
+    if(!filename.empty())
+        startTracing();
+}
+
+// Запись трассировки по завершении сессии
+TraceSession::~TraceSession() {
+    if(filename.empty())
+        return;
+    long long events = writeChromeTrace(filename);
+    if(events >= 0)
+        std::cerr << "Трассировка записана в файл " << filename << ": событий " << events << "\n";
+}
@@ -0,0 +1,194 @@
+// trace.h
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "stats.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @struct TraceEvent
+ * @brief Завершённый интервал трассировки.
+ */
+struct TraceEvent {
+    const char* name;           ///< Название фазы (строковый литерал)
+    std::uint64_t start;        ///< Начало, нс от включения трассировки
+    std::uint64_t duration;     ///< Длительность, нс
+};
+
+/**
+ * @class TraceBuffer
+ * @brief Буфер событий одного потока.
+ *
+ * Пишет только поток-владелец, без блокировок: события добавляются в
+ * цепочку блоков фиксированного размера, заполненность блока публикуется
+ * атомарной записью. Экспорт может читать буфер одновременно с записью и
+ * видит все опубликованные события.
+ */
+class TraceBuffer {
+public:
+    static constexpr std::size_t blockEvents = 4096;   ///< Событий в блоке
+
+    /**
+     * @struct Block
+     * @brief Блок событий.
+     */
+    struct Block {
+        TraceEvent events[blockEvents];             ///< События
+        std::atomic<std::size_t> used{ 0 };         ///< Опубликованных событий
+        std::atomic<Block*> next{ nullptr };        ///< Следующий блок
+    };
+
+    /**
+     * @brief Конструктор.
+     * @param thread Номер потока в трассировке.
+     * @param name Название потока.
+     */
+    TraceBuffer(int thread, std::string name);
+
+    /**
+     * @brief Деструктор. Освобождает блоки.
+     */
+    ~TraceBuffer();
+
+    TraceBuffer(const TraceBuffer&) = delete;
+    TraceBuffer& operator=(const TraceBuffer&) = delete;
+
+    /**
+     * @brief Добавляет событие. Вызывается только потоком-владельцем.
+     * @param event Событие.
+     */
+    void append(const TraceEvent& event);
+
+    /**
+     * @brief Возвращает первый блок для чтения.
+     * @return Первый блок.
+     */
+    const Block* first() const { return head; }
+
+    /**
+     * @brief Возвращает номер потока.
+     * @return Номер потока.
+     */
+    int thread() const { return threadNumber; }
+
+    /**
+     * @brief Возвращает название потока.
+     * @return Название потока.
+     */
+    const std::string& name() const { return threadName; }
+
+private:
+    Block* head;                ///< Первый блок
+    Block* tail;                ///< Блок, в который идёт запись
+    int threadNumber;           ///< Номер потока
+    std::string threadName;     ///< Название потока
+};
+
+/**
+ * @brief Включает трассировку и начинает отсчёт времени.
+ */
+void startTracing();
+
+extern std::atomic<bool> traceActive;   ///< Трассировка включена
+
+/**
+ * @brief Проверяет, включена ли трассировка.
+ * @return true, если интервалы записываются.
+ */
+inline bool tracingEnabled() {
+    return traceActive.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Задаёт название текущего потока в трассировке.
+ * Действует, если вызвано до первого интервала потока.
+ * @param name Название (строковый литерал).
+ */
+void setTraceThreadName(const char* name);
+
+/**
+ * @brief Записывает интервал в буфер текущего потока.
+ * @param name Название фазы (строковый литерал).
+ * @param start Начало интервала.
+ * @param end Конец интервала.
+ */
+void recordTraceEvent(const char* name, std::chrono::steady_clock::time_point start,
+                      std::chrono::steady_clock::time_point end);
+
+/**
+ * @brief Записывает собранные события в формате Chrome trace (JSON для chrome://tracing и Perfetto).
+ * @param filename Имя файла.
+ * @return Количество записанных событий или -1 при ошибке.
+ */
+long long writeChromeTrace(const std::string& filename);
+
+/**
+ * @class TraceSpan
+ * @brief Интервал трассировки от создания до уничтожения объекта.
+ * При выключенной трассировке время не замеряется.
+ */
+class TraceSpan {
+private:
+    const char* name;                                   ///< Название фазы
+    bool active;                                        ///< Трассировка была включена при создании
+    std::chrono::steady_clock::time_point start;        ///< Начало интервала
+
+public:
+    /**
+     * @brief Конструктор. Начинает интервал.
+     * @param name Название фазы (строковый литерал).
+     */
+    explicit TraceSpan(const char* name) : name(name), active(tracingEnabled()) {
+        if(active)
+            start = std::chrono::steady_clock::now();
+    }
+
+    /**
+     * @brief Деструктор. Записывает интервал.
+     */
+    ~TraceSpan() {
+        if(active)
+            recordTraceEvent(name, start, std::chrono::steady_clock::now());
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
+
+/**
+ * @class TraceSession
+ * @brief Включает трассировку на время жизни объекта и записывает её в файл при уничтожении.
+ */
+class TraceSession {
+private:
+    std::string filename;       ///< Файл трассировки (пусто - трассировка не включается)
+
+public:
+    /**
+     * @brief Конструктор.
+     * @param filename Файл трассировки; пустое имя ничего не включает.
+     */
+    explicit TraceSession(const std::string& filename);
+
+    /**
+     * @brief Деструктор. Записывает трассировку.
+     */
+    ~TraceSession();
+
+    TraceSession(const TraceSession&) = delete;
+    TraceSession& operator=(const TraceSession&) = delete;
+};
+
+#if CONTACT_STATS
+/// Интервал трассировки до конца текущего блока
+#define TRACE_SPAN(name) TraceSpan traceSpan(name)
+#else
+#define TRACE_SPAN(name) ((void)0)
+#endif
+
+#endif // TRACE_H